@@ -31,7 +31,11 @@ int main(int argc, char **argv) {
   return 1;
 #endif
 
-  pix_frame_t *frame = pixfb_frame_init(fb_path);
+  // Flip between off-screen pages when the device allows it, otherwise draw
+  // into a cached back buffer; either way nothing half-drawn is shown. unlock
+  // paces the loop to the display refresh.
+  pix_frame_t *frame = pixfb_frame_init_ex(
+      fb_path, PIXFB_FLIP | PIXFB_TRIPLE | PIXFB_SHADOW | PIXFB_VSYNC);
   if (!frame) {
     fprintf(stderr, "Failed to init framebuffer %s\n", fb_path);
     return 1;
@@ -41,6 +45,13 @@ int main(int argc, char **argv) {
          frame->stride, frame->format);
   fflush(stdout);
 
+  // Render bands on every core.
+  vg_pool_t *pool = vg_pool_create(0);
+  // Scratch memory for each band thread, reused frame to frame.
+  vg_render_ctx_t *ctx = vg_render_ctx_create(0);
+  printf("fbtiger: rendering with %zu thread(s)\n", vg_pool_threads(pool));
+  fflush(stdout);
+
   // Build tiger canvas (idempotent).
   tiger_build_canvas(NULL, NULL);
 
@@ -55,9 +66,9 @@ int main(int argc, char **argv) {
   sa.sa_handler = on_sigint;
   sigaction(SIGINT, &sa, NULL);
 
-  // Simple animation: gentle auto-zoom in/out + slow rotation.
+  // Simple animation: gentle auto-zoom in/out + slow rotation, advanced by
+  // the measured time between frames.
   float t = 0.f;
-  const float dt = 1.f / 60.f; // ~60Hz logical update
   struct timespec last;
   clock_gettime(CLOCK_MONOTONIC, &last);
   uint32_t clear = 0xFFFFFFFFu; // white
@@ -67,13 +78,6 @@ int main(int argc, char **argv) {
     clock_gettime(CLOCK_MONOTONIC, &now);
     double elapsed = (double)(now.tv_sec - last.tv_sec) +
                      (double)(now.tv_nsec - last.tv_nsec) / 1e9;
-    if (elapsed < dt) {
-      // Sleep remaining time (coarse)
-      struct timespec req = {0, (long)((dt - elapsed) * 1e9)};
-      if (req.tv_nsec > 0)
-        nanosleep(&req, NULL);
-      continue; // accumulate
-    }
     last = now;
     t += (float)elapsed;
 
@@ -85,10 +89,20 @@ int main(int argc, char **argv) {
     if (!frame->lock(frame))
       break;
     pix_frame_clear(frame, clear);
-    vg_canvas_render(&g_canvas, frame);
-    frame->unlock(frame); // mmap direct; still keep for API symmetry
+    vg_canvas_render_parallel(&g_canvas, frame, pool, ctx);
+    frame->unlock(frame); // flip or copy out the finished frame
   }
 
+  pixfb_stats_t stats;
+  if (pixfb_frame_stats(frame, &stats) && stats.intervals)
+    printf("fbtiger: %llu frames, %.2f ms mean (%.2f..%.2f), %llu late, "
+           "%s pacing at %.2f ms\n",
+           (unsigned long long)stats.intervals, stats.mean_ms, stats.min_ms,
+           stats.max_ms, (unsigned long long)stats.late,
+           stats.vsync ? "vsync" : "timer", stats.period_ms);
+
+  vg_render_ctx_destroy(ctx);
+  vg_pool_destroy(pool);
   free_tiger_shapes();
   if (frame && frame->destroy)
     frame->destroy(frame);
@@ -0,0 +1,168 @@
+/* JPEG decode benchmark: decodes each file from memory a number of times
+ * and reports the best and mean CPU time per decode, full size and as a
+ * 320x240 thumbnail (pix_frame_init_jpeg_ex). A copy of each file that
+ * defines every table three times checks that the decoder's work pool
+ * copes with redefined tables. Run from the repository root or pass image
+ * paths; -n sets the repeat count. Compare builds configured with different
+ * -DPIX_JPEG_PROFILE values. */
+#include <pix/image.h>
+#include <pix/pix.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef PIX_JPEG_PROFILE_NAME
+#define PIX_JPEG_PROFILE_NAME "unknown"
+#endif
+
+static const char *kDefaultImages[] = {
+    "etc/desert.jpg",
+    "etc/sign.jpg",
+};
+static const size_t kDefaultImageCount =
+    sizeof(kDefaultImages) / sizeof(kDefaultImages[0]);
+
+/* Read a whole file into a malloc'd buffer (NULL on failure). */
+static void *read_file(const char *path, size_t *size) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return NULL;
+  void *data = NULL;
+  long n = -1;
+  if (fseek(fp, 0, SEEK_END) == 0)
+    n = ftell(fp);
+  if (n > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+    data = malloc((size_t)n);
+    if (data && fread(data, 1, (size_t)n, fp) != (size_t)n) {
+      free(data);
+      data = NULL;
+    }
+  }
+  fclose(fp);
+  *size = (size_t)n;
+  return data;
+}
+
+/* Copy of the JPEG @p data with its DQT and DHT segments repeated
+ * @p repeats more times just before the first SOS, so each table is
+ * redefined (valid JPEG, same image). NULL if no SOS is found. */
+static uint8_t *repeat_tables(const uint8_t *data, size_t size, int repeats,
+                              size_t *out_size) {
+  size_t tables = 0, pos = 2, sos = 0;
+  while (!sos && pos + 4 <= size && data[pos] == 0xFF) {
+    uint8_t marker = data[pos + 1];
+    size_t len = (size_t)data[pos + 2] << 8 | data[pos + 3];
+    if (marker == 0xDA)
+      sos = pos;
+    else if (marker == 0xDB || marker == 0xC4)
+      tables += 2 + len;
+    pos += 2 + len;
+  }
+  if (!sos)
+    return NULL;
+  uint8_t *out = malloc(size + tables * (size_t)repeats);
+  if (!out)
+    return NULL;
+  memcpy(out, data, sos);
+  size_t n = sos;
+  for (int r = 0; r < repeats; r++) {
+    for (pos = 2; pos < sos;) {
+      size_t len = (size_t)data[pos + 2] << 8 | data[pos + 3];
+      if (data[pos + 1] == 0xDB || data[pos + 1] == 0xC4) {
+        memcpy(out + n, data + pos, 2 + len);
+        n += 2 + len;
+      }
+      pos += 2 + len;
+    }
+  }
+  memcpy(out + n, data + sos, size - sos);
+  *out_size = n + size - sos;
+  return out;
+}
+
+/* Decode time is single threaded, so process CPU time measures it without
+ * the noise of other load on the machine. */
+static double cpu_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Decode @p runs times; false if any decode fails. max_w/max_h of 0 decode
+ * at full size. The rate is of source pixels, @p src (the output size when
+ * {0, 0}), so full and reduced decodes compare. */
+static int bench(const char *path, const void *data, size_t size, int runs,
+                 uint16_t max_w, uint16_t max_h, pix_size_t *src) {
+  double best = 0, total = 0;
+  pix_size_t out = {0, 0};
+  for (int i = 0; i < runs; i++) {
+    double t0 = cpu_ms();
+    pix_frame_t *f = pix_frame_init_jpeg_ex(data, size, PIX_FMT_RGB24,
+                                            max_w, max_h);
+    double t = cpu_ms() - t0;
+    if (!f) {
+      fprintf(stderr, "jpegbench: decode failed for %s\n", path);
+      return 0;
+    }
+    out = f->size;
+    f->destroy(f);
+    if (i == 0 || t < best)
+      best = t;
+    total += t;
+  }
+  if (!src->w)
+    *src = out;
+  double mpix = (double)src->w * src->h / 1e6;
+  printf("%-28s %5ux%-5u best %8.2f ms  mean %8.2f ms  %7.1f Mpix/s\n",
+         path, (unsigned)out.w, (unsigned)out.h, best, total / runs,
+         best > 0 ? mpix / (best / 1e3) : 0.0);
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  int runs = 5;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    runs = atoi(argv[2]);
+    first = 3;
+  }
+  if (runs < 1) {
+    fprintf(stderr, "usage: %s [-n runs] [image.jpg ...]\n", argv[0]);
+    return 1;
+  }
+  const char *const *images = kDefaultImages;
+  size_t image_count = kDefaultImageCount;
+  if (argc > first) {
+    images = (const char *const *)&argv[first];
+    image_count = (size_t)(argc - first);
+  }
+
+  printf("jpegbench: profile %s, %d run(s) per image\n",
+         PIX_JPEG_PROFILE_NAME, runs);
+  int ok = 1;
+  for (size_t i = 0; i < image_count; i++) {
+    size_t size = 0;
+    void *data = read_file(images[i], &size);
+    if (!data) {
+      fprintf(stderr, "jpegbench: could not read %s\n", images[i]);
+      ok = 0;
+      continue;
+    }
+    pix_size_t src = {0, 0};
+    if (!bench(images[i], data, size, runs, 0, 0, &src) ||
+        !bench(images[i], data, size, runs, 320, 240, &src))
+      ok = 0;
+    size_t multi_size = 0;
+    uint8_t *multi = repeat_tables(data, size, 2, &multi_size);
+    if (multi) {
+      char label[256];
+      snprintf(label, sizeof(label), "%s, tables x3", images[i]);
+      if (!bench(label, multi, multi_size, runs, 320, 240, &src))
+        ok = 0;
+      free(multi);
+    }
+    free(data);
+  }
+  return ok ? 0 : 1;
+}
@@ -424,7 +424,7 @@ int main(int argc, char *argv[]) {
       break;
     }
     pix_frame_clear(frame, clear_color);
-    vg_canvas_render(&canvas, frame);
+    vg_canvas_render(&canvas, frame, NULL);
     // (Vector text only; debug bitmap path removed)
     frame->unlock(frame);
 
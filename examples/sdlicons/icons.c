@@ -351,7 +351,7 @@ static void render(state_t *st, pix_frame_t *frame) {
         p[x] = 0xFF000000; // ARGB: opaque black
     }
   }
-  vg_canvas_render(&st->canvas, frame);
+  vg_canvas_render(&st->canvas, frame, NULL);
   frame->unlock(frame);
 }
 
@@ -318,7 +318,7 @@ int main(int argc, char **argv) {
           }
         }
       }
-      vg_canvas_render(&canvas, frame);
+      vg_canvas_render(&canvas, frame, NULL);
     }
     frame->unlock(frame);
     SDL_Delay(10); /* simple throttle */
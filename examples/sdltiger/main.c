@@ -13,14 +13,20 @@
 
 int main(void) {
   int win_w = 640, win_h = (int)(640.0f * (tigerMaxY / tigerMaxX));
-  pix_frame_t *frame = pixsdl_frame_init(
+  pix_frame_t *frame = pixsdl_frame_init_ex(
       "Tiger (VG)", (pix_size_t){(uint16_t)win_w, (uint16_t)win_h},
-      PIX_FMT_RGBA32);
+      PIX_FMT_RGBA32, PIXSDL_SHADOW);
   if (!frame)
     return 1;
   // Build tiger canvas (idempotent); ignore returned value since globals used.
   tiger_build_canvas(NULL, NULL); // idempotent
+  // The geometry never changes, so keep edge tables between frames; they are
+  // rebuilt only when pan / zoom / rotate changes the transform.
+  for (vg_canvas_t *c = &g_canvas; c; c = c->next)
+    for (size_t i = 0; i < c->size; ++i)
+      vg_shape_set_cached(c->shapes[i], true);
   update_transform(win_w, win_h);
+  vg_render_ctx_t *ctx = vg_render_ctx_create(0); // per-frame scratch
   /* frame already created */
   uint32_t clear = 0xFFFFFFFFu; // white background
 
@@ -118,16 +124,21 @@ int main(void) {
         }
       }
     }
-    /* Window resize polling removed with accessor elimination; implement
-     * explicit recreate path if needed. */
+    // The shadow frame follows window resizes on lock.
     if (!frame->lock(frame))
       break;
+    if (frame->size.w != win_w || frame->size.h != win_h) {
+      win_w = frame->size.w;
+      win_h = frame->size.h;
+      update_transform(win_w, win_h);
+    }
     pix_frame_clear(frame, clear);
-    vg_canvas_render(&g_canvas, frame); // always render full canvas
+    vg_canvas_render(&g_canvas, frame, ctx); // always render full canvas
     frame->unlock(frame);
     SDL_Delay(16);
   }
 
+  vg_render_ctx_destroy(ctx);
   free_tiger_shapes();
   if (frame && frame->destroy)
     frame->destroy(frame), frame = NULL;
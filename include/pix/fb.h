@@ -4,26 +4,30 @@
  *        a mapped framebuffer device.
  *
  * This header is available only on Linux builds (PIX_ENABLE_FB defined). It
- * exposes a single helper that opens a framebuffer device node (e.g.
- * /dev/fb0), queries its fixed / variable screen info, mmap()s the pixel
- * memory and wraps it in a pix_frame_t. The returned frame provides lock,
- * unlock (no-op) and destroy callbacks; pixels are written directly to the
- * device memory.
+ * exposes helpers that open a framebuffer device node (e.g. /dev/fb0), query
+ * its fixed / variable screen info, mmap() the pixel memory and wrap it in a
+ * pix_frame_t. The returned frame provides lock, unlock and destroy
+ * callbacks. By default pixels are written directly to the visible device
+ * memory; ::pixfb_frame_init_ex can buffer them instead (see ::pixfb_flags_t).
  *
  * Lifetime:
  *  - Call ::pixfb_frame_init with a framebuffer device path.
- *  - Optionally call frame->lock(frame) before rendering (lock is a cheap
- *    no-op returning true; provided for API uniformity).
- *  - Render using pix / vg APIs; changes are immediately visible.
- *  - Call frame->unlock(frame) (no-op) if used.
+ *  - Call frame->lock(frame) before rendering (cheap; it always succeeds on
+ *    a mapped device).
+ *  - Render using pix / vg APIs. Direct frames show changes immediately.
+ *  - Call frame->unlock(frame) to present a buffered frame (a no-op for
+ *    direct frames). Flipping frames may move frame->pixels on unlock.
  *  - Destroy with frame->destroy(frame) to unmap, close and free the frame.
  *
  * Threading: All calls should occur on a single thread. No synchronization
  * is performed.
  *
- * Supported pixel formats: Attempts to map common RGB formats to PIX formats:
- *  - 24bpp packed RGB -> PIX_FMT_RGB24
- *  - 32bpp X8R8G8B8 / A8R8G8B8 -> PIX_FMT_RGBA32 (treated as straight alpha)
+ * Supported pixel formats: The frame takes the PIX format whose byte order
+ * matches the device memory, so nothing is swizzled while drawing:
+ *  - 32bpp A8R8G8B8 -> PIX_FMT_BGRA32 (treated as straight alpha)
+ *  - 32bpp X8R8G8B8 (no alpha field) -> PIX_FMT_XRGB32
+ *  - 32bpp A8B8G8R8 / X8B8G8R8 -> PIX_FMT_RGBA32
+ *  - 24bpp R8G8B8 -> PIX_FMT_BGR24; B8G8R8 -> PIX_FMT_RGB24
  *  - 16bpp RGB565 -> PIX_FMT_RGB565
  *  - 8bpp grayscale (if pseudo palette / grayscale) -> PIX_FMT_GRAY8
  * If the device's layout is unsupported, the function returns NULL.
@@ -41,7 +45,62 @@ extern "C" {
 #endif
 
 /**
- * @brief Initialize a pix_frame_t from a Linux framebuffer device.
+ * @brief Presentation strategy for ::pixfb_frame_init_ex.
+ */
+typedef enum {
+  /** Draw into the visible framebuffer memory (tears while drawing). */
+  PIXFB_DIRECT = 0,
+  /** Draw into a cached system-memory back buffer; unlock copies the rows
+   *  that changed since the last unlock to the device. Contents persist
+   *  between frames. */
+  PIXFB_SHADOW = 1 << 0,
+  /** Draw into an off-screen page of the virtual screen and pan to it with
+   *  FBIOPAN_DISPLAY on unlock. Needs yres_virtual >= 2 * yres and a driver
+   *  that pans; otherwise falls back to PIXFB_SHADOW when that is also set,
+   *  else to PIXFB_DIRECT. A page holds whatever was drawn into it two (or
+   *  three) frames ago, so redraw it fully each frame. */
+  PIXFB_FLIP = 1 << 1,
+  /** With PIXFB_FLIP, cycle three pages when the virtual screen has room,
+   *  so drawing never waits for the page being scanned out. */
+  PIXFB_TRIPLE = 1 << 2,
+  /** Pace unlock to the display refresh: wait on FBIO_WAITFORVSYNC, or
+   *  sleep to a fixed grid at the mode's refresh rate (60 Hz when the
+   *  driver does not report timings) when that ioctl is unavailable. */
+  PIXFB_VSYNC = 1 << 3,
+} pixfb_flags_t;
+
+/**
+ * @brief Intervals between presents (unlock calls) of a framebuffer frame.
+ */
+typedef struct {
+  uint64_t intervals; /**< Intervals measured so far. */
+  uint64_t late;      /**< Intervals over 1.5 refresh periods. */
+  double period_ms;   /**< Refresh period used for pacing. */
+  double mean_ms;     /**< Mean interval (0 before two presents). */
+  double min_ms;      /**< Shortest interval. */
+  double max_ms;      /**< Longest interval. */
+  bool vsync;         /**< true while FBIO_WAITFORVSYNC paces unlock. */
+} pixfb_stats_t;
+
+/**
+ * @brief Initialize a buffered pix_frame_t from a Linux framebuffer device.
+ * @param path  Filesystem path to framebuffer (e.g. "/dev/fb0").
+ * @param flags Presentation strategy (::pixfb_flags_t, may be OR-ed).
+ * @return Newly allocated pix_frame_t* on success, NULL on failure.
+ */
+pix_frame_t *pixfb_frame_init_ex(const char *path, pixfb_flags_t flags);
+
+/**
+ * @brief Read present-interval statistics of a frame from this backend.
+ * @param frame Frame returned by ::pixfb_frame_init / ::pixfb_frame_init_ex.
+ * @param stats Receives the statistics.
+ * @return false when @p frame is not a framebuffer frame.
+ */
+bool pixfb_frame_stats(const pix_frame_t *frame, pixfb_stats_t *stats);
+
+/**
+ * @brief Initialize a direct (unbuffered) pix_frame_t from a Linux
+ *        framebuffer device; same as ::pixfb_frame_init_ex with PIXFB_DIRECT.
  * @param path Filesystem path to framebuffer (e.g. "/dev/fb0").
  * @return Newly allocated pix_frame_t* on success, NULL on failure.
  */
@@ -24,14 +24,26 @@ extern "C" {
 /* Blit/copy flags */
 typedef enum { PIX_BLIT_NONE = 0u, PIX_BLIT_ALPHA = 1u << 0 } pix_blit_flags_t;
 
+/* Backend capabilities (pix_frame_t::caps) */
+typedef enum {
+  PIX_FRAME_CAP_NONE = 0u,
+  /** draw_line is accelerated: vg_canvas_render (not the damage or band
+      renderers) sends hairline strokes to it instead of rasterizing them.
+      Such lines need not land in the pixel buffer in paint order (SDL draws
+      them over the texture on unlock), so backends advertise this only when
+      asked. */
+  PIX_FRAME_CAP_LINES = 1u << 0,
+} pix_frame_caps_t;
+
 typedef struct pix_frame_t pix_frame_t;
 
 /**
  * @brief A 2D pixel buffer and drawing interface.
  *
- * Backends should fill in the function pointers. The software renderer uses
- * set_pixel for composition and draw_line for fast hairline rendering where
- * available; otherwise it falls back to its own routines.
+ * Backends should fill in the function pointers. The software renderer
+ * composes through the per-format span writers behind fill_span /
+ * blend_span and uses draw_line for fast hairline rendering where available;
+ * otherwise it falls back to its own routines.
  */
 struct pix_frame_t {
   void *pixels; /**< Pointer to the first pixel (may be NULL until locked). */
@@ -95,14 +107,74 @@ struct pix_frame_t {
   void (*draw_line)(struct pix_frame_t *frame, pix_point_t a, pix_point_t b,
                     pix_color_t color);
 
+  /**
+   * @brief Fill a horizontal run of pixels [x0, x1) on row y.
+   * @param frame Frame to draw into (must be locked).
+   * @param y Row to fill.
+   * @param x0 First pixel of the run (inclusive).
+   * @param x1 End of the run (exclusive).
+   * @param color 0xAARRGGBB; blended src-over like set_pixel unless opaque.
+   *
+   * Runs are clipped to the frame. Span writers let renderers hand whole
+   * scanline runs to the format code instead of dispatching per pixel.
+   */
+  void (*fill_span)(struct pix_frame_t *frame, int16_t y, int16_t x0,
+                    int16_t x1, pix_color_t color);
+
+  /**
+   * @brief Blend a color over a run of pixels with per-pixel coverage.
+   * @param frame Frame to draw into (must be locked).
+   * @param y Row to blend into.
+   * @param x0 First pixel of the run.
+   * @param coverage @p len coverage values (0 = untouched, 255 = full).
+   * @param len Number of pixels in the run.
+   * @param color 0xAARRGGBB; its alpha is scaled by each coverage value.
+   *
+   * Used for anti-aliased edges; runs are clipped to the frame.
+   */
+  void (*blend_span)(struct pix_frame_t *frame, int16_t y, int16_t x0,
+                     const uint8_t *coverage, uint16_t len, pix_color_t color);
+
   /**
    * @brief Copy a rectangle of pixels from another frame (blit).
    */
   bool (*copy)(struct pix_frame_t *dst, pix_point_t dst_origin,
                const struct pix_frame_t *src, pix_point_t src_origin,
                pix_size_t size, pix_blit_flags_t flags);
+
+  uint32_t caps; /**< pix_frame_caps_t bits; 0 for plain memory frames. */
 };
 
+/** Default row alignment of ::pix_frame_init_mem, in bytes: a cache line,
+ *  and a whole number of 16- and 32-byte vectors. */
+#define PIX_FRAME_ALIGN 64u
+
+/**
+ * @brief Allocate a frame backed by system memory.
+ * @param size Frame dimensions (both > 0).
+ * @param format Pixel format.
+ * @param stride_align Row alignment in bytes, a power of two; 0 selects
+ *        PIX_FRAME_ALIGN. Every row starts on this boundary (the first on at
+ *        least PIX_FRAME_ALIGN) and the stride is a multiple of it.
+ * @return A zero-filled frame, always locked (lock/unlock are no-ops), or
+ *         NULL on bad arguments or allocation failure. Release with
+ *         frame->destroy(frame), which frees the pixels too.
+ */
+pix_frame_t *pix_frame_init_mem(pix_size_t size, pix_format_t format,
+                                size_t stride_align);
+
+/**
+ * @brief Wrap caller-owned pixels in a frame.
+ * @param pixels First pixel; must stay valid for the frame's lifetime.
+ * @param size Frame dimensions.
+ * @param stride Bytes per row, or 0 for tightly packed rows.
+ * @param format Pixel format of @p pixels.
+ * @return A frame drawing into @p pixels, or NULL on bad arguments or
+ *         allocation failure. frame->destroy(frame) frees only the frame.
+ */
+pix_frame_t *pix_frame_wrap(void *pixels, pix_size_t size, size_t stride,
+                            pix_format_t format);
+
 #ifdef __cplusplus
 }
 #endif
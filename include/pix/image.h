@@ -14,13 +14,28 @@ struct pix_frame_t; /* forward */
 /**
  * @ingroup pix
  * Decode a JPEG from a contiguous memory buffer into a newly allocated frame.
- * On success returns a frame with pixels allocated and frame->destroy set;
- * caller releases with: if(frame->destroy) frame->destroy(frame);
- * free(frame);
+ * On success returns a memory frame (see pix_frame_init_mem) in any format
+ * with an RGB24 row converter; caller releases it with
+ * frame->destroy(frame), which frees the pixels and the frame.
  */
 struct pix_frame_t *pix_frame_init_jpeg(const void *data, size_t size,
                                         pix_format_t format);
 
+/**
+ * @ingroup pix
+ * Decode a JPEG for display at up to @p max_w x @p max_h pixels. Like
+ * pix_frame_init_jpeg, but decodes at 1/2, 1/4 or 1/8 size when the
+ * reduced image still holds the picture fitted into that box (aspect ratio
+ * kept), skipping most of the IDCT work and memory of a full-size decode.
+ * The returned frame is (width >> n) x (height >> n) for the chosen n; it
+ * may be larger than the box, never smaller than the fitted size unless
+ * the picture itself is. A 0 for @p max_w or @p max_h leaves that side
+ * unconstrained; both 0 decode at full size.
+ */
+struct pix_frame_t *pix_frame_init_jpeg_ex(const void *data, size_t size,
+                                           pix_format_t format,
+                                           uint16_t max_w, uint16_t max_h);
+
 /** User-supplied streaming read callback: return number of bytes read (0 =
  * EOF/error). */
 /**
@@ -39,7 +54,7 @@ typedef size_t (*pix_jpeg_read_cb)(void *data, size_t size, void *user_data);
  * request bytes sequentially; the callback should return 0 on EOF or error.
  * The entire decompressed image is written directly into the destination
  * frame (no full-size intermediate RGB buffer). Release the returned frame
- * via frame->destroy then free(). Returns NULL on failure.
+ * with frame->destroy(frame). Returns NULL on failure.
  */
 struct pix_frame_t *pix_frame_init_jpeg_stream(pix_jpeg_read_cb read_cb,
                                                void *user_data,
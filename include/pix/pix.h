@@ -16,13 +16,27 @@ extern "C" {
 #endif
 
 /** @ingroup pix
- *  Pixel formats for frames. */
+ *  Pixel formats for frames.
+ *
+ *  Names give the byte order in memory: RGB24 is R,G,B and RGBA32 R,G,B,A.
+ *  BGRA32, XRGB32 and BGR24 match the common little-endian device layouts
+ *  (ARGB8888, XRGB8888 and 24-bit RGB as seen by fbdev and SDL), so frames
+ *  can be drawn straight into device memory; XRGB32 ignores its alpha byte.
+ *
+ *  PIX_FMT_RGBA32 stores straight alpha. PIX_FMT_RGBA32_PREMUL has the same
+ *  byte order with color premultiplied by alpha: drawing into it composites
+ *  as dst = src + dst * (1 - a), and get_pixel / copies to other formats
+ *  return straight color. */
 typedef enum {
   PIX_FMT_UNKNOWN = 0,
   PIX_FMT_RGB24,
   PIX_FMT_RGBA32,
   PIX_FMT_GRAY8,
   PIX_FMT_RGB565,
+  PIX_FMT_RGBA32_PREMUL,
+  PIX_FMT_BGRA32,
+  PIX_FMT_XRGB32,
+  PIX_FMT_BGR24,
 } pix_format_t;
 
 /** @ingroup pix
@@ -39,6 +53,13 @@ typedef struct pix_size_t {
   uint16_t h;
 } pix_size_t;
 
+/** @ingroup pix
+ * Axis-aligned rectangle (top-left origin and size). */
+typedef struct pix_rect_t {
+  pix_point_t origin;
+  pix_size_t size;
+} pix_rect_t;
+
 /** @ingroup pix
  * Non-negative scalar pixel measure (e.g. radius, length). */
 typedef uint16_t pix_scalar_t;
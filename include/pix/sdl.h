@@ -7,7 +7,9 @@
  * (PIX_ENABLE_SDL defined). It exposes a single helper that hides all SDL
  * window / renderer / texture management behind the generic pix_frame_t API.
  * The returned frame supplies lock/unlock/destroy callbacks; pixels written
- * while locked are uploaded to the SDL texture on unlock and presented.
+ * while locked are uploaded to the SDL texture on unlock and presented,
+ * either from the locked texture or from a persistent shadow frame
+ * (see ::pixsdl_flags_t).
  *
  * Lifetime:
  *  - Call ::pixsdl_frame_init to create an SDL window + renderer + texture.
@@ -18,11 +20,13 @@
  * Threading: All calls must occur on the same thread that owns the SDL window
  * (typically the main thread). No internal synchronization is performed.
  *
- * Supported pixel formats: PIX_FMT_RGB24 and PIX_FMT_RGBA32. If a format other
- * than PIX_FMT_RGB24 is passed, an SDL ARGB8888 texture is created and the
- * frame->format field is set to the requested value (the software renderer
- * treats it as RGBA32). Other formats (GRAY8, RGB565) are currently not backed
- * by specialized SDL texture formats.
+ * Supported pixel formats: every format except PIX_FMT_GRAY8 gets a texture
+ * with the same memory layout (RGB24, BGR24, RGBA32, BGRA32, XRGB32 as SDL
+ * RGB888, RGB565), so unlocking uploads without conversion. Pass
+ * PIX_FMT_UNKNOWN to take the layout of the window surface (XRGB32 on most
+ * desktops); frame->format reports the format chosen.
+ * PIX_FMT_RGBA32_PREMUL is drawn premultiplied and the texture is copied
+ * without blending, so it shows as composited over black.
  *
  * Error handling: Returns NULL on allocation failure, SDL initialization /
  * window / renderer / texture creation failure. In those cases SDL_Quit is
@@ -37,11 +41,43 @@ extern "C" {
 #endif
 
 /**
- * @brief Create an SDL-backed frame (window + streaming texture).
+ * @brief How an SDL frame hands its pixels to the texture.
+ */
+typedef enum {
+  /** Lock the streaming texture for each frame; pixels are undefined after
+   *  lock, so every frame must be drawn in full. */
+  PIXSDL_STREAMING = 0,
+  /** Draw into a persistent system-memory frame that keeps its pixels
+   *  between frames; unlock uploads only the bands of rows that changed
+   *  with SDL_UpdateTexture. lock follows window resizes, reallocating the
+   *  texture and updating frame->size (pixels that still fit are kept). */
+  PIXSDL_SHADOW = 1 << 0,
+  /** Advertise PIX_FRAME_CAP_LINES so vg_canvas_render sends hairline
+   *  strokes to the renderer, batched on unlock. The lines are drawn over
+   *  the frame's pixels (after every fill) and only for the frame they were
+   *  queued in. */
+  PIXSDL_ACCEL_LINES = 1 << 1,
+} pixsdl_flags_t;
+
+/**
+ * @brief Create an SDL-backed frame with a chosen update strategy.
+ * @param title UTF-8 window title (may be NULL for default).
+ * @param size  Desired window / texture size in pixels (both > 0).
+ * @param fmt   Requested pixel format, or PIX_FMT_UNKNOWN for the window's
+ *              native layout. PIX_FMT_GRAY8 is not supported.
+ * @param flags Update strategy (::pixsdl_flags_t).
+ * @return Newly allocated pix_frame_t* on success, NULL on failure.
+ */
+pix_frame_t *pixsdl_frame_init_ex(const char *title, pix_size_t size,
+                                  pix_format_t fmt, pixsdl_flags_t flags);
+
+/**
+ * @brief Create an SDL-backed frame (window + streaming texture); same as
+ *        ::pixsdl_frame_init_ex with PIXSDL_STREAMING.
  * @param title UTF-8 window title (may be NULL for default).
  * @param size  Desired window / texture size in pixels (both > 0).
- * @param fmt   Requested pixel format (PIX_FMT_RGB24 or PIX_FMT_RGBA32
- *              recommended; others fallback to an RGBA32-equivalent texture).
+ * @param fmt   Requested pixel format, or PIX_FMT_UNKNOWN for the window's
+ *              native layout. PIX_FMT_GRAY8 is not supported.
  * @return Newly allocated pix_frame_t* on success, NULL on failure.
  *
  * The function internally calls SDL_Init(SDL_INIT_VIDEO) (once per process
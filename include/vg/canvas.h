@@ -8,6 +8,7 @@
  * are owned by the canvas and destroyed when the canvas is destroyed.
  */
 #pragma once
+#include "pool.h"
 #include "shape.h"
 
 /**
@@ -22,8 +23,26 @@ typedef struct vg_canvas_t {
   size_t size;                /**< Number of valid entries in @ref shapes. */
   size_t capacity;            /**< Allocated pointer capacity for this chunk. */
   struct vg_canvas_t *next;   /**< Overflow chunk (NULL if none). */
+  pix_size_t drawn_size; /**< Frame size of the last damage render, {0,0}
+                              when the next one must redraw everything. */
 } vg_canvas_t;
 
+/** Maximum number of rectangles reported in a vg_damage_t. */
+#define VG_DAMAGE_MAX_RECTS 8
+
+/**
+ * @struct vg_damage_t
+ * @brief Regions redrawn by vg_canvas_render_damage.
+ *
+ * Rectangles are disjoint, clipped to the frame, and at most
+ * VG_DAMAGE_MAX_RECTS (nearby damage is merged). A count of zero means the
+ * frame did not change. Backends can present just these regions.
+ */
+typedef struct vg_damage_t {
+  size_t count;                          /**< Valid entries in @ref rects. */
+  pix_rect_t rects[VG_DAMAGE_MAX_RECTS]; /**< Redrawn regions. */
+} vg_damage_t;
+
 /**
  * @ingroup vg
  * @brief Initialize a canvas with an initial pointer capacity.
@@ -56,6 +75,66 @@ struct vg_shape_t *vg_canvas_append(vg_canvas_t *canvas);
  */
 void vg_canvas_destroy(vg_canvas_t *canvas);
 
+/**
+ * @struct vg_render_ctx_t
+ * @brief Opaque render context holding per-frame scratch memory.
+ *
+ * Rasterizer temporaries (edge tables, coverage rows, sort buckets) are
+ * bump-allocated from arenas owned by the context, one per rendering
+ * thread, and released all at once when the next render starts. Arenas
+ * grow to the largest frame seen, after which rendering makes no heap
+ * calls for temporaries. A context serves one render at a time.
+ */
+typedef struct vg_render_ctx_t vg_render_ctx_t;
+
+/**
+ * @ingroup vg
+ * @brief Create a render context.
+ *
+ * @param reserve Initial arena size in bytes per thread (0 for a default;
+ *                arenas grow on demand either way).
+ * @return New context, or NULL on allocation failure.
+ */
+vg_render_ctx_t *vg_render_ctx_create(size_t reserve);
+
+/**
+ * @ingroup vg
+ * @brief Free a render context and its arenas (NULL ignored).
+ */
+void vg_render_ctx_destroy(vg_render_ctx_t *ctx);
+
+/**
+ * @ingroup vg
+ * @brief High-water mark of the context's arenas.
+ *
+ * @return Most scratch bytes any single render has used, summed over the
+ *         per-thread arenas (0 for NULL). Useful to size @p reserve.
+ */
+size_t vg_render_ctx_high_water(const vg_render_ctx_t *ctx);
+
+/**
+ * @struct vg_render_stats_t
+ * @brief Per-render shape counters, see vg_render_ctx_stats.
+ *
+ * Every shape is tested against the frame by its cached device bounds
+ * before any fill or stroke setup: shapes = culled + clipped + inside.
+ */
+typedef struct vg_render_stats_t {
+  size_t shapes;  /**< Shapes visited. */
+  size_t culled;  /**< Off the frame or drawing nothing; skipped. */
+  size_t clipped; /**< Crossing the frame edge; clipped to the frame. */
+  size_t inside;  /**< Entirely inside the frame; not clipped. */
+} vg_render_stats_t;
+
+/**
+ * @ingroup vg
+ * @brief Counters of the last render that used @p ctx.
+ *
+ * @param ctx Render context (NULL yields zeros).
+ * @param stats Receives the counters.
+ */
+void vg_render_ctx_stats(const vg_render_ctx_t *ctx, vg_render_stats_t *stats);
+
 /**
  * @ingroup vg
  * @brief Render every shape (fill then stroke) in insertion order.
@@ -67,17 +146,72 @@ void vg_canvas_destroy(vg_canvas_t *canvas);
  *
  * @param canvas Canvas to draw (NULL ignored).
  * @param frame Target frame (NULL ignored; must be locked if backend requires).
+ * @param ctx Render context reused across frames, or NULL for a temporary
+ *            one (its scratch is then allocated and freed per call).
+ */
+void vg_canvas_render(const vg_canvas_t *canvas, struct pix_frame_t *frame,
+                      vg_render_ctx_t *ctx);
+
+/**
+ * @ingroup vg
+ * @brief Redraw only what changed since the previous call.
+ *
+ * Compares every shape against the state it had when last drawn by this
+ * function: a changed path (vg_path_t generation), setter call, transform
+ * pointer or transform matrix damages both the old and the new device
+ * bounds (stroke width and AA included). Each damaged region is cleared to
+ * @p background and every shape reaching it is redrawn clipped to it, so
+ * the pixels match a full clear + vg_canvas_render. The first call, a
+ * change of frame size and vg_canvas_invalidate redraw the whole frame.
+ *
+ * The frame must keep the previous call's content (no clearing or other
+ * drawing in between, or call vg_canvas_invalidate). Changes to an image
+ * shape's source pixels are not seen; call vg_shape_set_image again.
+ *
+ * @param canvas Canvas to draw (NULL ignored).
+ * @param frame Target frame, locked (NULL ignored).
+ * @param background Color damaged regions are cleared to.
+ * @param ctx Render context (may be NULL), see vg_canvas_render.
+ * @param damage Receives the redrawn regions (may be NULL).
+ */
+void vg_canvas_render_damage(vg_canvas_t *canvas, struct pix_frame_t *frame,
+                             pix_color_t background, vg_render_ctx_t *ctx,
+                             vg_damage_t *damage);
+
+/**
+ * @ingroup vg
+ * @brief Make the next vg_canvas_render_damage redraw the whole frame.
+ * @param canvas Canvas (NULL ignored).
+ */
+void vg_canvas_invalidate(vg_canvas_t *canvas);
+
+/**
+ * @ingroup vg
+ * @brief Render the canvas with the frame split into horizontal bands.
+ *
+ * Bands are drawn concurrently by @p pool's threads; each band draws, in
+ * insertion order, only the shapes whose device bounds reach it, clipped to
+ * its rows. The result is bit-identical to vg_canvas_render. Falls back to
+ * vg_canvas_render for a NULL or single-thread pool and for frames without
+ * mapped pixels (lock the frame first). Calls sharing a pool must not
+ * overlap.
+ *
+ * @param canvas Canvas to draw (NULL ignored).
+ * @param frame Target frame (NULL ignored).
+ * @param pool Worker pool from vg_pool_create (may be NULL).
+ * @param ctx Render context (may be NULL), see vg_canvas_render.
  */
-void vg_canvas_render(const vg_canvas_t *canvas, struct pix_frame_t *frame);
+void vg_canvas_render_parallel(const vg_canvas_t *canvas,
+                               struct pix_frame_t *frame, vg_pool_t *pool,
+                               vg_render_ctx_t *ctx);
 
 /**
  * @ingroup vg
- * @brief Compute axis-aligned bounds (bounding box) of untransformed geometry.
+ * @brief Compute the device-space bounding box of all shapes.
  *
- * Current limitations: per-shape transforms and stroke expansion are
- * ignored; only raw path coordinates are considered. For image shapes, the
- * destination rectangle is included. If the canvas is empty, (0,0) / {0,0}
- * is returned.
+ * Union of vg_shape_bbox over the canvas (transforms and stroke reach
+ * included, per-shape results cached). If the canvas is empty, (0,0) /
+ * {0,0} is returned.
  *
  * @param canvas Canvas to inspect (NULL => no-op).
  * @param origin Output min point (may be NULL).
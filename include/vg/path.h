@@ -30,12 +30,15 @@
  * before chaining.
  * @var vg_path_t::next     Next segment in the chain or NULL if this is the
  * last.
+ * @var vg_path_t::generation Change counter (meaningful on the first segment
+ * only), bumped by the path API so cached edge tables notice edits.
  */
 typedef struct vg_path_t {
   pix_point_t *points;    /**< Contiguous points for this segment. */
   size_t size;            /**< Points used in this segment. */
   size_t capacity;        /**< Capacity of this segment. */
   struct vg_path_t *next; /**< Next segment in chain (NULL if end). */
+  uint32_t generation;    /**< Change counter (first segment only). */
 } vg_path_t;
 
 /**
@@ -85,3 +88,15 @@ bool vg_path_append(vg_path_t *path, const pix_point_t *first, ...);
  * @return true on success, false on allocation failure or invalid args.
  */
 bool vg_path_break(vg_path_t *path, size_t reserve);
+
+/**
+ * @ingroup vg
+ * @brief Mark a path as changed after editing its points in place.
+ *
+ * vg_path_append and vg_path_break do this themselves; code that writes
+ * segment points or links segments directly must call it so shapes with a
+ * cached edge table (vg_shape_set_cached) rebuild it.
+ *
+ * @param path First segment of the path (NULL ignored).
+ */
+void vg_path_touch(vg_path_t *path);
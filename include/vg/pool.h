@@ -0,0 +1,40 @@
+/**
+ * @file vg/pool.h
+ * @brief Worker thread pool used by the parallel canvas renderer.
+ *
+ * A pool owns a fixed set of worker threads that sleep between jobs. The
+ * calling thread always takes part in a job, so a pool of N threads starts
+ * N - 1 workers. Without thread support (VG_ENABLE_THREADS undefined) a
+ * pool is a single-thread placeholder and parallel rendering runs serially.
+ */
+#pragma once
+#include <stddef.h>
+
+/**
+ * @struct vg_pool_t
+ * @brief Opaque worker pool handle.
+ */
+typedef struct vg_pool_t vg_pool_t;
+
+/**
+ * @ingroup vg
+ * @brief Create a worker pool.
+ *
+ * @param threads Total threads taking part in a job, including the caller;
+ *                0 selects the number of online CPUs.
+ * @return New pool, or NULL on allocation failure. Fewer threads than
+ *         requested are used if some workers could not be started.
+ */
+vg_pool_t *vg_pool_create(size_t threads);
+
+/**
+ * @ingroup vg
+ * @brief Stop the workers and free the pool (NULL ignored).
+ */
+void vg_pool_destroy(vg_pool_t *pool);
+
+/**
+ * @ingroup vg
+ * @brief Number of threads taking part in a job (1 for a NULL pool).
+ */
+size_t vg_pool_threads(const vg_pool_t *pool);
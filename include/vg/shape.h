@@ -44,10 +44,36 @@ typedef enum {
  * @brief Path fill rule determining inside/outside classification.
  */
 typedef enum vg_fill_rule_t {
-  VG_FILL_EVEN_ODD = 0,     /**< Even-odd (parity) rule with gap bridging. */
-  VG_FILL_EVEN_ODD_RAW = 1, /**< Even-odd without gap bridging (exact runs). */
+  VG_FILL_EVEN_ODD = 0,     /**< Even-odd (parity) rule. */
+  VG_FILL_EVEN_ODD_RAW = 1, /**< Same as VG_FILL_EVEN_ODD (formerly without
+                                 gap bridging, which is retired). */
+  VG_FILL_NON_ZERO = 2,     /**< Non-zero winding rule. */
 } vg_fill_rule_t;
 
+/**
+ * @enum vg_fill_quality_t
+ * @ingroup vg
+ * @brief Scan conversion engine used for fills.
+ */
+typedef enum vg_fill_quality_t {
+  VG_FILL_QUALITY_AA = 0,   /**< Exact area coverage per pixel (default). */
+  VG_FILL_QUALITY_FAST = 1, /**< Binary pixel-center sampling, no AA. */
+} vg_fill_quality_t;
+
+/**
+ * @enum vg_image_sampling_t
+ * @ingroup vg
+ * @brief Source sampling of scaled or transformed image shapes.
+ *
+ * Unscaled, untransformed blits copy pixels directly and ignore it.
+ */
+typedef enum vg_image_sampling_t {
+  VG_IMAGE_NEAREST = 0,  /**< Texel under the pixel center (default). */
+  VG_IMAGE_BILINEAR = 1, /**< Weighted 2x2 texel neighbourhood. */
+  VG_IMAGE_AREA = 2,     /**< Box average over the pixel's footprint when
+                              downscaling; bilinear when enlarging. */
+} vg_image_sampling_t;
+
 /**
  * Opaque shape handle. Append a new shape to a canvas with vg_canvas_append
  */
@@ -133,12 +159,37 @@ float vg_shape_get_miter_limit(const vg_shape_t *shape);
 /** @} */
 
 /**
- * @name Fill Rule
+ * @name Fill Rule and Quality
  * @{ */
 /** @ingroup vg */
 void vg_shape_set_fill_rule(vg_shape_t *shape, vg_fill_rule_t rule);
 /** @ingroup vg */
 vg_fill_rule_t vg_shape_get_fill_rule(const vg_shape_t *shape);
+/** @ingroup vg */
+void vg_shape_set_fill_quality(vg_shape_t *shape, vg_fill_quality_t quality);
+/** @ingroup vg */
+vg_fill_quality_t vg_shape_get_fill_quality(const vg_shape_t *shape);
+/** @} */
+
+/**
+ * @name Edge Cache
+ * Opt-in retention of a path shape's device-space edge tables for static
+ * geometry. A cached shape is transformed and edge-built once; later
+ * vg_canvas_render calls sweep the stored tables directly, without setup or
+ * allocation, until the path (its generation, see vg_path_touch), the
+ * transform's matrix, the stroke parameters, the fill quality or the frame
+ * size change. Colors and the fill rule may change freely. Bands drawn by
+ * vg_canvas_render_parallel do not use the cache.
+ * @{ */
+/**
+ * @brief Enable or disable the edge cache for a path shape.
+ * Disabling releases the cached tables.
+ * @return false for image shapes or when the cache cannot be allocated.
+ */
+/** @ingroup vg */
+bool vg_shape_set_cached(vg_shape_t *shape, bool enable);
+/** @ingroup vg */
+bool vg_shape_get_cached(const vg_shape_t *shape);
 /** @} */
 
 /**
@@ -168,21 +219,52 @@ vg_fill_rule_t vg_shape_get_fill_rule(const vg_shape_t *shape);
 void vg_shape_set_image(vg_shape_t *shape, const struct pix_frame_t *frame,
                         pix_point_t src_origin, pix_size_t src_size,
                         pix_point_t dst_origin, unsigned flags);
+/**
+ * @brief Select how a scaled or transformed image shape samples its source.
+ *
+ * Kept across vg_shape_set_image calls on the same shape. Filtered modes
+ * interpolate alpha sources premultiplied.
+ */
+/** @ingroup vg */
+void vg_shape_set_image_sampling(vg_shape_t *shape,
+                                 vg_image_sampling_t sampling);
+/** @ingroup vg */
+vg_image_sampling_t vg_shape_get_image_sampling(const vg_shape_t *shape);
+/**
+ * @brief Enable or disable a mip chain for a minified image shape.
+ *
+ * When enabled, blits that shrink the source by 2x or more read a copy
+ * reduced by 2x2 box filtering, picked from the transform's scale (for
+ * VG_IMAGE_AREA, from the less reduced axis), instead of the full source.
+ * The levels take up to a third of the source's pixel count and are built
+ * on first use, during rendering; vg_shape_set_image discards them.
+ * Disabling frees them.
+ * @return false for path shapes or when out of memory.
+ */
+/** @ingroup vg */
+bool vg_shape_set_image_mipmaps(vg_shape_t *shape, bool enable);
+/** @ingroup vg */
+bool vg_shape_get_image_mipmaps(const vg_shape_t *shape);
 /** @} */
 
 /**
  * @name Geometry Utilities
  * @{ */
 /**
- * @brief Compute axis-aligned bounds (untransformed) of a single shape.
+ * @brief Compute the device-space axis-aligned bounds of a single shape.
  *
- * Path shapes: iterates all path segments / points ignoring stroke width
- * expansion and any transform pointer set on the shape.
+ * Path shapes: the path points mapped through the shape's transform (if
+ * any), grown by the stroke's reach when a stroke is set: half the width,
+ * times the miter limit for mitered joins or sqrt(2) for square caps.
  *
- * Image shapes: returns the destination rectangle (dst_origin + src size
- * or full frame size if src_size.{w,h} are zero).
+ * Image shapes: the destination rectangle (dst_origin + src size, or the
+ * full source frame size if src_size.{w,h} are zero), transformed.
  *
- * Empty / NULL / unsupported kinds yield origin (0,0) and size {0,0}.
+ * Bounds are cached on the shape and recomputed only after a setter call,
+ * a path edit (see vg_path_touch for in-place edits) or a change of the
+ * transform matrix; an unchanged path under a scale / translate transform
+ * is not walked again. Empty / NULL shapes yield origin (0,0) and size
+ * {0,0}.
  *
  * @param shape Shape to inspect (may be NULL).
  * @param origin Output min point (may be NULL).
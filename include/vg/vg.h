@@ -26,6 +26,7 @@
 #include "canvas.h"     /**< @ingroup vg */
 #include "font.h"       /**< @ingroup vg */
 #include "path.h"       /**< @ingroup vg */
+#include "pool.h"       /**< @ingroup vg */
 #include "primitives.h" /**< @ingroup vg */
 #include "shape.h"      /**< @ingroup vg */
 #include "transform.h"  /**< @ingroup vg */
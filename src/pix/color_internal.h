@@ -3,6 +3,22 @@
 #include <stdint.h>
 
 static inline uint8_t pix_luma(uint8_t r, uint8_t g, uint8_t b) {
-  /* Integer approximation of ITU-R BT.601 luma: 0.299R + 0.587G + 0.114B */
-  return (uint8_t)((r * 30 + g * 59 + b * 11) / 100);
+  /* ITU-R BT.601 luma, 0.299R + 0.587G + 0.114B, in 8.8 fixed point. The
+   * weights sum to 256 so greys map to themselves, and every term fits in
+   * 16 bits for the vector converters. */
+  return (uint8_t)((r * 77u + g * 150u + b * 29u + 128u) >> 8);
+}
+
+/* Rounded product of two 8-bit fractions: (a * b) / 255. */
+static inline uint8_t pix_mul255(uint32_t a, uint32_t b) {
+  return (uint8_t)((a * b + 127u) / 255u);
+}
+
+/* Straight channel from premultiplied @p c at alpha @p a: c * 255 / a,
+ * rounded and clamped (0 when a is 0). */
+static inline uint8_t pix_unpremul(uint32_t c, uint32_t a) {
+  if (a == 0)
+    return 0;
+  uint32_t v = (c * 255u + a / 2u) / a;
+  return (uint8_t)(v > 255u ? 255u : v);
 }
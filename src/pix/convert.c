@@ -0,0 +1,1009 @@
+#include "color_internal.h"
+#include "frame_internal.h"
+#include "simd_internal.h"
+#include <stdbool.h>
+#include <string.h>
+#ifdef VG_ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+/* Row converters for pix_frame_copy, one per (dst, src) format pair that has
+ * a direct kernel; other pairs go through RGBA32 (pix_convert_row). The
+ * portable C versions define the results; vector versions replace them when
+ * built in and must match byte for byte. */
+
+#define FMT_COUNT (PIX_FMT_BGR24 + 1)
+
+/* -------- Portable C -------- */
+static inline uint16_t pack565(uint8_t r, uint8_t g, uint8_t b) {
+  return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+static inline void unpack565(const uint8_t *src, uint8_t *r, uint8_t *g,
+                             uint8_t *b) {
+  uint16_t v;
+  memcpy(&v, src, 2);
+  *r = (uint8_t)((v >> 8) & 0xF8);
+  *g = (uint8_t)((v >> 3) & 0xFC);
+  *b = (uint8_t)(v << 3);
+}
+
+static void copy8_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  memcpy(dst, src, count);
+}
+
+static void copy16_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  memcpy(dst, src, count * 2u);
+}
+
+static void copy24_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  memcpy(dst, src, count * 3u);
+}
+
+static void copy32_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  memcpy(dst, src, count * 4u);
+}
+
+static void rgb24_to_rgba32_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 3, dst += 4) {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+    dst[3] = 255;
+  }
+}
+
+static void rgb24_to_gray8_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 3)
+    *dst++ = pix_luma(src[0], src[1], src[2]);
+}
+
+static void rgb24_to_rgb565_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 3, dst += 2) {
+    uint16_t v = pack565(src[0], src[1], src[2]);
+    memcpy(dst, &v, 2);
+  }
+}
+
+static void rgba32_to_rgb24_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 3) {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+  }
+}
+
+static void rgba32_to_gray8_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4)
+    *dst++ = pix_luma(src[0], src[1], src[2]);
+}
+
+static void rgba32_to_rgb565_c(uint8_t *dst, const uint8_t *src,
+                               size_t count) {
+  for (; count; --count, src += 4, dst += 2) {
+    uint16_t v = pack565(src[0], src[1], src[2]);
+    memcpy(dst, &v, 2);
+  }
+}
+
+static void gray8_to_rgb24_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, dst += 3)
+    dst[0] = dst[1] = dst[2] = *src++;
+}
+
+static void gray8_to_rgba32_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, dst += 4) {
+    dst[0] = dst[1] = dst[2] = *src++;
+    dst[3] = 255;
+  }
+}
+
+static void gray8_to_rgb565_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, ++src, dst += 2) {
+    uint16_t v = pack565(*src, *src, *src);
+    memcpy(dst, &v, 2);
+  }
+}
+
+static void rgb565_to_rgb24_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 2, dst += 3)
+    unpack565(src, &dst[0], &dst[1], &dst[2]);
+}
+
+static void rgb565_to_rgba32_c(uint8_t *dst, const uint8_t *src,
+                               size_t count) {
+  for (; count; --count, src += 2, dst += 4) {
+    unpack565(src, &dst[0], &dst[1], &dst[2]);
+    dst[3] = 255;
+  }
+}
+
+static void rgb565_to_gray8_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 2) {
+    uint8_t r, g, b;
+    unpack565(src, &r, &g, &b);
+    *dst++ = pix_luma(r, g, b);
+  }
+}
+
+static void rgba32_to_rgba32p_c(uint8_t *dst, const uint8_t *src,
+                                size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    uint32_t a = src[3];
+    dst[0] = pix_mul255(src[0], a);
+    dst[1] = pix_mul255(src[1], a);
+    dst[2] = pix_mul255(src[2], a);
+    dst[3] = (uint8_t)a;
+  }
+}
+
+static void rgba32p_to_rgba32_c(uint8_t *dst, const uint8_t *src,
+                                size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    uint32_t a = src[3];
+    if (a == 255u) {
+      memcpy(dst, src, 4);
+      continue;
+    }
+    dst[0] = pix_unpremul(src[0], a);
+    dst[1] = pix_unpremul(src[1], a);
+    dst[2] = pix_unpremul(src[2], a);
+    dst[3] = (uint8_t)a;
+  }
+}
+
+/* Red and blue trade places between the R-first and B-first layouts. */
+static void swap_rb32_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    uint8_t r = src[0];
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = r;
+    dst[3] = src[3];
+  }
+}
+
+static void swap_rb32_opaque_c(uint8_t *dst, const uint8_t *src,
+                               size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    uint8_t r = src[0];
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = r;
+    dst[3] = 255;
+  }
+}
+
+static void copy32_opaque_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    memcpy(dst, src, 3);
+    dst[3] = 255;
+  }
+}
+
+static void swap_rb24_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 3, dst += 3) {
+    uint8_t r = src[0];
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = r;
+  }
+}
+
+static void rgb24_to_bgra32_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 3, dst += 4) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+    dst[3] = 255;
+  }
+}
+
+static void rgba32_to_bgr24_c(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 3) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+  }
+}
+
+static void rgb565_to_bgra32_c(uint8_t *dst, const uint8_t *src,
+                               size_t count) {
+  for (; count; --count, src += 2, dst += 4) {
+    unpack565(src, &dst[2], &dst[1], &dst[0]);
+    dst[3] = 255;
+  }
+}
+
+/* -------- SSE2 / SSSE3 -------- */
+#ifdef PIX_SIMD_SSE2
+/* RGBA32 pixels in 32-bit lanes (R in the low byte) to RGB565 values. */
+static inline __m128i rgb565_epi32_sse2(__m128i x) {
+  __m128i r = _mm_and_si128(_mm_slli_epi32(x, 8), _mm_set1_epi32(0xF800));
+  __m128i g = _mm_and_si128(_mm_srli_epi32(x, 5), _mm_set1_epi32(0x07E0));
+  __m128i b = _mm_and_si128(_mm_srli_epi32(x, 19), _mm_set1_epi32(0x001F));
+  return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+/* Eight 32-bit values below 0x10000 to 16 bits. packs_epi32 saturates as
+ * signed, so the values are biased by 0x8000 through it. */
+static inline __m128i pack_u16_sse2(__m128i lo, __m128i hi) {
+  const __m128i bias = _mm_set1_epi32(0x8000);
+  __m128i v = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+  return _mm_xor_si128(v, _mm_set1_epi16((short)0x8000));
+}
+
+/* pix_luma of RGBA32 pixels in 32-bit lanes. */
+static inline __m128i luma_epi32_sse2(__m128i x) {
+  __m128i rb = _mm_and_si128(x, _mm_set1_epi32(0x00FF00FF));
+  __m128i g = _mm_and_si128(_mm_srli_epi32(x, 8), _mm_set1_epi32(0xFF));
+  __m128i y = _mm_add_epi32(_mm_madd_epi16(rb, _mm_set1_epi32(29 << 16 | 77)),
+                            _mm_madd_epi16(g, _mm_set1_epi32(150)));
+  return _mm_srli_epi32(_mm_add_epi32(y, _mm_set1_epi32(128)), 8);
+}
+
+/* pix_luma of 16-bit channel planes; the sum stays below 0x10000. */
+static inline __m128i luma_epi16_sse2(__m128i r, __m128i g, __m128i b) {
+  __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(77)),
+                            _mm_mullo_epi16(g, _mm_set1_epi16(150)));
+  y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(29)));
+  return _mm_srli_epi16(_mm_add_epi16(y, _mm_set1_epi16(128)), 8);
+}
+
+/* Eight RGB565 pixels to 16-bit planes, low bits zero. */
+static inline void unpack565_sse2(__m128i v, __m128i *r, __m128i *g,
+                                  __m128i *b) {
+  *r = _mm_and_si128(_mm_srli_epi16(v, 8), _mm_set1_epi16(0xF8));
+  *g = _mm_and_si128(_mm_srli_epi16(v, 3), _mm_set1_epi16(0xFC));
+  *b = _mm_and_si128(_mm_slli_epi16(v, 3), _mm_set1_epi16(0xF8));
+}
+
+static void rgba32_to_gray8_sse2(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 16) {
+    __m128i y0 = luma_epi32_sse2(_mm_loadu_si128((const __m128i *)src));
+    __m128i y1 = luma_epi32_sse2(_mm_loadu_si128((const __m128i *)(src + 16)));
+    __m128i y2 = luma_epi32_sse2(_mm_loadu_si128((const __m128i *)(src + 32)));
+    __m128i y3 = luma_epi32_sse2(_mm_loadu_si128((const __m128i *)(src + 48)));
+    __m128i y = _mm_packus_epi16(_mm_packs_epi32(y0, y1),
+                                 _mm_packs_epi32(y2, y3));
+    _mm_storeu_si128((__m128i *)dst, y);
+  }
+  rgba32_to_gray8_c(dst, src, count);
+}
+
+static void rgba32_to_rgb565_sse2(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  for (; count >= 8; count -= 8, src += 32, dst += 16) {
+    __m128i lo = rgb565_epi32_sse2(_mm_loadu_si128((const __m128i *)src));
+    __m128i hi =
+        rgb565_epi32_sse2(_mm_loadu_si128((const __m128i *)(src + 16)));
+    _mm_storeu_si128((__m128i *)dst, pack_u16_sse2(lo, hi));
+  }
+  rgba32_to_rgb565_c(dst, src, count);
+}
+
+static void gray8_to_rgba32_sse2(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  const __m128i ff = _mm_set1_epi8((char)0xFF);
+  for (; count >= 16; count -= 16, src += 16, dst += 64) {
+    __m128i g = _mm_loadu_si128((const __m128i *)src);
+    __m128i gg = _mm_unpacklo_epi8(g, g), ga = _mm_unpacklo_epi8(g, ff);
+    _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(gg, ga));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(gg, ga));
+    gg = _mm_unpackhi_epi8(g, g);
+    ga = _mm_unpackhi_epi8(g, ff);
+    _mm_storeu_si128((__m128i *)(dst + 32), _mm_unpacklo_epi16(gg, ga));
+    _mm_storeu_si128((__m128i *)(dst + 48), _mm_unpackhi_epi16(gg, ga));
+  }
+  gray8_to_rgba32_c(dst, src, count);
+}
+
+static inline __m128i gray565_sse2(__m128i g) {
+  __m128i r = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xF8)), 8);
+  __m128i m = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xFC)), 3);
+  return _mm_or_si128(_mm_or_si128(r, m), _mm_srli_epi16(g, 3));
+}
+
+static void gray8_to_rgb565_sse2(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  for (; count >= 16; count -= 16, src += 16, dst += 32) {
+    __m128i g = _mm_loadu_si128((const __m128i *)src);
+    _mm_storeu_si128((__m128i *)dst, gray565_sse2(_mm_unpacklo_epi8(g, zero)));
+    _mm_storeu_si128((__m128i *)(dst + 16),
+                     gray565_sse2(_mm_unpackhi_epi8(g, zero)));
+  }
+  gray8_to_rgb565_c(dst, src, count);
+}
+
+static void rgb565_to_rgba32_sse2(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  const __m128i a = _mm_set1_epi16((short)0xFF00);
+  for (; count >= 8; count -= 8, src += 16, dst += 32) {
+    __m128i r, g, b;
+    unpack565_sse2(_mm_loadu_si128((const __m128i *)src), &r, &g, &b);
+    __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    __m128i ba = _mm_or_si128(b, a);
+    _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(rg, ba));
+  }
+  rgb565_to_rgba32_c(dst, src, count);
+}
+
+static void rgb565_to_gray8_sse2(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 32, dst += 16) {
+    __m128i r, g, b;
+    unpack565_sse2(_mm_loadu_si128((const __m128i *)src), &r, &g, &b);
+    __m128i lo = luma_epi16_sse2(r, g, b);
+    unpack565_sse2(_mm_loadu_si128((const __m128i *)(src + 16)), &r, &g, &b);
+    __m128i hi = luma_epi16_sse2(r, g, b);
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(lo, hi));
+  }
+  rgb565_to_gray8_c(dst, src, count);
+}
+
+static void rgba32_to_rgba32p_sse2(uint8_t *dst, const uint8_t *src,
+                                   size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  // Alpha lanes multiply by 255, which leaves them unchanged.
+  const __m128i keep = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+  const __m128i r = _mm_set1_epi16(128);
+  for (; count >= 4; count -= 4, src += 16, dst += 16) {
+    __m128i s = _mm_loadu_si128((const __m128i *)src);
+    __m128i a = _mm_srli_epi32(s, 24);
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero),
+                                 _mm_or_si128(_mm_unpacklo_epi32(a, a), keep));
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero),
+                                 _mm_or_si128(_mm_unpackhi_epi32(a, a), keep));
+    // Exact (x + 127) / 255 from t = x + 128.
+    lo = _mm_add_epi16(lo, r);
+    hi = _mm_add_epi16(hi, r);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(lo, hi));
+  }
+  rgba32_to_rgba32p_c(dst, src, count);
+}
+
+/* Opaque runs copy four pixels at a time; anything else divides per pixel.
+ */
+static void rgba32p_to_rgba32_sse2(uint8_t *dst, const uint8_t *src,
+                                   size_t count) {
+  const __m128i amask = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 4; count -= 4, src += 16, dst += 16) {
+    __m128i s = _mm_loadu_si128((const __m128i *)src);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, amask), amask)) ==
+        0xFFFF)
+      _mm_storeu_si128((__m128i *)dst, s);
+    else
+      rgba32p_to_rgba32_c(dst, src, 4);
+  }
+  rgba32p_to_rgba32_c(dst, src, count);
+}
+
+/* Swap bytes 0 and 2 of each 32-bit lane. */
+static inline __m128i swap_rb_sse2(__m128i x) {
+  __m128i ga = _mm_and_si128(x, _mm_set1_epi32((int)0xFF00FF00u));
+  __m128i rb = _mm_and_si128(x, _mm_set1_epi32(0x00FF00FF));
+  rb = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, 0xB1), 0xB1);
+  return _mm_or_si128(ga, rb);
+}
+
+static void swap_rb32_sse2(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 4; count -= 4, src += 16, dst += 16)
+    _mm_storeu_si128((__m128i *)dst,
+                     swap_rb_sse2(_mm_loadu_si128((const __m128i *)src)));
+  swap_rb32_c(dst, src, count);
+}
+
+static void swap_rb32_opaque_sse2(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  const __m128i a = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 4; count -= 4, src += 16, dst += 16) {
+    __m128i x = swap_rb_sse2(_mm_loadu_si128((const __m128i *)src));
+    _mm_storeu_si128((__m128i *)dst, _mm_or_si128(x, a));
+  }
+  swap_rb32_opaque_c(dst, src, count);
+}
+
+static void copy32_opaque_sse2(uint8_t *dst, const uint8_t *src,
+                               size_t count) {
+  const __m128i a = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 4; count -= 4, src += 16, dst += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i *)src);
+    _mm_storeu_si128((__m128i *)dst, _mm_or_si128(x, a));
+  }
+  copy32_opaque_c(dst, src, count);
+}
+
+static void rgb565_to_bgra32_sse2(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  const __m128i a = _mm_set1_epi16((short)0xFF00);
+  for (; count >= 8; count -= 8, src += 16, dst += 32) {
+    __m128i r, g, b;
+    unpack565_sse2(_mm_loadu_si128((const __m128i *)src), &r, &g, &b);
+    __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+    __m128i ra = _mm_or_si128(r, a);
+    _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+  }
+  rgb565_to_bgra32_c(dst, src, count);
+}
+#endif
+
+#ifdef PIX_SIMD_AVX2
+/* RGB24 moves between 3- and 4-byte layouts with byte shuffles (SSSE3),
+ * sixteen pixels (48 bytes, three whole vectors) at a time. */
+__attribute__((target("ssse3"))) static inline void
+load_rgb24_ssse3(const uint8_t *src, __m128i px[4]) {
+  const __m128i expand =
+      _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  __m128i v0 = _mm_loadu_si128((const __m128i *)src);
+  __m128i v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+  __m128i v2 = _mm_loadu_si128((const __m128i *)(src + 32));
+  px[0] = _mm_shuffle_epi8(v0, expand);
+  px[1] = _mm_shuffle_epi8(_mm_alignr_epi8(v1, v0, 12), expand);
+  px[2] = _mm_shuffle_epi8(_mm_alignr_epi8(v2, v1, 8), expand);
+  px[3] = _mm_shuffle_epi8(_mm_srli_si128(v2, 4), expand);
+}
+
+__attribute__((target("ssse3"))) static inline void
+store_rgb24_ssse3(uint8_t *dst, const __m128i px[4]) {
+  const __m128i pack =
+      _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  __m128i p0 = _mm_shuffle_epi8(px[0], pack);
+  __m128i p1 = _mm_shuffle_epi8(px[1], pack);
+  __m128i p2 = _mm_shuffle_epi8(px[2], pack);
+  __m128i p3 = _mm_shuffle_epi8(px[3], pack);
+  _mm_storeu_si128((__m128i *)dst, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+  _mm_storeu_si128((__m128i *)(dst + 16),
+                   _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+  _mm_storeu_si128((__m128i *)(dst + 32),
+                   _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+}
+
+__attribute__((target("ssse3"))) static void
+rgb24_to_rgba32_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m128i a = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 16; count -= 16, src += 48, dst += 64) {
+    __m128i px[4];
+    load_rgb24_ssse3(src, px);
+    for (int i = 0; i < 4; ++i)
+      _mm_storeu_si128((__m128i *)(dst + 16 * i), _mm_or_si128(px[i], a));
+  }
+  rgb24_to_rgba32_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+rgb24_to_gray8_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 16) {
+    __m128i px[4];
+    load_rgb24_ssse3(src, px);
+    __m128i lo = _mm_packs_epi32(luma_epi32_sse2(px[0]),
+                                 luma_epi32_sse2(px[1]));
+    __m128i hi = _mm_packs_epi32(luma_epi32_sse2(px[2]),
+                                 luma_epi32_sse2(px[3]));
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(lo, hi));
+  }
+  rgb24_to_gray8_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+rgb24_to_rgb565_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 32) {
+    __m128i px[4];
+    load_rgb24_ssse3(src, px);
+    _mm_storeu_si128((__m128i *)dst, pack_u16_sse2(rgb565_epi32_sse2(px[0]),
+                                                   rgb565_epi32_sse2(px[1])));
+    _mm_storeu_si128(
+        (__m128i *)(dst + 16),
+        pack_u16_sse2(rgb565_epi32_sse2(px[2]), rgb565_epi32_sse2(px[3])));
+  }
+  rgb24_to_rgb565_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+rgba32_to_rgb24_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 48) {
+    __m128i px[4];
+    for (int i = 0; i < 4; ++i)
+      px[i] = _mm_loadu_si128((const __m128i *)(src + 16 * i));
+    store_rgb24_ssse3(dst, px);
+  }
+  rgba32_to_rgb24_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+gray8_to_rgb24_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m128i m0 =
+      _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+  const __m128i m1 =
+      _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+  const __m128i m2 =
+      _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15,
+                    15, 15);
+  for (; count >= 16; count -= 16, src += 16, dst += 48) {
+    __m128i g = _mm_loadu_si128((const __m128i *)src);
+    _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(g, m0));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_shuffle_epi8(g, m1));
+    _mm_storeu_si128((__m128i *)(dst + 32), _mm_shuffle_epi8(g, m2));
+  }
+  gray8_to_rgb24_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+rgb565_to_rgb24_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m128i a = _mm_set1_epi16((short)0xFF00);
+  for (; count >= 16; count -= 16, src += 32, dst += 48) {
+    __m128i px[4];
+    for (int i = 0; i < 2; ++i) {
+      __m128i r, g, b;
+      unpack565_sse2(_mm_loadu_si128((const __m128i *)(src + 16 * i)), &r, &g,
+                     &b);
+      __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+      __m128i ba = _mm_or_si128(b, a);
+      px[2 * i] = _mm_unpacklo_epi16(rg, ba);
+      px[2 * i + 1] = _mm_unpackhi_epi16(rg, ba);
+    }
+    store_rgb24_ssse3(dst, px);
+  }
+  rgb565_to_rgb24_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+swap_rb24_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 48) {
+    __m128i px[4];
+    load_rgb24_ssse3(src, px);
+    for (int i = 0; i < 4; ++i)
+      px[i] = swap_rb_sse2(px[i]);
+    store_rgb24_ssse3(dst, px);
+  }
+  swap_rb24_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+rgb24_to_bgra32_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m128i a = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 16; count -= 16, src += 48, dst += 64) {
+    __m128i px[4];
+    load_rgb24_ssse3(src, px);
+    for (int i = 0; i < 4; ++i)
+      _mm_storeu_si128((__m128i *)(dst + 16 * i),
+                       _mm_or_si128(swap_rb_sse2(px[i]), a));
+  }
+  rgb24_to_bgra32_c(dst, src, count);
+}
+
+__attribute__((target("ssse3"))) static void
+rgba32_to_bgr24_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 48) {
+    __m128i px[4];
+    for (int i = 0; i < 4; ++i)
+      px[i] = swap_rb_sse2(_mm_loadu_si128((const __m128i *)(src + 16 * i)));
+    store_rgb24_ssse3(dst, px);
+  }
+  rgba32_to_bgr24_c(dst, src, count);
+}
+#endif
+
+/* -------- NEON -------- */
+#ifdef PIX_SIMD_NEON
+static inline uint8x8_t luma_neon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+  uint16x8_t y = vmull_u8(r, vdup_n_u8(77));
+  y = vmlal_u8(y, g, vdup_n_u8(150));
+  y = vmlal_u8(y, b, vdup_n_u8(29));
+  return vrshrn_n_u16(y, 8);
+}
+
+static inline uint8x16_t luma16_neon(uint8x16_t r, uint8x16_t g,
+                                     uint8x16_t b) {
+  return vcombine_u8(
+      luma_neon(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b)),
+      luma_neon(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b)));
+}
+
+static inline uint16x8_t pack565_neon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+  uint16x8_t v = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+  v = vorrq_u16(v, vshll_n_u8(vand_u8(g, vdup_n_u8(0xFC)), 3));
+  return vorrq_u16(v, vmovl_u8(vshr_n_u8(b, 3)));
+}
+
+static inline void store565_neon(uint8_t *dst, uint8x16_t r, uint8x16_t g,
+                                 uint8x16_t b) {
+  uint16x8_t lo = pack565_neon(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b));
+  uint16x8_t hi =
+      pack565_neon(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b));
+  vst1q_u8(dst, vreinterpretq_u8_u16(lo));
+  vst1q_u8(dst + 16, vreinterpretq_u8_u16(hi));
+}
+
+/* Eight RGB565 pixels to 8-bit planes, low bits zero. */
+static inline uint8x8x3_t unpack565_neon(const uint8_t *src) {
+  uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src));
+  uint8x8x3_t c;
+  c.val[0] = vand_u8(vshrn_n_u16(v, 8), vdup_n_u8(0xF8));
+  c.val[1] = vand_u8(vshrn_n_u16(v, 3), vdup_n_u8(0xFC));
+  c.val[2] = vand_u8(vmovn_u16(vshlq_n_u16(v, 3)), vdup_n_u8(0xF8));
+  return c;
+}
+
+static void rgb24_to_rgba32_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 64) {
+    uint8x16x3_t s = vld3q_u8(src);
+    uint8x16x4_t d = {{s.val[0], s.val[1], s.val[2], vdupq_n_u8(255)}};
+    vst4q_u8(dst, d);
+  }
+  rgb24_to_rgba32_c(dst, src, count);
+}
+
+static void rgb24_to_gray8_neon(uint8_t *dst, const uint8_t *src,
+                                size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 16) {
+    uint8x16x3_t s = vld3q_u8(src);
+    vst1q_u8(dst, luma16_neon(s.val[0], s.val[1], s.val[2]));
+  }
+  rgb24_to_gray8_c(dst, src, count);
+}
+
+static void rgb24_to_rgb565_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 32) {
+    uint8x16x3_t s = vld3q_u8(src);
+    store565_neon(dst, s.val[0], s.val[1], s.val[2]);
+  }
+  rgb24_to_rgb565_c(dst, src, count);
+}
+
+static void rgba32_to_rgb24_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 48) {
+    uint8x16x4_t s = vld4q_u8(src);
+    uint8x16x3_t d = {{s.val[0], s.val[1], s.val[2]}};
+    vst3q_u8(dst, d);
+  }
+  rgba32_to_rgb24_c(dst, src, count);
+}
+
+static void rgba32_to_gray8_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 16) {
+    uint8x16x4_t s = vld4q_u8(src);
+    vst1q_u8(dst, luma16_neon(s.val[0], s.val[1], s.val[2]));
+  }
+  rgba32_to_gray8_c(dst, src, count);
+}
+
+static void rgba32_to_rgb565_neon(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 32) {
+    uint8x16x4_t s = vld4q_u8(src);
+    store565_neon(dst, s.val[0], s.val[1], s.val[2]);
+  }
+  rgba32_to_rgb565_c(dst, src, count);
+}
+
+static void gray8_to_rgb24_neon(uint8_t *dst, const uint8_t *src,
+                                size_t count) {
+  for (; count >= 16; count -= 16, src += 16, dst += 48) {
+    uint8x16_t g = vld1q_u8(src);
+    uint8x16x3_t d = {{g, g, g}};
+    vst3q_u8(dst, d);
+  }
+  gray8_to_rgb24_c(dst, src, count);
+}
+
+static void gray8_to_rgba32_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 16, dst += 64) {
+    uint8x16_t g = vld1q_u8(src);
+    uint8x16x4_t d = {{g, g, g, vdupq_n_u8(255)}};
+    vst4q_u8(dst, d);
+  }
+  gray8_to_rgba32_c(dst, src, count);
+}
+
+static void gray8_to_rgb565_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 16, dst += 32) {
+    uint8x16_t g = vld1q_u8(src);
+    store565_neon(dst, g, g, g);
+  }
+  gray8_to_rgb565_c(dst, src, count);
+}
+
+static void rgb565_to_rgb24_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 8; count -= 8, src += 16, dst += 24)
+    vst3_u8(dst, unpack565_neon(src));
+  rgb565_to_rgb24_c(dst, src, count);
+}
+
+static void rgb565_to_rgba32_neon(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  for (; count >= 8; count -= 8, src += 16, dst += 32) {
+    uint8x8x3_t c = unpack565_neon(src);
+    uint8x8x4_t d = {{c.val[0], c.val[1], c.val[2], vdup_n_u8(255)}};
+    vst4_u8(dst, d);
+  }
+  rgb565_to_rgba32_c(dst, src, count);
+}
+
+static void rgb565_to_gray8_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 8; count -= 8, src += 16, dst += 8) {
+    uint8x8x3_t c = unpack565_neon(src);
+    vst1_u8(dst, luma_neon(c.val[0], c.val[1], c.val[2]));
+  }
+  rgb565_to_gray8_c(dst, src, count);
+}
+
+static inline uint8x8_t mul255_neon(uint8x8_t c, uint8x8_t a) {
+  uint16x8_t t = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+  return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+static void rgba32_to_rgba32p_neon(uint8_t *dst, const uint8_t *src,
+                                   size_t count) {
+  for (; count >= 8; count -= 8, src += 32, dst += 32) {
+    uint8x8x4_t p = vld4_u8(src);
+    p.val[0] = mul255_neon(p.val[0], p.val[3]);
+    p.val[1] = mul255_neon(p.val[1], p.val[3]);
+    p.val[2] = mul255_neon(p.val[2], p.val[3]);
+    vst4_u8(dst, p);
+  }
+  rgba32_to_rgba32p_c(dst, src, count);
+}
+
+static void swap_rb32_neon(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 64) {
+    uint8x16x4_t p = vld4q_u8(src);
+    uint8x16_t r = p.val[0];
+    p.val[0] = p.val[2];
+    p.val[2] = r;
+    vst4q_u8(dst, p);
+  }
+  swap_rb32_c(dst, src, count);
+}
+
+static void swap_rb32_opaque_neon(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 64) {
+    uint8x16x4_t p = vld4q_u8(src);
+    uint8x16_t r = p.val[0];
+    p.val[0] = p.val[2];
+    p.val[2] = r;
+    p.val[3] = vdupq_n_u8(255);
+    vst4q_u8(dst, p);
+  }
+  swap_rb32_opaque_c(dst, src, count);
+}
+
+static void swap_rb24_neon(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 48) {
+    uint8x16x3_t p = vld3q_u8(src);
+    uint8x16_t r = p.val[0];
+    p.val[0] = p.val[2];
+    p.val[2] = r;
+    vst3q_u8(dst, p);
+  }
+  swap_rb24_c(dst, src, count);
+}
+
+static void rgb24_to_bgra32_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 48, dst += 64) {
+    uint8x16x3_t s = vld3q_u8(src);
+    uint8x16x4_t d = {{s.val[2], s.val[1], s.val[0], vdupq_n_u8(255)}};
+    vst4q_u8(dst, d);
+  }
+  rgb24_to_bgra32_c(dst, src, count);
+}
+
+static void rgba32_to_bgr24_neon(uint8_t *dst, const uint8_t *src,
+                                 size_t count) {
+  for (; count >= 16; count -= 16, src += 64, dst += 48) {
+    uint8x16x4_t s = vld4q_u8(src);
+    uint8x16x3_t d = {{s.val[2], s.val[1], s.val[0]}};
+    vst3q_u8(dst, d);
+  }
+  rgba32_to_bgr24_c(dst, src, count);
+}
+
+static void rgb565_to_bgra32_neon(uint8_t *dst, const uint8_t *src,
+                                  size_t count) {
+  for (; count >= 8; count -= 8, src += 16, dst += 32) {
+    uint8x8x3_t c = unpack565_neon(src);
+    uint8x8x4_t d = {{c.val[2], c.val[1], c.val[0], vdup_n_u8(255)}};
+    vst4_u8(dst, d);
+  }
+  rgb565_to_bgra32_c(dst, src, count);
+}
+#endif
+
+/* -------- Table -------- */
+/* Indexed [dst][src]. Resolved once, on first use; as for the SIMD ops,
+ * pthread_once publishes it to concurrent band workers. */
+static pix_convert_fn table[FMT_COUNT][FMT_COUNT];
+#ifdef VG_ENABLE_THREADS
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+#else
+static bool table_ready;
+#endif
+
+#define SET(d, s, fn) t[PIX_FMT_##d][PIX_FMT_##s] = (fn)
+#define ALIAS(d, s, d2, s2)                                                   \
+  t[PIX_FMT_##d][PIX_FMT_##s] = t[PIX_FMT_##d2][PIX_FMT_##s2]
+
+static void table_init(pix_convert_fn t[FMT_COUNT][FMT_COUNT]) {
+  SET(RGB24, RGB24, copy24_c);
+  SET(RGBA32, RGBA32, copy32_c);
+  SET(GRAY8, GRAY8, copy8_c);
+  SET(RGB565, RGB565, copy16_c);
+  SET(RGBA32_PREMUL, RGBA32_PREMUL, copy32_c);
+  SET(BGRA32, BGRA32, copy32_c);
+  SET(XRGB32, XRGB32, copy32_c);
+  SET(BGR24, BGR24, copy24_c);
+  SET(RGBA32, RGB24, rgb24_to_rgba32_c);
+  SET(GRAY8, RGB24, rgb24_to_gray8_c);
+  SET(RGB565, RGB24, rgb24_to_rgb565_c);
+  SET(RGB24, RGBA32, rgba32_to_rgb24_c);
+  SET(GRAY8, RGBA32, rgba32_to_gray8_c);
+  SET(RGB565, RGBA32, rgba32_to_rgb565_c);
+  SET(RGB24, GRAY8, gray8_to_rgb24_c);
+  SET(RGBA32, GRAY8, gray8_to_rgba32_c);
+  SET(RGB565, GRAY8, gray8_to_rgb565_c);
+  SET(RGB24, RGB565, rgb565_to_rgb24_c);
+  SET(RGBA32, RGB565, rgb565_to_rgba32_c);
+  SET(GRAY8, RGB565, rgb565_to_gray8_c);
+  SET(RGBA32_PREMUL, RGBA32, rgba32_to_rgba32p_c);
+  SET(RGBA32, RGBA32_PREMUL, rgba32p_to_rgba32_c);
+  SET(BGRA32, RGBA32, swap_rb32_c);
+  SET(RGBA32, BGRA32, swap_rb32_c);
+  SET(XRGB32, RGBA32, swap_rb32_opaque_c);
+  SET(RGBA32, XRGB32, swap_rb32_opaque_c);
+  SET(XRGB32, BGRA32, copy32_opaque_c);
+  SET(BGRA32, XRGB32, copy32_opaque_c);
+  SET(BGR24, RGB24, swap_rb24_c);
+  SET(RGB24, BGR24, swap_rb24_c);
+  SET(BGRA32, RGB24, rgb24_to_bgra32_c);
+  SET(XRGB32, RGB24, rgb24_to_bgra32_c);
+  SET(RGBA32, BGR24, rgb24_to_bgra32_c);
+  SET(BGR24, RGBA32, rgba32_to_bgr24_c);
+  SET(RGB24, BGRA32, rgba32_to_bgr24_c);
+  SET(RGB24, XRGB32, rgba32_to_bgr24_c);
+  SET(BGRA32, RGB565, rgb565_to_bgra32_c);
+  SET(XRGB32, RGB565, rgb565_to_bgra32_c);
+#if defined(PIX_SIMD_SSE2)
+  SET(GRAY8, RGBA32, rgba32_to_gray8_sse2);
+  SET(RGB565, RGBA32, rgba32_to_rgb565_sse2);
+  SET(RGBA32, GRAY8, gray8_to_rgba32_sse2);
+  SET(RGB565, GRAY8, gray8_to_rgb565_sse2);
+  SET(RGBA32, RGB565, rgb565_to_rgba32_sse2);
+  SET(GRAY8, RGB565, rgb565_to_gray8_sse2);
+  SET(RGBA32_PREMUL, RGBA32, rgba32_to_rgba32p_sse2);
+  SET(RGBA32, RGBA32_PREMUL, rgba32p_to_rgba32_sse2);
+  SET(BGRA32, RGBA32, swap_rb32_sse2);
+  SET(RGBA32, BGRA32, swap_rb32_sse2);
+  SET(XRGB32, RGBA32, swap_rb32_opaque_sse2);
+  SET(RGBA32, XRGB32, swap_rb32_opaque_sse2);
+  SET(XRGB32, BGRA32, copy32_opaque_sse2);
+  SET(BGRA32, XRGB32, copy32_opaque_sse2);
+  SET(BGRA32, RGB565, rgb565_to_bgra32_sse2);
+  SET(XRGB32, RGB565, rgb565_to_bgra32_sse2);
+#if defined(PIX_SIMD_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {
+    SET(RGBA32, RGB24, rgb24_to_rgba32_ssse3);
+    SET(GRAY8, RGB24, rgb24_to_gray8_ssse3);
+    SET(RGB565, RGB24, rgb24_to_rgb565_ssse3);
+    SET(RGB24, RGBA32, rgba32_to_rgb24_ssse3);
+    SET(RGB24, GRAY8, gray8_to_rgb24_ssse3);
+    SET(RGB24, RGB565, rgb565_to_rgb24_ssse3);
+    SET(BGR24, RGB24, swap_rb24_ssse3);
+    SET(RGB24, BGR24, swap_rb24_ssse3);
+    SET(BGRA32, RGB24, rgb24_to_bgra32_ssse3);
+    SET(XRGB32, RGB24, rgb24_to_bgra32_ssse3);
+    SET(RGBA32, BGR24, rgb24_to_bgra32_ssse3);
+    SET(BGR24, RGBA32, rgba32_to_bgr24_ssse3);
+    SET(RGB24, BGRA32, rgba32_to_bgr24_ssse3);
+    SET(RGB24, XRGB32, rgba32_to_bgr24_ssse3);
+  }
+#endif
+#elif defined(PIX_SIMD_NEON)
+  SET(RGBA32, RGB24, rgb24_to_rgba32_neon);
+  SET(GRAY8, RGB24, rgb24_to_gray8_neon);
+  SET(RGB565, RGB24, rgb24_to_rgb565_neon);
+  SET(RGB24, RGBA32, rgba32_to_rgb24_neon);
+  SET(GRAY8, RGBA32, rgba32_to_gray8_neon);
+  SET(RGB565, RGBA32, rgba32_to_rgb565_neon);
+  SET(RGB24, GRAY8, gray8_to_rgb24_neon);
+  SET(RGBA32, GRAY8, gray8_to_rgba32_neon);
+  SET(RGB565, GRAY8, gray8_to_rgb565_neon);
+  SET(RGB24, RGB565, rgb565_to_rgb24_neon);
+  SET(RGBA32, RGB565, rgb565_to_rgba32_neon);
+  SET(GRAY8, RGB565, rgb565_to_gray8_neon);
+  SET(RGBA32_PREMUL, RGBA32, rgba32_to_rgba32p_neon);
+  SET(BGRA32, RGBA32, swap_rb32_neon);
+  SET(RGBA32, BGRA32, swap_rb32_neon);
+  SET(XRGB32, RGBA32, swap_rb32_opaque_neon);
+  SET(RGBA32, XRGB32, swap_rb32_opaque_neon);
+  SET(BGR24, RGB24, swap_rb24_neon);
+  SET(RGB24, BGR24, swap_rb24_neon);
+  SET(BGRA32, RGB24, rgb24_to_bgra32_neon);
+  SET(XRGB32, RGB24, rgb24_to_bgra32_neon);
+  SET(RGBA32, BGR24, rgb24_to_bgra32_neon);
+  SET(BGR24, RGBA32, rgba32_to_bgr24_neon);
+  SET(RGB24, BGRA32, rgba32_to_bgr24_neon);
+  SET(RGB24, XRGB32, rgba32_to_bgr24_neon);
+  SET(BGRA32, RGB565, rgb565_to_bgra32_neon);
+  SET(XRGB32, RGB565, rgb565_to_bgra32_neon);
+#endif
+  // Kernels that never look at channel order serve the B-first layouts too.
+  ALIAS(BGRA32, BGR24, RGBA32, RGB24);
+  ALIAS(XRGB32, BGR24, RGBA32, RGB24);
+  ALIAS(BGR24, BGRA32, RGB24, RGBA32);
+  ALIAS(BGR24, XRGB32, RGB24, RGBA32);
+  ALIAS(BGRA32, GRAY8, RGBA32, GRAY8);
+  ALIAS(XRGB32, GRAY8, RGBA32, GRAY8);
+  ALIAS(BGR24, GRAY8, RGB24, GRAY8);
+  // Opaque sources read the same into either RGBA32 layout.
+  ALIAS(RGBA32_PREMUL, RGB24, RGBA32, RGB24);
+  ALIAS(RGBA32_PREMUL, GRAY8, RGBA32, GRAY8);
+  ALIAS(RGBA32_PREMUL, RGB565, RGBA32, RGB565);
+  ALIAS(RGBA32_PREMUL, XRGB32, RGBA32, XRGB32);
+  ALIAS(RGBA32_PREMUL, BGR24, RGBA32, BGR24);
+}
+
+#undef ALIAS
+#undef SET
+
+#ifdef VG_ENABLE_THREADS
+static void table_once_init(void) { table_init(table); }
+#endif
+
+pix_convert_fn pix_convert_row_fn(pix_format_t dst, pix_format_t src) {
+  if ((unsigned)dst >= FMT_COUNT || (unsigned)src >= FMT_COUNT)
+    return NULL;
+#ifdef VG_ENABLE_THREADS
+  pthread_once(&table_once, table_once_init);
+#else
+  if (!table_ready) {
+    table_init(table);
+    table_ready = true;
+  }
+#endif
+  return table[dst][src];
+}
+
+bool pix_convert_row(pix_format_t dst_format, uint8_t *dst,
+                     pix_format_t src_format, const uint8_t *src,
+                     size_t count) {
+  pix_convert_fn direct = pix_convert_row_fn(dst_format, src_format);
+  if (direct) {
+    direct(dst, src, count);
+    return true;
+  }
+  // Everything converts to and from RGBA32 directly; go through it a block
+  // at a time.
+  pix_convert_fn in = pix_convert_row_fn(PIX_FMT_RGBA32, src_format);
+  pix_convert_fn out = pix_convert_row_fn(dst_format, PIX_FMT_RGBA32);
+  if (!in || !out)
+    return false;
+  size_t sbpp = pix_format_bytes(src_format);
+  size_t dbpp = pix_format_bytes(dst_format);
+  uint8_t tmp[256 * 4];
+  while (count) {
+    size_t n = count < 256 ? count : 256;
+    in(tmp, src, n);
+    out(dst, tmp, n);
+    src += n * sbpp;
+    dst += n * dbpp;
+    count -= n;
+  }
+  return true;
+}
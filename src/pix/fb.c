@@ -12,35 +12,264 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #if defined(__linux__)
 #include <linux/fb.h>
 #define PIX_ENABLE_FB 1
 #endif
+#include <pix/fb.h>
 
 #ifdef PIX_ENABLE_FB
 
+typedef enum {
+  FB_MODE_DIRECT,
+  FB_MODE_SHADOW,
+  FB_MODE_FLIP,
+} fb_mode_t;
+
 typedef struct pix_fb_ctx_t {
   int fd;
+  void *map;
   size_t map_length;
+  size_t line_length;
+  fb_mode_t mode;
+  struct fb_var_screeninfo vinfo;
+  uint32_t yoffset0; /* pan offset at open, restored on destroy */
+  /* FB_MODE_FLIP: pages of yres rows in the mapping; back is drawn to. */
+  unsigned pages;
+  unsigned back;
+  /* FB_MODE_SHADOW: cached back buffer and a copy of what the device shows,
+   * both packed at row_bytes. */
+  uint8_t *shadow;
+  uint8_t *front;
+  size_t row_bytes;
+  /* PIXFB_VSYNC pacing: FBIO_WAITFORVSYNC while the driver supports it, else
+   * an absolute timer at period_ns. */
+  bool vsync;
+  bool vsync_ioctl;
+  uint64_t period_ns;
+  uint64_t next_ns;
+  /* Present intervals, for pixfb_frame_stats. */
+  uint64_t last_ns;
+  uint64_t intervals;
+  uint64_t sum_ns, min_ns, max_ns, late;
 } pix_fb_ctx_t;
 
+static uint64_t fb_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Refresh period from the mode timings, or 60 Hz when the driver leaves
+ * pixclock unset. */
+static uint64_t fb_period_ns(const struct fb_var_screeninfo *v) {
+  uint64_t htotal = (uint64_t)v->xres + v->left_margin + v->right_margin +
+                    v->hsync_len;
+  uint64_t vtotal = (uint64_t)v->yres + v->upper_margin + v->lower_margin +
+                    v->vsync_len;
+  uint64_t ns = (uint64_t)v->pixclock * htotal * vtotal / 1000u;
+  if (v->pixclock == 0 || ns < 1000000u || ns > 200000000u)
+    return 1000000000u / 60u;
+  return ns;
+}
+
+/* Block until the next vertical blank, or the next timer tick when the
+ * driver cannot report it. */
+static void fb_wait_vsync(pix_fb_ctx_t *ctx) {
+#ifdef FBIO_WAITFORVSYNC
+  if (ctx->vsync_ioctl) {
+    __u32 crtc = 0;
+    if (ioctl(ctx->fd, FBIO_WAITFORVSYNC, &crtc) == 0)
+      return;
+    ctx->vsync_ioctl = false;
+  }
+#endif
+  uint64_t now = fb_now_ns();
+  // Ticks stay on a fixed grid so sleeps do not accumulate drift; after a
+  // stall the grid restarts from now rather than firing a burst.
+  if (ctx->next_ns == 0 || now > ctx->next_ns + ctx->period_ns)
+    ctx->next_ns = now;
+  ctx->next_ns += ctx->period_ns;
+  struct timespec ts = {(time_t)(ctx->next_ns / 1000000000u),
+                        (long)(ctx->next_ns % 1000000000u)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    ;
+}
+
+static void fb_record_present(pix_fb_ctx_t *ctx) {
+  uint64_t now = fb_now_ns();
+  if (ctx->last_ns) {
+    uint64_t d = now - ctx->last_ns;
+    if (ctx->intervals == 0 || d < ctx->min_ns)
+      ctx->min_ns = d;
+    if (d > ctx->max_ns)
+      ctx->max_ns = d;
+    if (d > ctx->period_ns + ctx->period_ns / 2)
+      ++ctx->late;
+    ctx->sum_ns += d;
+    ++ctx->intervals;
+  }
+  ctx->last_ns = now;
+}
+
+static uint8_t *fb_page(pix_fb_ctx_t *ctx, unsigned page) {
+  return (uint8_t *)ctx->map +
+         (size_t)page * ctx->vinfo.yres * ctx->line_length;
+}
+
+static bool fb_pan(pix_fb_ctx_t *ctx, uint32_t yoffset) {
+  struct fb_var_screeninfo v = ctx->vinfo;
+  v.xoffset = 0;
+  v.yoffset = yoffset;
+  if (ioctl(ctx->fd, FBIOPAN_DISPLAY, &v) < 0)
+    return false;
+  ctx->vinfo.yoffset = yoffset;
+  return true;
+}
+
 static bool fb_lock(struct pix_frame_t *f) { return f && f->pixels != NULL; }
-static void fb_unlock(struct pix_frame_t *f) { (void)f; }
+
+/* Copy rows that changed since the last present; device memory is often
+ * uncached, so comparing against the system-memory front copy is far cheaper
+ * than rewriting every row. */
+static void fb_present_shadow(pix_frame_t *f, pix_fb_ctx_t *ctx) {
+  uint8_t *dev = (uint8_t *)ctx->map;
+  for (uint16_t y = 0; y < f->size.h; ++y) {
+    const uint8_t *src = ctx->shadow + (size_t)y * ctx->row_bytes;
+    uint8_t *seen = ctx->front + (size_t)y * ctx->row_bytes;
+    if (memcmp(src, seen, ctx->row_bytes) == 0)
+      continue;
+    memcpy(dev + (size_t)y * ctx->line_length, src, ctx->row_bytes);
+    memcpy(seen, src, ctx->row_bytes);
+  }
+}
+
+static void fb_unlock(struct pix_frame_t *f) {
+  if (!f || !f->user)
+    return;
+  pix_fb_ctx_t *ctx = (pix_fb_ctx_t *)f->user;
+  switch (ctx->mode) {
+  case FB_MODE_SHADOW:
+    // Copy during blanking so the update does not tear.
+    if (ctx->vsync)
+      fb_wait_vsync(ctx);
+    fb_present_shadow(f, ctx);
+    break;
+  case FB_MODE_FLIP:
+    if (fb_pan(ctx, ctx->back * ctx->vinfo.yres)) {
+      ctx->back = (ctx->back + 1) % ctx->pages;
+      f->pixels = fb_page(ctx, ctx->back);
+    } else {
+      // The driver stopped panning: draw into the page on screen instead.
+      ctx->mode = FB_MODE_DIRECT;
+      f->pixels = fb_page(ctx, ctx->vinfo.yoffset / ctx->vinfo.yres);
+    }
+    // Let the pan take effect before the old page is drawn into again.
+    if (ctx->vsync)
+      fb_wait_vsync(ctx);
+    break;
+  default:
+    if (ctx->vsync)
+      fb_wait_vsync(ctx);
+    break;
+  }
+  fb_record_present(ctx);
+}
+
+/* Byte index in memory of an 8-bit channel at bit @p offset of a
+ * @p bytespp-byte pixel word. */
+static unsigned fb_byte(unsigned offset, unsigned bytespp) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return bytespp - 1u - offset / 8u;
+#else
+  (void)bytespp;
+  return offset / 8u;
+#endif
+}
+
+/* Pick the format whose memory layout matches the device's, so frames are
+ * written without swizzling. */
+static pix_format_t fb_format(const struct fb_var_screeninfo *v) {
+  unsigned bytespp = v->bits_per_pixel / 8u;
+  if (v->bits_per_pixel == 16 && v->red.length == 5 &&
+      v->green.length == 6 && v->blue.length == 5)
+    return PIX_FMT_RGB565;
+  if (v->bits_per_pixel == 8)
+    return PIX_FMT_GRAY8; /* optimistic */
+  if ((bytespp != 3 && bytespp != 4) || v->red.length != 8 ||
+      v->green.length != 8 || v->blue.length != 8 ||
+      fb_byte(v->green.offset, bytespp) != 1)
+    return PIX_FMT_UNKNOWN;
+  unsigned r = fb_byte(v->red.offset, bytespp);
+  unsigned b = fb_byte(v->blue.offset, bytespp);
+  if (bytespp == 3) {
+    if (r == 0 && b == 2)
+      return PIX_FMT_RGB24;
+    if (r == 2 && b == 0)
+      return PIX_FMT_BGR24;
+    return PIX_FMT_UNKNOWN;
+  }
+  if (r == 0 && b == 2)
+    return PIX_FMT_RGBA32;
+  if (r == 2 && b == 0)
+    return v->transp.length ? PIX_FMT_BGRA32 : PIX_FMT_XRGB32;
+  return PIX_FMT_UNKNOWN;
+}
+
 static void fb_destroy(struct pix_frame_t *f) {
   if (!f)
     return;
   pix_fb_ctx_t *ctx = (pix_fb_ctx_t *)f->user;
-  if (f->pixels && ctx && ctx->map_length)
-    munmap(f->pixels, ctx->map_length);
-  if (ctx && ctx->fd >= 0)
-    close(ctx->fd);
+  if (ctx) {
+    if (ctx->mode == FB_MODE_FLIP && ctx->vinfo.yoffset != ctx->yoffset0)
+      fb_pan(ctx, ctx->yoffset0);
+    if (ctx->map && ctx->map_length)
+      munmap(ctx->map, ctx->map_length);
+    if (ctx->fd >= 0)
+      close(ctx->fd);
+    free(ctx->shadow);
+    free(ctx->front);
+  }
   free(ctx);
   free(f);
 }
 
-pix_frame_t *pixfb_frame_init(const char *path) {
+/* Set up page flipping when the virtual screen holds at least two pages and
+ * the driver pans. */
+static bool fb_setup_flip(pix_fb_ctx_t *ctx, pixfb_flags_t flags) {
+  unsigned pages = ctx->vinfo.yres ? ctx->vinfo.yres_virtual / ctx->vinfo.yres
+                                   : 0;
+  unsigned want = (flags & PIXFB_TRIPLE) ? 3u : 2u;
+  if (pages < 2)
+    return false;
+  if (!fb_pan(ctx, 0))
+    return false;
+  ctx->pages = pages < want ? pages : want;
+  ctx->back = 1;
+  return true;
+}
+
+static bool fb_setup_shadow(pix_fb_ctx_t *ctx, const pix_frame_t *f) {
+  ctx->row_bytes = (size_t)f->size.w * pix_format_bytes(f->format);
+  size_t len = ctx->row_bytes * f->size.h;
+  ctx->shadow = (uint8_t *)malloc(len);
+  ctx->front = (uint8_t *)malloc(len);
+  if (!ctx->shadow || !ctx->front)
+    return false;
+  // Start from what the device shows so the first present copies nothing
+  // that did not change.
+  for (uint16_t y = 0; y < f->size.h; ++y)
+    memcpy(ctx->front + (size_t)y * ctx->row_bytes,
+           (const uint8_t *)ctx->map + (size_t)y * ctx->line_length,
+           ctx->row_bytes);
+  memcpy(ctx->shadow, ctx->front, len);
+  return true;
+}
+
+pix_frame_t *pixfb_frame_init_ex(const char *path, pixfb_flags_t flags) {
   if (!path)
     return NULL;
   int fd = open(path, O_RDWR);
@@ -53,37 +282,8 @@ pix_frame_t *pixfb_frame_init(const char *path) {
     close(fd);
     return NULL;
   }
-  pix_format_t fmt = PIX_FMT_UNKNOWN;
-  if (vinfo.bits_per_pixel == 32 && vinfo.red.offset == 16 &&
-      vinfo.green.offset == 8 && vinfo.blue.offset == 0) {
-    fmt = PIX_FMT_RGBA32; /* assume ARGB/XRGB little-endian */
-  } else if (vinfo.bits_per_pixel == 24 && vinfo.red.offset == 16 &&
-             vinfo.green.offset == 8 && vinfo.blue.offset == 0) {
-    fmt = PIX_FMT_RGB24;
-  } else if (vinfo.bits_per_pixel == 16 && vinfo.red.length == 5 &&
-             vinfo.green.length == 6 && vinfo.blue.length == 5) {
-    fmt = PIX_FMT_RGB565;
-  } else if (vinfo.bits_per_pixel == 8) {
-    fmt = PIX_FMT_GRAY8; /* optimistic */
-  } else {
-    close(fd);
-    return NULL;
-  }
-  size_t bytespp = 0;
-  switch (fmt) {
-  case PIX_FMT_RGB24:
-    bytespp = 3;
-    break;
-  case PIX_FMT_RGBA32:
-    bytespp = 4;
-    break;
-  case PIX_FMT_GRAY8:
-    bytespp = 1;
-    break;
-  case PIX_FMT_RGB565:
-    bytespp = 2;
-    break;
-  default:
+  pix_format_t fmt = fb_format(&vinfo);
+  if (fmt == PIX_FMT_UNKNOWN) {
     close(fd);
     return NULL;
   }
@@ -107,7 +307,15 @@ pix_frame_t *pixfb_frame_init(const char *path) {
     return NULL;
   }
   ctx->fd = fd;
+  ctx->map = mem;
   ctx->map_length = map_len;
+  ctx->line_length = (size_t)finfo.line_length;
+  ctx->vinfo = vinfo;
+  ctx->yoffset0 = vinfo.yoffset;
+  ctx->mode = FB_MODE_DIRECT;
+  ctx->vsync = (flags & PIXFB_VSYNC) != 0;
+  ctx->vsync_ioctl = ctx->vsync;
+  ctx->period_ns = fb_period_ns(&vinfo);
   f->pixels = mem;
   f->size.w = (uint16_t)vinfo.xres;
   f->size.h = (uint16_t)vinfo.yres;
@@ -120,10 +328,45 @@ pix_frame_t *pixfb_frame_init(const char *path) {
   f->set_pixel = pix_frame_set_pixel;
   f->get_pixel = pix_frame_get_pixel;
   f->draw_line = pix_frame_draw_line;
+  f->fill_span = pix_frame_fill_span;
+  f->blend_span = pix_frame_blend_span;
   f->copy = pix_frame_copy;
+  if ((flags & PIXFB_FLIP) && fb_setup_flip(ctx, flags)) {
+    ctx->mode = FB_MODE_FLIP;
+    f->pixels = fb_page(ctx, ctx->back);
+  } else if (flags & PIXFB_SHADOW) {
+    if (!fb_setup_shadow(ctx, f)) {
+      fb_destroy(f);
+      return NULL;
+    }
+    ctx->mode = FB_MODE_SHADOW;
+    f->pixels = ctx->shadow;
+    f->stride = ctx->row_bytes;
+  }
   return f;
 }
 
+bool pixfb_frame_stats(const pix_frame_t *frame, pixfb_stats_t *stats) {
+  if (!frame || !stats || frame->destroy != fb_destroy || !frame->user)
+    return false;
+  const pix_fb_ctx_t *ctx = (const pix_fb_ctx_t *)frame->user;
+  *stats = (pixfb_stats_t){0};
+  stats->intervals = ctx->intervals;
+  stats->late = ctx->late;
+  stats->vsync = ctx->vsync && ctx->vsync_ioctl;
+  stats->period_ms = (double)ctx->period_ns / 1e6;
+  if (ctx->intervals) {
+    stats->mean_ms = (double)ctx->sum_ns / (double)ctx->intervals / 1e6;
+    stats->min_ms = (double)ctx->min_ns / 1e6;
+    stats->max_ms = (double)ctx->max_ns / 1e6;
+  }
+  return true;
+}
+
+pix_frame_t *pixfb_frame_init(const char *path) {
+  return pixfb_frame_init_ex(path, PIXFB_DIRECT);
+}
+
 #else /* !PIX_ENABLE_FB */
 /* Stub for non-Linux builds: symbol intentionally omitted so header not exposed
  */
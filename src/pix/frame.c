@@ -1,7 +1,9 @@
 #include "frame_internal.h"
 #include "pix.h"
+#include "simd_internal.h"
 #include <math.h>
 #include <string.h>
+#include <vg/vg.h> /* for VG_MALLOC/VG_FREE */
 
 void pix_frame_set_pixel(pix_frame_t *frame, pix_point_t pt,
                          pix_color_t color) {
@@ -22,6 +24,16 @@ void pix_frame_set_pixel(pix_frame_t *frame, pix_point_t pt,
   case PIX_FMT_RGB565:
     pix_frame_set_pixel_rgb565(frame, pt, color);
     break;
+  case PIX_FMT_RGBA32_PREMUL:
+    pix_frame_set_pixel_rgba32p(frame, pt, color);
+    break;
+  case PIX_FMT_BGRA32:
+  case PIX_FMT_XRGB32:
+    pix_frame_set_pixel_bgra32(frame, pt, color);
+    break;
+  case PIX_FMT_BGR24:
+    pix_frame_set_pixel_bgr24(frame, pt, color);
+    break;
   default:
     break;
   }
@@ -52,20 +64,50 @@ void pix_frame_draw_line(pix_frame_t *frame, pix_point_t a, pix_point_t b,
 }
 
 void pix_frame_clear(pix_frame_t *frame, pix_color_t value) {
+  if (!frame)
+    return;
+  pix_frame_clear_rect(frame, (pix_point_t){0, 0}, frame->size, value);
+}
+
+void pix_frame_clear_rect(pix_frame_t *frame, pix_point_t origin,
+                          pix_size_t size, pix_color_t value) {
   if (!frame || !frame->pixels)
     return;
+  int x0 = origin.x < 0 ? 0 : origin.x;
+  int y0 = origin.y < 0 ? 0 : origin.y;
+  int x1 = origin.x + (int)size.w, y1 = origin.y + (int)size.h;
+  if (x1 > (int)frame->size.w)
+    x1 = frame->size.w;
+  if (y1 > (int)frame->size.h)
+    y1 = frame->size.h;
+  if (x0 >= x1 || y0 >= y1)
+    return;
+  origin = (pix_point_t){(int16_t)x0, (int16_t)y0};
+  size = (pix_size_t){(uint16_t)(x1 - x0), (uint16_t)(y1 - y0)};
   switch (frame->format) {
   case PIX_FMT_RGB24:
-    pix_frame_clear_rgb24(frame, value);
+    pix_frame_clear_rgb24(frame, origin, size, value);
     break;
   case PIX_FMT_RGBA32:
-    pix_frame_clear_rgba32(frame, value);
+    pix_frame_clear_rgba32(frame, origin, size, value);
     break;
   case PIX_FMT_GRAY8:
-    pix_frame_clear_gray8(frame, value);
+    pix_frame_clear_gray8(frame, origin, size, value);
     break;
   case PIX_FMT_RGB565:
-    pix_frame_clear_rgb565(frame, value);
+    pix_frame_clear_rgb565(frame, origin, size, value);
+    break;
+  case PIX_FMT_RGBA32_PREMUL:
+    pix_frame_clear_rgba32p(frame, origin, size, value);
+    break;
+  case PIX_FMT_BGRA32:
+    pix_frame_clear_bgra32(frame, origin, size, value);
+    break;
+  case PIX_FMT_XRGB32:
+    pix_frame_clear_xrgb32(frame, origin, size, value);
+    break;
+  case PIX_FMT_BGR24:
+    pix_frame_clear_bgr24(frame, origin, size, value);
     break;
   default:
     // no-op
@@ -87,14 +129,119 @@ pix_color_t pix_frame_get_pixel(const pix_frame_t *frame, pix_point_t pt) {
     return pix_frame_get_pixel_gray8(frame, pt);
   case PIX_FMT_RGB565:
     return pix_frame_get_pixel_rgb565(frame, pt);
+  case PIX_FMT_RGBA32_PREMUL:
+    return pix_frame_get_pixel_rgba32p(frame, pt);
+  case PIX_FMT_BGRA32:
+    return pix_frame_get_pixel_bgra32(frame, pt);
+  case PIX_FMT_XRGB32:
+    return pix_frame_get_pixel_xrgb32(frame, pt);
+  case PIX_FMT_BGR24:
+    return pix_frame_get_pixel_bgr24(frame, pt);
   default:
     return 0;
   }
 }
 
-/* Internal helpers */
-static inline uint8_t _luma(uint8_t r, uint8_t g, uint8_t b) {
-  return (uint8_t)((r * 30 + g * 59 + b * 11) / 100);
+pix_fill_span_fn pix_frame_fill_span_fn(pix_format_t format) {
+  switch (format) {
+  case PIX_FMT_RGB24:
+    return pix_frame_fill_span_rgb24;
+  case PIX_FMT_RGBA32:
+    return pix_frame_fill_span_rgba32;
+  case PIX_FMT_GRAY8:
+    return pix_frame_fill_span_gray8;
+  case PIX_FMT_RGB565:
+    return pix_frame_fill_span_rgb565;
+  case PIX_FMT_RGBA32_PREMUL:
+    return pix_frame_fill_span_rgba32p;
+  case PIX_FMT_BGRA32:
+  case PIX_FMT_XRGB32:
+    return pix_frame_fill_span_bgra32;
+  case PIX_FMT_BGR24:
+    return pix_frame_fill_span_bgr24;
+  default:
+    return NULL;
+  }
+}
+
+pix_blend_span_fn pix_frame_blend_span_fn(pix_format_t format) {
+  switch (format) {
+  case PIX_FMT_RGB24:
+    return pix_frame_blend_span_rgb24;
+  case PIX_FMT_RGBA32:
+    return pix_frame_blend_span_rgba32;
+  case PIX_FMT_GRAY8:
+    return pix_frame_blend_span_gray8;
+  case PIX_FMT_RGB565:
+    return pix_frame_blend_span_rgb565;
+  case PIX_FMT_RGBA32_PREMUL:
+    return pix_frame_blend_span_rgba32p;
+  case PIX_FMT_BGRA32:
+  case PIX_FMT_XRGB32:
+    return pix_frame_blend_span_bgra32;
+  case PIX_FMT_BGR24:
+    return pix_frame_blend_span_bgr24;
+  default:
+    return NULL;
+  }
+}
+
+void pix_frame_fill_span(pix_frame_t *frame, int16_t y, int16_t x0, int16_t x1,
+                         pix_color_t color) {
+  if (!frame || !frame->pixels)
+    return;
+  if ((uint16_t)y >= frame->size.h)
+    return;
+  if (x0 < 0)
+    x0 = 0;
+  if (x1 > (int)frame->size.w)
+    x1 = (int16_t)frame->size.w;
+  if (x0 >= x1)
+    return;
+  pix_fill_span_fn fn = pix_frame_fill_span_fn(frame->format);
+  if (fn)
+    fn(frame, y, x0, x1, color);
+}
+
+void pix_frame_blend_span(pix_frame_t *frame, int16_t y, int16_t x0,
+                          const uint8_t *coverage, uint16_t len,
+                          pix_color_t color) {
+  if (!frame || !frame->pixels || !coverage)
+    return;
+  if ((uint16_t)y >= frame->size.h)
+    return;
+  int x = x0, n = len;
+  if (x < 0) {
+    coverage += -x;
+    n += x;
+    x = 0;
+  }
+  if (x + n > (int)frame->size.w)
+    n = (int)frame->size.w - x;
+  if (n <= 0)
+    return;
+  pix_blend_span_fn fn = pix_frame_blend_span_fn(frame->format);
+  if (fn)
+    fn(frame, y, (int16_t)x, coverage, (uint16_t)n, color);
+}
+
+size_t pix_format_bytes(pix_format_t format) {
+  switch (format) {
+  case PIX_FMT_RGB24:
+  case PIX_FMT_BGR24:
+    return 3;
+  case PIX_FMT_RGBA32:
+  case PIX_FMT_RGBA32_PREMUL:
+  case PIX_FMT_BGRA32:
+  case PIX_FMT_XRGB32:
+    return 4;
+  case PIX_FMT_GRAY8:
+    return 1;
+  case PIX_FMT_RGB565:
+    return 2;
+  default:
+    return 0;
+  }
 }
 
 bool pix_frame_copy(pix_frame_t *dst, pix_point_t dst_origin,
@@ -175,60 +322,95 @@ bool pix_frame_copy(pix_frame_t *dst, pix_point_t dst_origin,
   if (!src->pixels || !dst->pixels)
     return false;
 
-  /* Fast path: identical formats, no alpha blend requested or source has no
-   * alpha */
-  bool want_alpha = (flags & PIX_BLIT_ALPHA) != 0;
-  bool src_has_alpha = (src->format == PIX_FMT_RGBA32);
-  if (src->format == dst->format && (!want_alpha || !src_has_alpha)) {
-    size_t row_bytes;
-    switch (src->format) {
-    case PIX_FMT_RGB24:
-      row_bytes = (size_t)w * 3u;
-      break;
-    case PIX_FMT_RGBA32:
-      row_bytes = (size_t)w * 4u;
-      break;
-    case PIX_FMT_GRAY8:
-      row_bytes = (size_t)w;
-      break;
-    case PIX_FMT_RGB565:
-      row_bytes = (size_t)w * 2u;
-      break;
-    default:
-      row_bytes = 0;
-    }
-    if (row_bytes) {
-      for (int row = 0; row < h; ++row) {
-        const uint8_t *srow = (const uint8_t *)src->pixels +
-                              (size_t)(sy + row) * src->stride +
-                              (size_t)sx * row_bytes / (size_t)w;
-        uint8_t *drow = (uint8_t *)dst->pixels +
-                        (size_t)(dy + row) * dst->stride +
-                        (size_t)dx * row_bytes / (size_t)w;
-        memcpy(drow, srow, row_bytes);
-      }
-      return true;
-    }
-  }
-
-  /* Dispatch to source-format specific helper */
+  /* Alpha sources blend when asked; everything else is a row conversion
+   * (a plain copy when the formats match). */
   pix_point_t clipped_src = {(int16_t)sx, (int16_t)sy};
   pix_point_t clipped_dst = {(int16_t)dx, (int16_t)dy};
   pix_size_t clipped_size = {(uint16_t)w, (uint16_t)h};
-  switch (src->format) {
-  case PIX_FMT_RGB24:
-    return pix_frame_copy_from_rgb24(dst, clipped_dst, src, clipped_src,
-                                     clipped_size, flags);
-  case PIX_FMT_RGBA32:
-    return pix_frame_copy_from_rgba32(dst, clipped_dst, src, clipped_src,
-                                      clipped_size, flags);
-  case PIX_FMT_GRAY8:
-    return pix_frame_copy_from_gray8(dst, clipped_dst, src, clipped_src,
-                                     clipped_size, flags);
-  case PIX_FMT_RGB565:
-    return pix_frame_copy_from_rgb565(dst, clipped_dst, src, clipped_src,
-                                      clipped_size, flags);
-  default:
-    return false;
-  }
+  bool src_alpha = src->format == PIX_FMT_RGBA32 ||
+                   src->format == PIX_FMT_RGBA32_PREMUL ||
+                   src->format == PIX_FMT_BGRA32;
+  if ((flags & PIX_BLIT_ALPHA) && src_alpha)
+    return pix_frame_blend_from_rgba32(dst, clipped_dst, src, clipped_src,
+                                       clipped_size);
+  const uint8_t *srow = (const uint8_t *)src->pixels +
+                        (size_t)sy * src->stride +
+                        (size_t)sx * pix_format_bytes(src->format);
+  uint8_t *drow = (uint8_t *)dst->pixels + (size_t)dy * dst->stride +
+                  (size_t)dx * pix_format_bytes(dst->format);
+  for (int row = 0; row < h; ++row, srow += src->stride, drow += dst->stride)
+    if (!pix_convert_row(dst->format, drow, src->format, srow, (size_t)w))
+      return false;
+  return true;
+}
+
+/* Memory frames: the frame struct and, for pix_frame_init_mem, its pixels
+ * share one allocation, so destroy is a single free. */
+
+static bool mem_frame_lock(pix_frame_t *frame) {
+  return frame && frame->pixels != NULL;
+}
+
+static void mem_frame_unlock(pix_frame_t *frame) { (void)frame; }
+
+static void mem_frame_destroy(pix_frame_t *frame) { VG_FREE(frame); }
+
+static void mem_frame_setup(pix_frame_t *f, void *pixels, pix_size_t size,
+                            size_t stride, pix_format_t format) {
+  memset(f, 0, sizeof(*f));
+  f->pixels = pixels;
+  f->size = size;
+  f->stride = stride;
+  f->format = format;
+  f->destroy = mem_frame_destroy;
+  f->lock = mem_frame_lock;
+  f->unlock = mem_frame_unlock;
+  f->set_pixel = pix_frame_set_pixel;
+  f->get_pixel = pix_frame_get_pixel;
+  f->draw_line = pix_frame_draw_line;
+  f->fill_span = pix_frame_fill_span;
+  f->blend_span = pix_frame_blend_span;
+  f->copy = pix_frame_copy;
+}
+
+pix_frame_t *pix_frame_init_mem(pix_size_t size, pix_format_t format,
+                                size_t stride_align) {
+  size_t bpp = pix_format_bytes(format);
+  size_t align = stride_align ? stride_align : PIX_FRAME_ALIGN;
+  if (!bpp || !size.w || !size.h || (align & (align - 1)))
+    return NULL;
+  size_t stride = ((size_t)size.w * bpp + align - 1) & ~(align - 1);
+  size_t bytes = stride * size.h;
+  // Pixels start on an @p align boundary (at least PIX_FRAME_ALIGN) past
+  // the struct; the slack covers malloc's weaker alignment.
+  size_t base_align = align > PIX_FRAME_ALIGN ? align : PIX_FRAME_ALIGN;
+  size_t head = sizeof(pix_frame_t) + base_align - 1;
+  if (bytes / stride != size.h || bytes > SIZE_MAX - head)
+    return NULL;
+  uint8_t *block = (uint8_t *)VG_MALLOC(head + bytes);
+  if (!block)
+    return NULL;
+  uintptr_t p = (uintptr_t)(block + sizeof(pix_frame_t));
+  uint8_t *pixels =
+      (uint8_t *)((p + base_align - 1) & ~(uintptr_t)(base_align - 1));
+  memset(pixels, 0, bytes);
+  pix_frame_t *f = (pix_frame_t *)block;
+  mem_frame_setup(f, pixels, size, stride, format);
+  return f;
+}
+
+pix_frame_t *pix_frame_wrap(void *pixels, pix_size_t size, size_t stride,
+                            pix_format_t format) {
+  size_t bpp = pix_format_bytes(format);
+  if (!pixels || !bpp)
+    return NULL;
+  if (!stride)
+    stride = (size_t)size.w * bpp;
+  if (stride < (size_t)size.w * bpp)
+    return NULL;
+  pix_frame_t *f = (pix_frame_t *)VG_MALLOC(sizeof(pix_frame_t));
+  if (!f)
+    return NULL;
+  mem_frame_setup(f, pixels, size, stride, format);
+  return f;
 }
@@ -2,38 +2,100 @@
 #pragma once
 #include <pix/pix.h>
 
+/* Bytes per pixel of @p format, 0 if unsupported. */
+size_t pix_format_bytes(pix_format_t format);
+
 /* Generic dispatching helpers retained internally for VG renderer/backends */
 void pix_frame_set_pixel(pix_frame_t *frame, pix_point_t pt, pix_color_t color);
 pix_color_t pix_frame_get_pixel(const pix_frame_t *frame, pix_point_t pt);
 void pix_frame_draw_line(pix_frame_t *frame, pix_point_t a, pix_point_t b,
                          pix_color_t color);
 void pix_frame_clear(pix_frame_t *frame, pix_color_t value);
+/* Overwrite (no blending) a rectangle, clipped to the frame. */
+void pix_frame_clear_rect(pix_frame_t *frame, pix_point_t origin,
+                          pix_size_t size, pix_color_t value);
 bool pix_frame_copy(pix_frame_t *dst, pix_point_t dst_origin,
                     const pix_frame_t *src, pix_point_t src_origin,
                     pix_size_t size, pix_blit_flags_t flags);
+void pix_frame_fill_span(pix_frame_t *frame, int16_t y, int16_t x0, int16_t x1,
+                         pix_color_t color);
+void pix_frame_blend_span(pix_frame_t *frame, int16_t y, int16_t x0,
+                          const uint8_t *coverage, uint16_t len,
+                          pix_color_t color);
+
+/* Span writers resolved once per format. Unlike the dispatchers above they
+ * perform no NULL or bounds checks: callers clip runs to the frame first.
+ * Return NULL for unsupported formats. */
+typedef void (*pix_fill_span_fn)(pix_frame_t *frame, int16_t y, int16_t x0,
+                                 int16_t x1, pix_color_t color);
+typedef void (*pix_blend_span_fn)(pix_frame_t *frame, int16_t y, int16_t x0,
+                                  const uint8_t *coverage, uint16_t len,
+                                  pix_color_t color);
+pix_fill_span_fn pix_frame_fill_span_fn(pix_format_t format);
+pix_blend_span_fn pix_frame_blend_span_fn(pix_format_t format);
 
 /* Per-format helpers (previously public) */
 void pix_frame_set_pixel_rgb24(pix_frame_t *, pix_point_t, pix_color_t);
 void pix_frame_set_pixel_rgba32(pix_frame_t *, pix_point_t, pix_color_t);
 void pix_frame_set_pixel_gray8(pix_frame_t *, pix_point_t, pix_color_t);
 void pix_frame_set_pixel_rgb565(pix_frame_t *, pix_point_t, pix_color_t);
-void pix_frame_clear_rgb24(pix_frame_t *, pix_color_t);
-void pix_frame_clear_rgba32(pix_frame_t *, pix_color_t);
-void pix_frame_clear_gray8(pix_frame_t *, pix_color_t);
-void pix_frame_clear_rgb565(pix_frame_t *, pix_color_t);
+void pix_frame_set_pixel_rgba32p(pix_frame_t *, pix_point_t, pix_color_t);
+void pix_frame_set_pixel_bgra32(pix_frame_t *, pix_point_t, pix_color_t);
+void pix_frame_set_pixel_bgr24(pix_frame_t *, pix_point_t, pix_color_t);
+void pix_frame_clear_rgb24(pix_frame_t *, pix_point_t, pix_size_t,
+                           pix_color_t);
+void pix_frame_clear_rgba32(pix_frame_t *, pix_point_t, pix_size_t,
+                            pix_color_t);
+void pix_frame_clear_gray8(pix_frame_t *, pix_point_t, pix_size_t,
+                           pix_color_t);
+void pix_frame_clear_rgb565(pix_frame_t *, pix_point_t, pix_size_t,
+                            pix_color_t);
+void pix_frame_clear_rgba32p(pix_frame_t *, pix_point_t, pix_size_t,
+                             pix_color_t);
+void pix_frame_clear_bgra32(pix_frame_t *, pix_point_t, pix_size_t,
+                            pix_color_t);
+void pix_frame_clear_xrgb32(pix_frame_t *, pix_point_t, pix_size_t,
+                            pix_color_t);
+void pix_frame_clear_bgr24(pix_frame_t *, pix_point_t, pix_size_t,
+                           pix_color_t);
 pix_color_t pix_frame_get_pixel_rgb24(const pix_frame_t *, pix_point_t);
 pix_color_t pix_frame_get_pixel_rgba32(const pix_frame_t *, pix_point_t);
 pix_color_t pix_frame_get_pixel_gray8(const pix_frame_t *, pix_point_t);
 pix_color_t pix_frame_get_pixel_rgb565(const pix_frame_t *, pix_point_t);
-bool pix_frame_copy_from_rgb24(pix_frame_t *dst, pix_point_t dst_origin,
-                               const pix_frame_t *src, pix_point_t src_origin,
-                               pix_size_t size, pix_blit_flags_t flags);
-bool pix_frame_copy_from_rgba32(pix_frame_t *dst, pix_point_t dst_origin,
-                                const pix_frame_t *src, pix_point_t src_origin,
-                                pix_size_t size, pix_blit_flags_t flags);
-bool pix_frame_copy_from_gray8(pix_frame_t *dst, pix_point_t dst_origin,
-                               const pix_frame_t *src, pix_point_t src_origin,
-                               pix_size_t size, pix_blit_flags_t flags);
-bool pix_frame_copy_from_rgb565(pix_frame_t *dst, pix_point_t dst_origin,
-                                const pix_frame_t *src, pix_point_t src_origin,
-                                pix_size_t size, pix_blit_flags_t flags);
\ No newline at end of file
+pix_color_t pix_frame_get_pixel_rgba32p(const pix_frame_t *, pix_point_t);
+pix_color_t pix_frame_get_pixel_bgra32(const pix_frame_t *, pix_point_t);
+pix_color_t pix_frame_get_pixel_xrgb32(const pix_frame_t *, pix_point_t);
+pix_color_t pix_frame_get_pixel_bgr24(const pix_frame_t *, pix_point_t);
+void pix_frame_fill_span_rgb24(pix_frame_t *, int16_t, int16_t, int16_t,
+                               pix_color_t);
+void pix_frame_fill_span_rgba32(pix_frame_t *, int16_t, int16_t, int16_t,
+                                pix_color_t);
+void pix_frame_fill_span_gray8(pix_frame_t *, int16_t, int16_t, int16_t,
+                               pix_color_t);
+void pix_frame_fill_span_rgb565(pix_frame_t *, int16_t, int16_t, int16_t,
+                                pix_color_t);
+void pix_frame_fill_span_rgba32p(pix_frame_t *, int16_t, int16_t, int16_t,
+                                 pix_color_t);
+void pix_frame_fill_span_bgra32(pix_frame_t *, int16_t, int16_t, int16_t,
+                                pix_color_t);
+void pix_frame_fill_span_bgr24(pix_frame_t *, int16_t, int16_t, int16_t,
+                               pix_color_t);
+void pix_frame_blend_span_rgb24(pix_frame_t *, int16_t, int16_t,
+                                const uint8_t *, uint16_t, pix_color_t);
+void pix_frame_blend_span_rgba32(pix_frame_t *, int16_t, int16_t,
+                                 const uint8_t *, uint16_t, pix_color_t);
+void pix_frame_blend_span_gray8(pix_frame_t *, int16_t, int16_t,
+                                const uint8_t *, uint16_t, pix_color_t);
+void pix_frame_blend_span_rgb565(pix_frame_t *, int16_t, int16_t,
+                                 const uint8_t *, uint16_t, pix_color_t);
+void pix_frame_blend_span_rgba32p(pix_frame_t *, int16_t, int16_t,
+                                  const uint8_t *, uint16_t, pix_color_t);
+void pix_frame_blend_span_bgra32(pix_frame_t *, int16_t, int16_t,
+                                 const uint8_t *, uint16_t, pix_color_t);
+void pix_frame_blend_span_bgr24(pix_frame_t *, int16_t, int16_t,
+                                const uint8_t *, uint16_t, pix_color_t);
+/* Src-over an RGBA32 or RGBA32_PREMUL rectangle, already clipped to both
+ * frames. XRGB32 targets take the blend and keep their padding at 0xFF. */
+bool pix_frame_blend_from_rgba32(pix_frame_t *dst, pix_point_t dst_origin,
+                                 const pix_frame_t *src,
+                                 pix_point_t src_origin, pix_size_t size);
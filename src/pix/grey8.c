@@ -1,11 +1,11 @@
+#include "color_internal.h"
 #include <pix/pix.h>
 #include <stdint.h>
 #include <string.h>
 
 static inline uint8_t pix_rgb_to_gray(pix_color_t color) {
-  return (uint8_t)((((color >> 16) & 0xFF) * 30 + ((color >> 8) & 0xFF) * 59 +
-                    (color & 0xFF) * 11) /
-                   100);
+  return pix_luma((uint8_t)(color >> 16), (uint8_t)(color >> 8),
+                  (uint8_t)color);
 }
 
 void pix_frame_set_pixel_gray8(pix_frame_t *frame, pix_point_t pt,
@@ -15,13 +15,49 @@ void pix_frame_set_pixel_gray8(pix_frame_t *frame, pix_point_t pt,
   row[x] = pix_rgb_to_gray(color);
 }
 
-void pix_frame_clear_gray8(pix_frame_t *frame, pix_color_t value) {
+void pix_frame_clear_gray8(pix_frame_t *frame, pix_point_t origin,
+                           pix_size_t size, pix_color_t value) {
   uint8_t g = pix_rgb_to_gray(value);
-  for (size_t y = 0; y < frame->size.h; ++y) {
-    uint8_t *row = (uint8_t *)frame->pixels + y * frame->stride;
-    for (size_t x = 0; x < frame->size.w; ++x) {
-      row[x] = g;
-    }
+  uint8_t *row =
+      (uint8_t *)frame->pixels + origin.y * frame->stride + origin.x;
+  if (frame->stride == size.w) { // whole rows, no padding
+    memset(row, g, (size_t)size.w * size.h);
+    return;
+  }
+  for (size_t y = 0; y < size.h; ++y, row += frame->stride)
+    memset(row, g, size.w);
+}
+
+void pix_frame_fill_span_gray8(pix_frame_t *frame, int16_t y, int16_t x0,
+                               int16_t x1, pix_color_t color) {
+  uint32_t a = (color >> 24) & 0xFFu;
+  if (a == 0)
+    return;
+  uint8_t g = pix_rgb_to_gray(color);
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride + x0;
+  size_t n = (size_t)(x1 - x0);
+  if (a == 255u) {
+    memset(p, g, n);
+    return;
+  }
+  uint32_t ga = g * a, ia = 255u - a;
+  for (size_t i = 0; i < n; ++i)
+    p[i] = (uint8_t)((ga + p[i] * ia + 127u) / 255u);
+}
+
+void pix_frame_blend_span_gray8(pix_frame_t *frame, int16_t y, int16_t x0,
+                                const uint8_t *coverage, uint16_t len,
+                                pix_color_t color) {
+  uint32_t sa = (color >> 24) & 0xFFu;
+  if (sa == 0)
+    return;
+  uint8_t g = pix_rgb_to_gray(color);
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride + x0;
+  for (uint16_t i = 0; i < len; ++i) {
+    uint32_t a = pix_mul255(sa, coverage[i]);
+    if (a == 0)
+      continue;
+    p[i] = (uint8_t)((g * a + p[i] * (255u - a) + 127u) / 255u);
   }
 }
 
@@ -32,51 +68,3 @@ pix_color_t pix_frame_get_pixel_gray8(const pix_frame_t *frame,
   uint8_t g = row[pt.x];
   return 0xFF000000u | ((uint32_t)g << 16) | ((uint32_t)g << 8) | (uint32_t)g;
 }
-
-bool pix_frame_copy_from_gray8(pix_frame_t *dst, pix_point_t dst_origin,
-                               const pix_frame_t *src, pix_point_t src_origin,
-                               pix_size_t size, pix_blit_flags_t flags) {
-  (void)flags; /* no alpha in source */
-  for (uint16_t row = 0; row < size.h; ++row) {
-    const uint8_t *srow = (const uint8_t *)src->pixels +
-                          (size_t)(src_origin.y + row) * src->stride +
-                          (size_t)src_origin.x;
-    uint8_t *drow =
-        (uint8_t *)dst->pixels + (size_t)(dst_origin.y + row) * dst->stride;
-    switch (dst->format) {
-    case PIX_FMT_GRAY8: {
-      uint8_t *dp = drow + (size_t)dst_origin.x;
-      memcpy(dp, srow, (size_t)size.w);
-      break;
-    }
-    case PIX_FMT_RGB24: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        uint8_t g = srow[col];
-        uint8_t *dp = drow + ((size_t)dst_origin.x + col) * 3u;
-        dp[0] = dp[1] = dp[2] = g;
-      }
-      break;
-    }
-    case PIX_FMT_RGBA32: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        uint8_t g = srow[col];
-        uint8_t *dp = drow + ((size_t)dst_origin.x + col) * 4u;
-        dp[0] = dp[1] = dp[2] = g;
-        dp[3] = 255;
-      }
-      break;
-    }
-    case PIX_FMT_RGB565: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        uint8_t g = srow[col];
-        uint16_t *dp = (uint16_t *)(drow + ((size_t)dst_origin.x + col) * 2u);
-        *dp = (uint16_t)(((g & 0xF8) << 8) | ((g & 0xFC) << 3) | (g >> 3));
-      }
-      break;
-    }
-    default:
-      break;
-    }
-  }
-  return true;
-}
@@ -1,4 +1,5 @@
 #include "frame_internal.h"
+#include "simd_internal.h"
 #include <pix/image.h>
 #include <pix/pix.h>
 #include <stdio.h>
@@ -8,6 +9,30 @@
 
 #include "tjpgd.h"
 
+/* Work pool for one decode, sized for the configuration in tjpgdcnf.h (set
+ * per target by the build). jd_prepare allocates from it for every table
+ * segment, so a baseline JPEG needs the stream buffer, four quantization
+ * tables, two DC and two AC Huffman tables (at most 12 and 162 symbols,
+ * plus lookup tables at JD_FASTDECODE 2) and the MCU buffers for 2x2 chroma
+ * subsampling, each block rounded up to 4 bytes as tjpgd does. DQT and DHT
+ * segments may legally redefine tables, which allocates again: the pool
+ * has room for one more full set, and memory sources that still run out
+ * are retried once with JPEG_POOL_RETRY. */
+#define JPEG_HUFF_BYTES(n) (16 + (((n) * 2 + 3) & ~3) + (((n) + 3) & ~3))
+#if JD_FASTDECODE == 2
+#define JPEG_HUFF_LUT_BYTES (2 * 1024 * (2 + 1)) /* AC uint16, DC uint8 */
+#else
+#define JPEG_HUFF_LUT_BYTES 0
+#endif
+#define JPEG_TABLE_BYTES                                                      \
+  (4 * 64 * 4 + 2 * (JPEG_HUFF_BYTES(12) + JPEG_HUFF_BYTES(162)) +            \
+   JPEG_HUFF_LUT_BYTES)
+#define JPEG_POOL_SIZE                                                        \
+  (((JD_SZBUF + 3) & ~3) + 2 * JPEG_TABLE_BYTES + (4 * 64 * 2 + 64) +         \
+   (4 + 2) * 64 * (JD_FASTDECODE ? 2 : 1))
+/* Retry size, and the pool of callback streams, which cannot be rewound. */
+#define JPEG_POOL_RETRY (64 * 1024)
+
 /* Streaming source (either user callback or in-memory) */
 typedef struct {
   pix_jpeg_read_cb read_cb; /* user callback (NULL for memory mode) */
@@ -17,66 +42,6 @@ typedef struct {
   size_t mem_pos;           /* current position */
 } jpeg_stream_t;
 
-// Forward declarations of stub lock/unlock
-static bool jpeg_frame_lock(pix_frame_t *f) {
-  (void)f;
-  return true;
-}
-
-static void jpeg_frame_unlock(pix_frame_t *f) { (void)f; }
-
-// Tiny helper frame creation for RGB24 software frame (no backend, always
-// locked).
-static void simple_frame_destroy(pix_frame_t *frame) {
-  if (!frame)
-    return;
-  if (frame->pixels) {
-    VG_FREE(frame->pixels);
-  }
-  VG_FREE(frame);
-}
-
-static pix_frame_t *alloc_frame(uint16_t w, uint16_t h, pix_format_t fmt) {
-  size_t bpp;
-  switch (fmt) {
-  case PIX_FMT_RGB24:
-    bpp = 3;
-    break;
-  case PIX_FMT_GRAY8:
-    bpp = 1;
-    break;
-  case PIX_FMT_RGB565:
-    bpp = 2;
-    break;
-  default:
-    return NULL;
-  }
-  size_t stride = (size_t)w * bpp;
-  size_t bytes = stride * h;
-  uint8_t *pixels = (uint8_t *)VG_MALLOC(bytes);
-  if (!pixels)
-    return NULL;
-  pix_frame_t *f = (pix_frame_t *)VG_MALLOC(sizeof(pix_frame_t));
-  if (!f) {
-    VG_FREE(pixels);
-    return NULL;
-  }
-  memset(f, 0, sizeof(*f));
-  f->pixels = pixels;
-  f->size = (pix_size_t){w, h};
-  f->stride = stride;
-  f->format = fmt;
-  f->set_pixel = pix_frame_set_pixel; // generic dispatch uses format
-  f->get_pixel = pix_frame_get_pixel; // new function pointer
-  f->copy = pix_frame_copy;           // copy/blit entry
-  f->draw_line = pix_frame_draw_line;
-  // lock/unlock no-op (already CPU accessible)
-  f->lock = jpeg_frame_lock;
-  f->unlock = jpeg_frame_unlock;
-  f->destroy = simple_frame_destroy;
-  return f;
-}
-
 /* Caller destroys returned frame with frame->destroy(frame) (frees struct). */
 
 typedef struct {
@@ -130,85 +95,85 @@ static int jpeg_outfunc(JDEC *jd, void *bitmap, JRECT *rect) {
   uint8_t *src = (uint8_t *)bitmap; /* RGB888 block */
 
   pix_frame_t *f = ctx->frame;
-  size_t dst_stride = f->stride;
-  switch (ctx->format) {
-  case PIX_FMT_RGB24: {
-    for (uint16_t row = 0; row < h; ++row) {
-      uint8_t *dst = (uint8_t *)f->pixels +
-                     ((size_t)(rect->top + row) * dst_stride) +
-                     ((size_t)rect->left * 3u);
-      memcpy(dst, src + (size_t)row * w * 3u, (size_t)w * 3u);
-    }
-    break;
-  }
-  case PIX_FMT_GRAY8: {
-    for (uint16_t row = 0; row < h; ++row) {
-      uint8_t *dst = (uint8_t *)f->pixels +
-                     ((size_t)(rect->top + row) * dst_stride) +
-                     (size_t)rect->left;
-      uint8_t *src_row = src + (size_t)row * w * 3u;
-      for (uint16_t x = 0; x < w; ++x) {
-        uint8_t r = src_row[x * 3 + 0], g = src_row[x * 3 + 1],
-                b = src_row[x * 3 + 2];
-        dst[x] = (uint8_t)((r * 30 + g * 59 + b * 11) / 100);
-      }
-    }
-    break;
-  }
-  case PIX_FMT_RGB565: {
-    for (uint16_t row = 0; row < h; ++row) {
-      uint16_t *dst = (uint16_t *)((uint8_t *)f->pixels +
-                                   ((size_t)(rect->top + row) * dst_stride)) +
-                      rect->left;
-      uint8_t *src_row = src + (size_t)row * w * 3u;
-      for (uint16_t x = 0; x < w; ++x) {
-        uint8_t r = src_row[x * 3 + 0];
-        uint8_t g = src_row[x * 3 + 1];
-        uint8_t b = src_row[x * 3 + 2];
-        dst[x] = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
-      }
-    }
-    break;
-  }
-  default:
+  pix_convert_fn convert = pix_convert_row_fn(f->format, PIX_FMT_RGB24);
+  if (!convert)
     return 0;
-  }
+  uint8_t *dst = (uint8_t *)f->pixels + (size_t)rect->top * f->stride +
+                 (size_t)rect->left * pix_format_bytes(f->format);
+  for (uint16_t row = 0; row < h; ++row, dst += f->stride, src += w * 3u)
+    convert(dst, src, w);
   return 1; /* continue */
 }
 
 /* No longer needed: conversion now happens per block in jpeg_outfunc. */
 
+/* Largest tjpgd descale n (output 1/2^n, n <= 3) whose output still holds
+ * the @p w x @p h image fitted into @p max_w x @p max_h (0 leaves that side
+ * unconstrained). The output of descale n is (w >> n) x (h >> n). */
+static uint8_t jpeg_scale_for(uint16_t w, uint16_t h, uint16_t max_w,
+                              uint16_t max_h) {
+  if ((!max_w && !max_h) || !w || !h)
+    return 0;
+  uint32_t tw, th;
+  if (!max_h || (max_w && (uint32_t)max_w * h <= (uint32_t)max_h * w)) {
+    tw = max_w;
+    th = (uint32_t)h * max_w / w;
+  } else {
+    th = max_h;
+    tw = (uint32_t)w * max_h / h;
+  }
+  uint8_t scale = JD_USE_SCALE ? 3 : 0;
+  while (scale && ((uint32_t)(w >> scale) < tw || (uint32_t)(h >> scale) < th ||
+                   !(w >> scale) || !(h >> scale)))
+    --scale;
+  return scale;
+}
+
 static pix_frame_t *pix_frame_init_jpeg_common(jpeg_stream_t *stream,
-                                               pix_format_t format) {
+                                               pix_format_t format,
+                                               uint16_t max_w,
+                                               uint16_t max_h) {
   if (!stream)
     return NULL;
-  if (!(format == PIX_FMT_RGB24 || format == PIX_FMT_GRAY8 ||
-        format == PIX_FMT_RGB565))
+  if (!pix_convert_row_fn(format, PIX_FMT_RGB24))
     return NULL;
   jpeg_ctx_t ctx;
   memset(&ctx, 0, sizeof(ctx));
   ctx.stream = *stream;
   ctx.format = format;
-  size_t pool_size = 32 * 1024; /* work buffer */
+  size_t pool_size = stream->read_cb ? JPEG_POOL_RETRY : JPEG_POOL_SIZE;
   void *pool = VG_MALLOC(pool_size);
   if (!pool)
     return NULL;
   JDEC jd;
   JRESULT jr = jd_prepare(&jd, jpeg_infunc, pool, pool_size, &ctx);
+  if (jr == JDR_MEM1 && pool_size < JPEG_POOL_RETRY) {
+    /* More tables than the pool allows for: start over with a larger one */
+    VG_FREE(pool);
+    pool_size = JPEG_POOL_RETRY;
+    pool = VG_MALLOC(pool_size);
+    if (!pool)
+      return NULL;
+    ctx.stream.mem_pos = 0;
+    jr = jd_prepare(&jd, jpeg_infunc, pool, pool_size, &ctx);
+  }
   if (jr != JDR_OK) {
     fprintf(stderr, "jd_prepare failed (%d)\n", jr);
     VG_FREE(pool);
     return NULL;
   }
-  ctx.width = jd.width;
-  ctx.height = jd.height;
-  ctx.frame = alloc_frame(jd.width, jd.height, format);
+  uint8_t scale = jpeg_scale_for(jd.width, jd.height, max_w, max_h);
+  ctx.width = (uint16_t)(jd.width >> scale);
+  ctx.height = (uint16_t)(jd.height >> scale);
+  ctx.frame =
+      pix_frame_init_mem((pix_size_t){ctx.width, ctx.height}, format, 0);
   if (!ctx.frame) {
-    fprintf(stderr, "alloc_frame failed (%ux%u)\n", jd.width, jd.height);
+    fprintf(stderr, "pix_frame_init_mem failed (%ux%u)\n", ctx.width,
+            ctx.height);
     VG_FREE(pool);
     return NULL;
   }
-  jr = jd_decomp(&jd, jpeg_outfunc, 0); /* scale=0 full size */
+  jr = jd_decomp(&jd, jpeg_outfunc, scale);
   if (jr != JDR_OK) {
     fprintf(stderr, "jd_decomp failed (%d)\n", jr);
     ctx.frame->destroy(ctx.frame);
@@ -227,7 +192,19 @@ pix_frame_t *pix_frame_init_jpeg(const void *data, size_t size,
   memset(&s, 0, sizeof(s));
   s.mem = (const uint8_t *)data;
   s.mem_size = size;
-  return pix_frame_init_jpeg_common(&s, format);
+  return pix_frame_init_jpeg_common(&s, format, 0, 0);
+}
+
+pix_frame_t *pix_frame_init_jpeg_ex(const void *data, size_t size,
+                                    pix_format_t format, uint16_t max_w,
+                                    uint16_t max_h) {
+  if (!data || size == 0)
+    return NULL;
+  jpeg_stream_t s;
+  memset(&s, 0, sizeof(s));
+  s.mem = (const uint8_t *)data;
+  s.mem_size = size;
+  return pix_frame_init_jpeg_common(&s, format, max_w, max_h);
 }
 
 pix_frame_t *pix_frame_init_jpeg_stream(pix_jpeg_read_cb read_cb, void *user,
@@ -238,7 +215,7 @@ pix_frame_t *pix_frame_init_jpeg_stream(pix_jpeg_read_cb read_cb, void *user,
   memset(&s, 0, sizeof(s));
   s.read_cb = read_cb;
   s.user = user;
-  return pix_frame_init_jpeg_common(&s, format);
+  return pix_frame_init_jpeg_common(&s, format, 0, 0);
 }
 
 /* Convenience inline (header not provided) could be added later for default
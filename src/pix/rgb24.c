@@ -1,29 +1,141 @@
 #include "color_internal.h"
+#include "simd_internal.h"
 #include <pix/pix.h>
 #include <stdint.h>
 #include <string.h>
 
+/* RGB24 stores R,G,B bytes and BGR24 B,G,R; the shared code takes the red
+ * and blue byte offsets @p ri and @p bi as constants. */
+static inline void set_pixel_24(pix_frame_t *frame, pix_point_t pt,
+                                pix_color_t color, int ri, int bi) {
+  uint16_t x = (uint16_t)pt.x, y = (uint16_t)pt.y;
+  uint8_t *p = (uint8_t *)frame->pixels + y * frame->stride + x * 3u;
+  p[ri] = (color >> 16) & 0xFF; // R
+  p[1] = (color >> 8) & 0xFF;   // G
+  p[bi] = color & 0xFF;         // B
+}
+
 void pix_frame_set_pixel_rgb24(pix_frame_t *frame, pix_point_t pt,
                                pix_color_t color) {
-  uint16_t x = (uint16_t)pt.x, y = (uint16_t)pt.y;
-  uint8_t *row = (uint8_t *)frame->pixels + y * frame->stride;
-  row[x * 3 + 0] = (color >> 16) & 0xFF; // R
-  row[x * 3 + 1] = (color >> 8) & 0xFF;  // G
-  row[x * 3 + 2] = color & 0xFF;         // B
+  set_pixel_24(frame, pt, color, 0, 2);
+}
+
+void pix_frame_set_pixel_bgr24(pix_frame_t *frame, pix_point_t pt,
+                               pix_color_t color) {
+  set_pixel_24(frame, pt, color, 2, 0);
+}
+
+static inline void clear_24(pix_frame_t *frame, pix_point_t origin,
+                            pix_size_t size, pix_color_t value, int ri,
+                            int bi) {
+  uint8_t px[3];
+  px[ri] = (value >> 16) & 0xFF;
+  px[1] = (value >> 8) & 0xFF;
+  px[bi] = value & 0xFF;
+  uint8_t *row = (uint8_t *)frame->pixels + origin.y * frame->stride +
+                 (size_t)origin.x * 3u;
+  size_t row_bytes = (size_t)size.w * 3u;
+  if (frame->stride == row_bytes) { // whole rows, no padding
+    pix_fill24(row, px[0], px[1], px[2], (size_t)size.w * size.h);
+    return;
+  }
+  /* Lay the 3-byte pattern down once, then copy the finished row. */
+  pix_fill24(row, px[0], px[1], px[2], size.w);
+  for (size_t y = 1; y < size.h; ++y)
+    memcpy(row + y * frame->stride, row, row_bytes);
+}
+
+void pix_frame_clear_rgb24(pix_frame_t *frame, pix_point_t origin,
+                           pix_size_t size, pix_color_t value) {
+  clear_24(frame, origin, size, value, 0, 2);
+}
+
+void pix_frame_clear_bgr24(pix_frame_t *frame, pix_point_t origin,
+                           pix_size_t size, pix_color_t value) {
+  clear_24(frame, origin, size, value, 2, 0);
 }
 
-void pix_frame_clear_rgb24(pix_frame_t *frame, pix_color_t value) {
-  uint8_t r = (value >> 16) & 0xFF;
-  uint8_t g = (value >> 8) & 0xFF;
-  uint8_t b = value & 0xFF;
-  for (size_t y = 0; y < frame->size.h; ++y) {
-    uint8_t *row = (uint8_t *)frame->pixels + y * frame->stride;
-    for (size_t x = 0; x < frame->size.w; ++x) {
-      row[x * 3 + 0] = r;
-      row[x * 3 + 1] = g;
-      row[x * 3 + 2] = b;
+static inline void blend_24(uint8_t *p, uint8_t sr, uint8_t sg, uint8_t sb,
+                            uint32_t a, int ri, int bi) {
+  uint32_t ia = 255u - a;
+  p[ri] = (uint8_t)((sr * a + p[ri] * ia + 127u) / 255u);
+  p[1] = (uint8_t)((sg * a + p[1] * ia + 127u) / 255u);
+  p[bi] = (uint8_t)((sb * a + p[bi] * ia + 127u) / 255u);
+}
+
+static inline void fill_span_24(pix_frame_t *frame, int16_t y, int16_t x0,
+                                int16_t x1, pix_color_t color, int ri,
+                                int bi) {
+  uint8_t a = (uint8_t)((color >> 24) & 0xFFu);
+  if (a == 0)
+    return;
+  uint8_t r = (color >> 16) & 0xFF;
+  uint8_t g = (color >> 8) & 0xFF;
+  uint8_t b = color & 0xFF;
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride +
+               (size_t)x0 * 3u;
+  size_t n = (size_t)(x1 - x0);
+  if (a == 255u) {
+    if (r == g && g == b) {
+      memset(p, r, n * 3u);
+      return;
     }
+    uint8_t px[3];
+    px[ri] = r;
+    px[1] = g;
+    px[bi] = b;
+    pix_fill24(p, px[0], px[1], px[2], n);
+    return;
   }
+  for (size_t i = 0; i < n; ++i, p += 3)
+    blend_24(p, r, g, b, a, ri, bi);
+}
+
+void pix_frame_fill_span_rgb24(pix_frame_t *frame, int16_t y, int16_t x0,
+                               int16_t x1, pix_color_t color) {
+  fill_span_24(frame, y, x0, x1, color, 0, 2);
+}
+
+void pix_frame_fill_span_bgr24(pix_frame_t *frame, int16_t y, int16_t x0,
+                               int16_t x1, pix_color_t color) {
+  fill_span_24(frame, y, x0, x1, color, 2, 0);
+}
+
+static inline void blend_span_24(pix_frame_t *frame, int16_t y, int16_t x0,
+                                 const uint8_t *coverage, uint16_t len,
+                                 pix_color_t color, int ri, int bi) {
+  uint8_t sa = (uint8_t)((color >> 24) & 0xFFu);
+  if (sa == 0)
+    return;
+  uint8_t r = (color >> 16) & 0xFF;
+  uint8_t g = (color >> 8) & 0xFF;
+  uint8_t b = color & 0xFF;
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride +
+               (size_t)x0 * 3u;
+  for (uint16_t i = 0; i < len; ++i, p += 3) {
+    uint32_t a = pix_mul255(sa, coverage[i]);
+    if (a == 0)
+      continue;
+    if (a == 255u) {
+      p[ri] = r;
+      p[1] = g;
+      p[bi] = b;
+      continue;
+    }
+    blend_24(p, r, g, b, a, ri, bi);
+  }
+}
+
+void pix_frame_blend_span_rgb24(pix_frame_t *frame, int16_t y, int16_t x0,
+                                const uint8_t *coverage, uint16_t len,
+                                pix_color_t color) {
+  blend_span_24(frame, y, x0, coverage, len, color, 0, 2);
+}
+
+void pix_frame_blend_span_bgr24(pix_frame_t *frame, int16_t y, int16_t x0,
+                                const uint8_t *coverage, uint16_t len,
+                                pix_color_t color) {
+  blend_span_24(frame, y, x0, coverage, len, color, 2, 0);
 }
 
 pix_color_t pix_frame_get_pixel_rgb24(const pix_frame_t *frame,
@@ -35,53 +147,10 @@ pix_color_t pix_frame_get_pixel_rgb24(const pix_frame_t *frame,
          (uint32_t)p[2];
 }
 
-bool pix_frame_copy_from_rgb24(pix_frame_t *dst, pix_point_t dst_origin,
-                               const pix_frame_t *src, pix_point_t src_origin,
-                               pix_size_t size, pix_blit_flags_t flags) {
-  (void)flags; /* no alpha in source */
-  for (uint16_t row = 0; row < size.h; ++row) {
-    const uint8_t *srow = (const uint8_t *)src->pixels +
-                          (size_t)(src_origin.y + row) * src->stride +
-                          (size_t)src_origin.x * 3u;
-    uint8_t *drow =
-        (uint8_t *)dst->pixels + (size_t)(dst_origin.y + row) * dst->stride;
-    switch (dst->format) {
-    case PIX_FMT_RGB24: {
-      uint8_t *dp = drow + (size_t)dst_origin.x * 3u;
-      memcpy(dp, srow, (size_t)size.w * 3u);
-      break;
-    }
-    case PIX_FMT_RGBA32: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        const uint8_t *sp = srow + col * 3u;
-        uint8_t *dp = drow + ((size_t)dst_origin.x + col) * 4u;
-        dp[0] = sp[0];
-        dp[1] = sp[1];
-        dp[2] = sp[2];
-        dp[3] = 255;
-      }
-      break;
-    }
-    case PIX_FMT_GRAY8: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        const uint8_t *sp = srow + col * 3u;
-        uint8_t *dp = drow + (size_t)dst_origin.x + col;
-        *dp = pix_luma(sp[0], sp[1], sp[2]);
-      }
-      break;
-    }
-    case PIX_FMT_RGB565: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        const uint8_t *sp = srow + col * 3u;
-        uint16_t *dp = (uint16_t *)(drow + ((size_t)dst_origin.x + col) * 2u);
-        uint8_t r = sp[0], g = sp[1], b = sp[2];
-        *dp = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
-      }
-      break;
-    }
-    default:
-      break;
-    }
-  }
-  return true;
+pix_color_t pix_frame_get_pixel_bgr24(const pix_frame_t *frame,
+                                      pix_point_t pt) {
+  const uint8_t *p = (const uint8_t *)frame->pixels +
+                     (size_t)pt.y * frame->stride + (size_t)pt.x * 3u;
+  return 0xFF000000u | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) |
+         (uint32_t)p[0];
 }
@@ -1,15 +1,15 @@
 #include "color_internal.h"
+#include "frame_internal.h"
+#include "simd_internal.h"
 #include <pix/pix.h>
 #include <stdint.h>
 #include <string.h>
 
-void pix_frame_set_pixel_rgba32(pix_frame_t *frame, pix_point_t pt,
-                                pix_color_t color) {
-  /* Internal canonical in‑memory order is R,G,B,A so that index 3 holds the
-   * most significant (alpha) byte. get_pixel_rgba32 already decodes assuming
-   * p[0]=R, p[1]=G, p[2]=B, p[3]=A. Previous implementation wrote A,R,G,B
-   * causing AA coverage (which relies on alpha) to sample the blue channel
-   * and produce tinted outlines (e.g. blue instead of intended colors). */
+/* RGBA32 stores R,G,B,A bytes; BGRA32 and XRGB32 store B,G,R,A (XRGB32
+ * treats A as padding). One implementation serves all three with the red
+ * and blue byte offsets @p ri and @p bi as constants. */
+static inline void set_pixel_32(pix_frame_t *frame, pix_point_t pt,
+                                pix_color_t color, int ri, int bi) {
   uint16_t x = (uint16_t)pt.x, y = (uint16_t)pt.y;
   uint8_t *p = (uint8_t *)frame->pixels + y * frame->stride + x * 4u;
   uint8_t a = (uint8_t)((color >> 24) & 0xFFu);
@@ -19,42 +19,192 @@ void pix_frame_set_pixel_rgba32(pix_frame_t *frame, pix_point_t pt,
   uint8_t sg = (uint8_t)((color >> 8) & 0xFFu);
   uint8_t sb = (uint8_t)(color & 0xFFu);
   if (a == 255u) { // fast path opaque
-    p[0] = sr;
+    p[ri] = sr;
     p[1] = sg;
-    p[2] = sb;
+    p[bi] = sb;
     p[3] = a;
     return;
   }
   // Src-over blend with existing dst (premult not stored; straight alpha)
-  uint8_t dr = p[0], dg = p[1], db = p[2], da = p[3];
+  uint8_t dr = p[ri], dg = p[1], db = p[bi], da = p[3];
   uint32_t ia = 255u - a;
   uint8_t or = (uint8_t)((sr * a + dr * ia + 127u) / 255u);
   uint8_t og = (uint8_t)((sg * a + dg * ia + 127u) / 255u);
   uint8_t ob = (uint8_t)((sb * a + db * ia + 127u) / 255u);
   uint8_t oa = (uint8_t)(a + ((da * ia + 127u) / 255u));
-  p[0] = or;
+  p[ri] = or;
   p[1] = og;
-  p[2] = ob;
+  p[bi] = ob;
   p[3] = oa;
 }
 
-void pix_frame_clear_rgba32(pix_frame_t *frame, pix_color_t value) {
-  uint8_t a = (value >> 24) & 0xFF;
-  uint8_t r = (value >> 16) & 0xFF;
-  uint8_t g = (value >> 8) & 0xFF;
-  uint8_t b = value & 0xFF;
-  for (size_t y = 0; y < frame->size.h; ++y) {
-    uint8_t *row = (uint8_t *)frame->pixels + y * frame->stride;
-    for (size_t x = 0; x < frame->size.w; ++x) {
-      uint8_t *p = row + x * 4u;
-      p[0] = r;
-      p[1] = g;
-      p[2] = b;
-      p[3] = a;
+void pix_frame_set_pixel_rgba32(pix_frame_t *frame, pix_point_t pt,
+                                pix_color_t color) {
+  /* Internal canonical in‑memory order is R,G,B,A so that index 3 holds the
+   * most significant (alpha) byte. get_pixel_rgba32 already decodes assuming
+   * p[0]=R, p[1]=G, p[2]=B, p[3]=A. Previous implementation wrote A,R,G,B
+   * causing AA coverage (which relies on alpha) to sample the blue channel
+   * and produce tinted outlines (e.g. blue instead of intended colors). */
+  set_pixel_32(frame, pt, color, 0, 2);
+}
+
+void pix_frame_set_pixel_bgra32(pix_frame_t *frame, pix_point_t pt,
+                                pix_color_t color) {
+  set_pixel_32(frame, pt, color, 2, 0);
+}
+
+static inline void clear_32(pix_frame_t *frame, pix_point_t origin,
+                            pix_size_t size, pix_color_t value, int ri,
+                            int bi) {
+  uint8_t px[4];
+  px[ri] = (uint8_t)(value >> 16);
+  px[1] = (uint8_t)(value >> 8);
+  px[bi] = (uint8_t)value;
+  px[3] = (uint8_t)(value >> 24);
+  uint32_t word;
+  memcpy(&word, px, 4);
+  uint8_t *row = (uint8_t *)frame->pixels + origin.y * frame->stride +
+                 (size_t)origin.x * 4u;
+  if (frame->stride == (size_t)size.w * 4u) { // whole rows, no padding
+    pix_fill32(row, word, (size_t)size.w * size.h);
+    return;
+  }
+  for (size_t y = 0; y < size.h; ++y, row += frame->stride)
+    pix_fill32(row, word, size.w);
+}
+
+void pix_frame_clear_rgba32(pix_frame_t *frame, pix_point_t origin,
+                            pix_size_t size, pix_color_t value) {
+  clear_32(frame, origin, size, value, 0, 2);
+}
+
+void pix_frame_clear_bgra32(pix_frame_t *frame, pix_point_t origin,
+                            pix_size_t size, pix_color_t value) {
+  clear_32(frame, origin, size, value, 2, 0);
+}
+
+void pix_frame_clear_xrgb32(pix_frame_t *frame, pix_point_t origin,
+                            pix_size_t size, pix_color_t value) {
+  // Padding is kept opaque so blends leave it at 0xFF.
+  clear_32(frame, origin, size, value | 0xFF000000u, 2, 0);
+}
+
+/* Spread the 4 bytes of a pixel word into 16-bit lanes, and back. */
+static inline uint64_t lanes_32(uint32_t v) {
+  uint64_t x = v;
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+  return (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+}
+
+static inline uint32_t unlanes_32(uint64_t x) {
+  x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+  return (uint32_t)(x | (x >> 16));
+}
+
+/* Source color for blend_32: the pixel it would store, alpha forced to 255,
+ * in lanes. */
+static inline uint64_t blend_src_32(uint8_t sr, uint8_t sg, uint8_t sb,
+                                    int ri, int bi) {
+  uint8_t px[4];
+  px[ri] = sr;
+  px[1] = sg;
+  px[bi] = sb;
+  px[3] = 255u;
+  uint32_t word;
+  memcpy(&word, px, 4);
+  return lanes_32(word);
+}
+
+/* Src-over one pixel with an effective alpha already folded in (0 < a < 255).
+ * All four channels go through one set of 64-bit multiplies: color lanes give
+ * (s * a + d * (255 - a) + 127) / 255 and the alpha lane, whose source is 255,
+ * a + (d * (255 - a) + 127) / 255. Each lane stays below 65408, where
+ * (t + 1 + (t >> 8)) >> 8 equals t / 255 exactly. */
+static inline void blend_32(uint8_t *p, uint64_t src, uint32_t a) {
+  uint32_t word;
+  memcpy(&word, p, 4);
+  uint64_t t = src * a + lanes_32(word) * (255u - a) + 0x007F007F007F007Full;
+  t = (t + 0x0001000100010001ull + ((t >> 8) & 0x00FF00FF00FF00FFull)) >> 8;
+  word = unlanes_32(t & 0x00FF00FF00FF00FFull);
+  memcpy(p, &word, 4);
+}
+
+static inline void fill_span_32(pix_frame_t *frame, int16_t y, int16_t x0,
+                                int16_t x1, pix_color_t color, int ri,
+                                int bi) {
+  uint8_t a = (uint8_t)((color >> 24) & 0xFFu);
+  if (a == 0)
+    return;
+  uint8_t sr = (uint8_t)((color >> 16) & 0xFFu);
+  uint8_t sg = (uint8_t)((color >> 8) & 0xFFu);
+  uint8_t sb = (uint8_t)(color & 0xFFu);
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride +
+               (size_t)x0 * 4u;
+  size_t n = (size_t)(x1 - x0);
+  if (a == 255u) {
+    /* Opaque: replicate the 4-byte pattern as whole words. */
+    uint8_t px[4];
+    px[ri] = sr;
+    px[1] = sg;
+    px[bi] = sb;
+    px[3] = a;
+    uint32_t word;
+    memcpy(&word, px, 4);
+    pix_fill32(p, word, n);
+    return;
+  }
+  uint64_t src = blend_src_32(sr, sg, sb, ri, bi);
+  for (size_t i = 0; i < n; ++i, p += 4)
+    blend_32(p, src, a);
+}
+
+void pix_frame_fill_span_rgba32(pix_frame_t *frame, int16_t y, int16_t x0,
+                                int16_t x1, pix_color_t color) {
+  fill_span_32(frame, y, x0, x1, color, 0, 2);
+}
+
+void pix_frame_fill_span_bgra32(pix_frame_t *frame, int16_t y, int16_t x0,
+                                int16_t x1, pix_color_t color) {
+  fill_span_32(frame, y, x0, x1, color, 2, 0);
+}
+
+static inline void blend_span_32(pix_frame_t *frame, int16_t y, int16_t x0,
+                                 const uint8_t *coverage, uint16_t len,
+                                 pix_color_t color, int ri, int bi) {
+  uint8_t sa = (uint8_t)((color >> 24) & 0xFFu);
+  if (sa == 0)
+    return;
+  uint8_t sr = (uint8_t)((color >> 16) & 0xFFu);
+  uint8_t sg = (uint8_t)((color >> 8) & 0xFFu);
+  uint8_t sb = (uint8_t)(color & 0xFFu);
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride +
+               (size_t)x0 * 4u;
+  uint64_t src = blend_src_32(sr, sg, sb, ri, bi);
+  uint32_t opaque = unlanes_32(src);
+  for (uint16_t i = 0; i < len; ++i, p += 4) {
+    uint32_t a = sa == 255u ? coverage[i] : pix_mul255(sa, coverage[i]);
+    if (a == 0)
+      continue;
+    if (a == 255u) {
+      memcpy(p, &opaque, 4);
+      continue;
     }
+    blend_32(p, src, a);
   }
 }
 
+void pix_frame_blend_span_rgba32(pix_frame_t *frame, int16_t y, int16_t x0,
+                                 const uint8_t *coverage, uint16_t len,
+                                 pix_color_t color) {
+  blend_span_32(frame, y, x0, coverage, len, color, 0, 2);
+}
+
+void pix_frame_blend_span_bgra32(pix_frame_t *frame, int16_t y, int16_t x0,
+                                 const uint8_t *coverage, uint16_t len,
+                                 pix_color_t color) {
+  blend_span_32(frame, y, x0, coverage, len, color, 2, 0);
+}
+
 pix_color_t pix_frame_get_pixel_rgba32(const pix_frame_t *frame,
                                        pix_point_t pt) {
   const uint8_t *row =
@@ -64,109 +214,91 @@ pix_color_t pix_frame_get_pixel_rgba32(const pix_frame_t *frame,
          ((uint32_t)p[1] << 8) | (uint32_t)p[2];
 }
 
-bool pix_frame_copy_from_rgba32(pix_frame_t *dst, pix_point_t dst_origin,
-                                const pix_frame_t *src, pix_point_t src_origin,
-                                pix_size_t size, pix_blit_flags_t flags) {
-  bool want_alpha = (flags & PIX_BLIT_ALPHA) != 0;
+pix_color_t pix_frame_get_pixel_bgra32(const pix_frame_t *frame,
+                                       pix_point_t pt) {
+  const uint8_t *p = (const uint8_t *)frame->pixels +
+                     (size_t)pt.y * frame->stride + (size_t)pt.x * 4u;
+  return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+}
+
+pix_color_t pix_frame_get_pixel_xrgb32(const pix_frame_t *frame,
+                                       pix_point_t pt) {
+  return pix_frame_get_pixel_bgra32(frame, pt) | 0xFF000000u;
+}
+
+/* Src-over @p n straight 32-bit pixels onto a row of @p format; the source
+ * channel order must match the target's (see blend_order). */
+static bool blend_row(pix_format_t format, uint8_t *dp, const uint8_t *sp,
+                      size_t n) {
+  switch (format) {
+  case PIX_FMT_RGBA32:
+  case PIX_FMT_RGBA32_PREMUL:
+  case PIX_FMT_BGRA32:
+  case PIX_FMT_XRGB32:
+    // s * a + d * (1 - a) is also exact src-over onto premultiplied dst.
+    pix_blend_rgba32(dp, sp, n);
+    return true;
+  case PIX_FMT_RGB24:
+  case PIX_FMT_BGR24:
+    pix_blend_rgb24(dp, sp, n);
+    return true;
+  case PIX_FMT_RGB565:
+    pix_blend_rgb565(dp, sp, n);
+    return true;
+  case PIX_FMT_GRAY8:
+    for (size_t col = 0; col < n; ++col, sp += 4) {
+      uint32_t sa = sp[3], inv = 255u - sa;
+      uint8_t lum = pix_luma(sp[0], sp[1], sp[2]);
+      dp[col] = (uint8_t)((lum * sa + dp[col] * inv + 127u) / 255u);
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+/* Straight source layout blend_row wants for a @p format target. */
+static pix_format_t blend_order(pix_format_t format) {
+  switch (format) {
+  case PIX_FMT_BGRA32:
+  case PIX_FMT_XRGB32:
+  case PIX_FMT_BGR24:
+    return PIX_FMT_BGRA32;
+  default:
+    return PIX_FMT_RGBA32;
+  }
+}
+
+bool pix_frame_blend_from_rgba32(pix_frame_t *dst, pix_point_t dst_origin,
+                                 const pix_frame_t *src,
+                                 pix_point_t src_origin, pix_size_t size) {
+  size_t bpp = pix_format_bytes(dst->format);
+  pix_format_t want = blend_order(dst->format);
   for (uint16_t row = 0; row < size.h; ++row) {
     const uint8_t *srow = (const uint8_t *)src->pixels +
                           (size_t)(src_origin.y + row) * src->stride +
                           (size_t)src_origin.x * 4u;
-    uint8_t *drow =
-        (uint8_t *)dst->pixels + (size_t)(dst_origin.y + row) * dst->stride;
-    switch (dst->format) {
-    case PIX_FMT_RGBA32: {
-      uint8_t *dp = drow + (size_t)dst_origin.x * 4u;
-      if (!want_alpha) {
-        memcpy(dp, srow, (size_t)size.w * 4u);
-      } else {
-        for (uint16_t col = 0; col < size.w; ++col) {
-          const uint8_t *sp = srow + col * 4u;
-          uint8_t *op = dp + col * 4u;
-          uint8_t sa = sp[3];
-          if (sa == 255) {
-            op[0] = sp[0];
-            op[1] = sp[1];
-            op[2] = sp[2];
-            op[3] = 255;
-            continue;
-          }
-          if (sa == 0)
-            continue;
-          uint8_t dr = op[0], dg = op[1], db = op[2], da = op[3];
-          uint32_t inv = 255 - sa;
-          op[0] = (uint8_t)((sp[0] * sa + dr * inv) / 255);
-          op[1] = (uint8_t)((sp[1] * sa + dg * inv) / 255);
-          op[2] = (uint8_t)((sp[2] * sa + db * inv) / 255);
-          op[3] = (uint8_t)(sa + (da * inv) / 255);
-        }
-      }
-      break;
-    }
-    case PIX_FMT_RGB24: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        const uint8_t *sp = srow + col * 4u;
-        uint8_t *dp = drow + ((size_t)dst_origin.x + col) * 3u;
-        if (want_alpha) {
-          uint8_t sa = sp[3];
-          uint8_t dr = dp[0], dg = dp[1], db = dp[2];
-          uint32_t inv = 255 - sa;
-          dp[0] = (uint8_t)((sp[0] * sa + dr * inv) / 255);
-          dp[1] = (uint8_t)((sp[1] * sa + dg * inv) / 255);
-          dp[2] = (uint8_t)((sp[2] * sa + db * inv) / 255);
-        } else {
-          dp[0] = sp[0];
-          dp[1] = sp[1];
-          dp[2] = sp[2];
-        }
-      }
-      break;
-    }
-    case PIX_FMT_GRAY8: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        const uint8_t *sp = srow + col * 4u;
-        uint8_t *dp = drow + (size_t)dst_origin.x + col;
-        uint8_t lum = pix_luma(sp[0], sp[1], sp[2]);
-        if (want_alpha) {
-          uint8_t sa = sp[3];
-          uint8_t dg = *dp;
-          uint32_t inv = 255 - sa;
-          *dp = (uint8_t)((lum * sa + dg * inv) / 255);
-        } else {
-          *dp = lum;
-        }
-      }
-      break;
+    uint8_t *drow = (uint8_t *)dst->pixels +
+                    (size_t)(dst_origin.y + row) * dst->stride +
+                    (size_t)dst_origin.x * bpp;
+    if (src->format == PIX_FMT_RGBA32_PREMUL &&
+        dst->format == PIX_FMT_RGBA32_PREMUL) {
+      pix_blend_premul(drow, srow, size.w);
+      continue;
     }
-    case PIX_FMT_RGB565: {
-      for (uint16_t col = 0; col < size.w; ++col) {
-        const uint8_t *sp = srow + col * 4u;
-        uint16_t *dp = (uint16_t *)(drow + ((size_t)dst_origin.x + col) * 2u);
-        uint8_t r = sp[0], g = sp[1], b = sp[2];
-        if (want_alpha) {
-          uint8_t sa = sp[3];
-          if (sa == 255) {
-            *dp = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
-          } else if (sa) {
-            uint16_t dv = *dp;
-            uint8_t dr = (uint8_t)(((dv >> 11) & 0x1F) << 3);
-            uint8_t dg = (uint8_t)(((dv >> 5) & 0x3F) << 2);
-            uint8_t db = (uint8_t)((dv & 0x1F) << 3);
-            uint32_t inv = 255 - sa;
-            uint8_t rr = (uint8_t)((r * sa + dr * inv) / 255);
-            uint8_t rg = (uint8_t)((g * sa + dg * inv) / 255);
-            uint8_t rb = (uint8_t)((b * sa + db * inv) / 255);
-            *dp =
-                (uint16_t)(((rr & 0xF8) << 8) | ((rg & 0xFC) << 3) | (rb >> 3));
-          }
-        } else {
-          *dp = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
-        }
-      }
-      break;
+    if (src->format == want) {
+      if (!blend_row(dst->format, drow, srow, size.w))
+        return false;
+      continue;
     }
-    default:
-      break;
+    // Otherwise swizzle or unpremultiply a block at a time.
+    uint8_t tmp[256 * 4];
+    for (size_t col = 0; col < size.w; col += 256) {
+      size_t n = size.w - col < 256 ? size.w - col : 256;
+      if (!pix_convert_row(want, tmp, src->format, srow + col * 4u, n) ||
+          !blend_row(dst->format, drow + col * bpp, tmp, n))
+        return false;
     }
   }
   return true;
@@ -0,0 +1,115 @@
+#include "color_internal.h"
+#include "simd_internal.h"
+#include <pix/pix.h>
+#include <stdint.h>
+#include <string.h>
+
+/* PIX_FMT_RGBA32_PREMUL: R,G,B,A bytes as for RGBA32 with R, G and B
+ * premultiplied by A. Colors arrive straight (0xAARRGGBB) and are
+ * premultiplied once per call; every blend is then dst = src + dst * (1 - a)
+ * on all four channels, with no divide by the destination alpha. */
+
+static inline void premul_color(pix_color_t color, uint8_t px[4]) {
+  uint32_t a = color >> 24;
+  px[0] = pix_mul255((color >> 16) & 0xFFu, a);
+  px[1] = pix_mul255((color >> 8) & 0xFFu, a);
+  px[2] = pix_mul255(color & 0xFFu, a);
+  px[3] = (uint8_t)a;
+}
+
+/* Src-over one premultiplied pixel @p s (0 < alpha < 255). */
+static inline void over_rgba32p(uint8_t *p, const uint8_t s[4]) {
+  uint32_t ia = 255u - s[3];
+  p[0] = (uint8_t)(s[0] + (p[0] * ia + 127u) / 255u);
+  p[1] = (uint8_t)(s[1] + (p[1] * ia + 127u) / 255u);
+  p[2] = (uint8_t)(s[2] + (p[2] * ia + 127u) / 255u);
+  p[3] = (uint8_t)(s[3] + (p[3] * ia + 127u) / 255u);
+}
+
+void pix_frame_set_pixel_rgba32p(pix_frame_t *frame, pix_point_t pt,
+                                 pix_color_t color) {
+  uint16_t x = (uint16_t)pt.x, y = (uint16_t)pt.y;
+  uint8_t *p = (uint8_t *)frame->pixels + y * frame->stride + x * 4u;
+  uint8_t s[4];
+  premul_color(color, s);
+  if (s[3] == 0)
+    return;
+  if (s[3] == 255u)
+    memcpy(p, s, 4);
+  else
+    over_rgba32p(p, s);
+}
+
+void pix_frame_clear_rgba32p(pix_frame_t *frame, pix_point_t origin,
+                             pix_size_t size, pix_color_t value) {
+  uint8_t px[4];
+  uint32_t word;
+  premul_color(value, px);
+  memcpy(&word, px, 4);
+  uint8_t *row = (uint8_t *)frame->pixels + origin.y * frame->stride +
+                 (size_t)origin.x * 4u;
+  if (frame->stride == (size_t)size.w * 4u) { // whole rows, no padding
+    pix_fill32(row, word, (size_t)size.w * size.h);
+    return;
+  }
+  for (size_t y = 0; y < size.h; ++y, row += frame->stride)
+    pix_fill32(row, word, size.w);
+}
+
+void pix_frame_fill_span_rgba32p(pix_frame_t *frame, int16_t y, int16_t x0,
+                                 int16_t x1, pix_color_t color) {
+  uint8_t s[4];
+  premul_color(color, s);
+  if (s[3] == 0)
+    return;
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride +
+               (size_t)x0 * 4u;
+  size_t n = (size_t)(x1 - x0);
+  if (s[3] == 255u) {
+    uint32_t word;
+    memcpy(&word, s, 4);
+    pix_fill32(p, word, n);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i, p += 4)
+    over_rgba32p(p, s);
+}
+
+void pix_frame_blend_span_rgba32p(pix_frame_t *frame, int16_t y, int16_t x0,
+                                  const uint8_t *coverage, uint16_t len,
+                                  pix_color_t color) {
+  uint8_t s[4];
+  premul_color(color, s);
+  if (s[3] == 0)
+    return;
+  uint8_t *p = (uint8_t *)frame->pixels + (size_t)y * frame->stride +
+               (size_t)x0 * 4u;
+  for (uint16_t i = 0; i < len; ++i, p += 4) {
+    uint32_t c = coverage[i];
+    if (c == 255u) {
+      if (s[3] == 255u)
+        memcpy(p, s, 4);
+      else
+        over_rgba32p(p, s);
+      continue;
+    }
+    // Coverage scales all four premultiplied channels alike.
+    uint8_t t[4] = {pix_mul255(s[0], c), pix_mul255(s[1], c),
+                    pix_mul255(s[2], c), pix_mul255(s[3], c)};
+    if (t[3] == 0)
+      continue;
+    over_rgba32p(p, t);
+  }
+}
+
+pix_color_t pix_frame_get_pixel_rgba32p(const pix_frame_t *frame,
+                                        pix_point_t pt) {
+  const uint8_t *p = (const uint8_t *)frame->pixels +
+                     (size_t)pt.y * frame->stride + (size_t)pt.x * 4u;
+  uint32_t a = p[3];
+  if (a == 255u)
+    return 0xFF000000u | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) |
+           (uint32_t)p[2];
+  return (a << 24) | ((uint32_t)pix_unpremul(p[0], a) << 16) |
+         ((uint32_t)pix_unpremul(p[1], a) << 8) | pix_unpremul(p[2], a);
+}
@@ -3,6 +3,7 @@
 #include <SDL2/SDL.h>
 #include <pix/pix.h>
 #include <pix/sdl.h>
+#include <string.h>
 #include <vg/vg.h>
 
 typedef struct pix_frame_sdl_ctx_t {
@@ -15,6 +16,14 @@ typedef struct pix_frame_sdl_ctx_t {
   void *line_cmds; /* sdl_line_cmd_t[] */
   size_t line_count;
   size_t line_capacity;
+  /* PIXSDL_SHADOW: persistent frame pixels and a copy of what the texture
+   * holds, both packed at row_bytes; only rows that differ are uploaded. */
+  bool shadow_mode;
+  bool full_upload;
+  Uint32 sdl_format;
+  uint8_t *shadow;
+  uint8_t *front;
+  size_t row_bytes;
 } pix_frame_sdl_ctx_t;
 
 typedef struct sdl_line_cmd_t {
@@ -53,10 +62,207 @@ static void pix_frame_sdl_draw_line(pix_frame_t *frame, pix_point_t a,
   sdl_queue_line((pix_frame_sdl_ctx_t *)frame->user, a, b, color);
 }
 
+/* Replace the shadow buffers with ones of @p w x @p h, keeping the pixels
+ * that still fit; the texture must be refilled afterwards. */
+static bool sdl_alloc_shadow(pix_frame_t *frame, pix_frame_sdl_ctx_t *ctx,
+                             int w, int h) {
+  size_t row_bytes = (size_t)w * pix_format_bytes(frame->format);
+  size_t len = row_bytes * (size_t)h;
+  uint8_t *shadow = (uint8_t *)VG_MALLOC(len);
+  uint8_t *front = (uint8_t *)VG_MALLOC(len);
+  if (!shadow || !front) {
+    VG_FREE(shadow);
+    VG_FREE(front);
+    return false;
+  }
+  memset(shadow, 0, len);
+  if (ctx->shadow) {
+    size_t keep = row_bytes < ctx->row_bytes ? row_bytes : ctx->row_bytes;
+    int rows = h < frame->size.h ? h : frame->size.h;
+    for (int y = 0; y < rows; ++y)
+      memcpy(shadow + (size_t)y * row_bytes,
+             ctx->shadow + (size_t)y * ctx->row_bytes, keep);
+    VG_FREE(ctx->shadow);
+    VG_FREE(ctx->front);
+  }
+  ctx->shadow = shadow;
+  ctx->front = front;
+  ctx->row_bytes = row_bytes;
+  ctx->full_upload = true;
+  frame->pixels = shadow;
+  frame->stride = row_bytes;
+  frame->size.w = (uint16_t)w;
+  frame->size.h = (uint16_t)h;
+  return true;
+}
+
+/* Follow the renderer's output size, reallocating texture and shadow when
+ * the window was resized. On failure the frame keeps its old size. */
+static void sdl_sync_size(pix_frame_t *frame, pix_frame_sdl_ctx_t *ctx) {
+  int w = 0, h = 0;
+  if (SDL_GetRendererOutputSize(ctx->renderer, &w, &h) != 0)
+    return;
+  if (w <= 0 || h <= 0 || w > UINT16_MAX || h > UINT16_MAX ||
+      (w == ctx->tex_w && h == ctx->tex_h))
+    return;
+  SDL_Texture *tex = SDL_CreateTexture(ctx->renderer, ctx->sdl_format,
+                                       SDL_TEXTUREACCESS_STATIC, w, h);
+  if (!tex)
+    return;
+  if (!sdl_alloc_shadow(frame, ctx, w, h)) {
+    SDL_DestroyTexture(tex);
+    return;
+  }
+  if (ctx->owns_texture)
+    SDL_DestroyTexture(ctx->texture);
+  ctx->texture = tex;
+  ctx->owns_texture = true;
+  ctx->tex_w = w;
+  ctx->tex_h = h;
+}
+
+static void sdl_upload_rows(pix_frame_sdl_ctx_t *ctx, int y0, int y1) {
+  SDL_Rect r = {0, y0, ctx->tex_w, y1 - y0};
+  const uint8_t *src = ctx->shadow + (size_t)y0 * ctx->row_bytes;
+  SDL_UpdateTexture(ctx->texture, &r, src, (int)ctx->row_bytes);
+}
+
+/* Upload the bands of rows that changed since the last unlock. Bands closer
+ * than this many rows go up as one rectangle. */
+#define BAND_GAP_ROWS 8
+
+static void sdl_upload_dirty(pix_frame_sdl_ctx_t *ctx) {
+  size_t rb = ctx->row_bytes;
+  if (ctx->full_upload) {
+    SDL_UpdateTexture(ctx->texture, NULL, ctx->shadow, (int)rb);
+    memcpy(ctx->front, ctx->shadow, rb * (size_t)ctx->tex_h);
+    ctx->full_upload = false;
+    return;
+  }
+  int band = -1, last = -1;
+  for (int y = 0; y < ctx->tex_h; ++y) {
+    const uint8_t *src = ctx->shadow + (size_t)y * rb;
+    uint8_t *seen = ctx->front + (size_t)y * rb;
+    if (memcmp(src, seen, rb) == 0)
+      continue;
+    memcpy(seen, src, rb);
+    if (band >= 0 && y - last > BAND_GAP_ROWS) {
+      sdl_upload_rows(ctx, band, last + 1);
+      band = -1;
+    }
+    if (band < 0)
+      band = y;
+    last = y;
+  }
+  if (band >= 0)
+    sdl_upload_rows(ctx, band, last + 1);
+}
+
+/* Queued lines are submitted in batches of up to this many segments. */
+#define LINE_BATCH 256
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/* Append a one-pixel-thick quad covering the pixels SDL_RenderDrawLine
+ * would: it spans one pixel across the major axis and reaches half a pixel
+ * past both endpoint centers. */
+static void sdl_line_quad(SDL_Vertex *v, const sdl_line_cmd_t *cmd) {
+  float x0 = (float)cmd->x0 + 0.5f, y0 = (float)cmd->y0 + 0.5f;
+  float x1 = (float)cmd->x1 + 0.5f, y1 = (float)cmd->y1 + 0.5f;
+  int dx = cmd->x1 - cmd->x0, dy = cmd->y1 - cmd->y0;
+  float ux = 0.f, uy = 0.f, nx = 0.f, ny = 0.f;
+  if (abs(dx) >= abs(dy)) {
+    ux = dx < 0 ? -0.5f : 0.5f;
+    ny = 0.5f;
+  } else {
+    uy = dy < 0 ? -0.5f : 0.5f;
+    nx = 0.5f;
+  }
+  SDL_Color c = {cmd->r, cmd->g, cmd->b, cmd->a};
+  v[0] = (SDL_Vertex){{x0 - ux - nx, y0 - uy - ny}, c, {0.f, 0.f}};
+  v[1] = (SDL_Vertex){{x0 - ux + nx, y0 - uy + ny}, c, {0.f, 0.f}};
+  v[2] = (SDL_Vertex){{x1 + ux + nx, y1 + uy + ny}, c, {0.f, 0.f}};
+  v[3] = (SDL_Vertex){{x1 + ux - nx, y1 + uy - ny}, c, {0.f, 0.f}};
+}
+
+/* Colors travel per vertex, so a run of any colors is one geometry call per
+ * batch. */
+static void sdl_draw_lines(pix_frame_sdl_ctx_t *ctx, const sdl_line_cmd_t *cmd,
+                           size_t n) {
+  static int indices[LINE_BATCH * 6];
+  if (!indices[1]) {
+    for (int i = 0; i < LINE_BATCH; ++i) {
+      int *q = &indices[i * 6], b = i * 4;
+      q[0] = b, q[1] = b + 1, q[2] = b + 2;
+      q[3] = b, q[4] = b + 2, q[5] = b + 3;
+    }
+  }
+  SDL_Vertex verts[LINE_BATCH * 4];
+  while (n) {
+    size_t k = n < LINE_BATCH ? n : LINE_BATCH;
+    for (size_t i = 0; i < k; ++i)
+      sdl_line_quad(&verts[i * 4], &cmd[i]);
+    SDL_RenderGeometry(ctx->renderer, NULL, verts, (int)k * 4, indices,
+                       (int)k * 6);
+    cmd += k;
+    n -= k;
+  }
+}
+#else
+/* Segments that continue each other in one color become one polyline, and
+ * the draw color is set only when it changes. */
+static void sdl_draw_lines(pix_frame_sdl_ctx_t *ctx, const sdl_line_cmd_t *cmd,
+                           size_t n) {
+  SDL_Point pts[LINE_BATCH + 1];
+  int count = 0;
+  uint32_t color = 0, last = 0;
+  bool have_color = false;
+  for (size_t i = 0; i < n; ++i, ++cmd) {
+    color = ((uint32_t)cmd->r << 24) | ((uint32_t)cmd->g << 16) |
+            ((uint32_t)cmd->b << 8) | cmd->a;
+    bool joins = count && color == last && count <= LINE_BATCH &&
+                 pts[count - 1].x == cmd->x0 && pts[count - 1].y == cmd->y0;
+    if (!joins) {
+      if (count)
+        SDL_RenderDrawLines(ctx->renderer, pts, count);
+      if (!have_color || color != last)
+        SDL_SetRenderDrawColor(ctx->renderer, cmd->r, cmd->g, cmd->b, cmd->a);
+      have_color = true;
+      last = color;
+      pts[0] = (SDL_Point){cmd->x0, cmd->y0};
+      count = 1;
+    }
+    pts[count++] = (SDL_Point){cmd->x1, cmd->y1};
+  }
+  if (count)
+    SDL_RenderDrawLines(ctx->renderer, pts, count);
+}
+#endif
+
+/* Replay the queued lines in order, one blend-mode change per run of opaque
+ * or translucent lines rather than per line. */
+static void sdl_flush_lines(pix_frame_sdl_ctx_t *ctx) {
+  const sdl_line_cmd_t *arr = (const sdl_line_cmd_t *)ctx->line_cmds;
+  size_t i = 0;
+  while (i < ctx->line_count) {
+    bool blend = arr[i].a != 255;
+    size_t j = i + 1;
+    while (j < ctx->line_count && (arr[j].a != 255) == blend)
+      ++j;
+    SDL_SetRenderDrawBlendMode(ctx->renderer, blend ? SDL_BLENDMODE_BLEND
+                                                    : SDL_BLENDMODE_NONE);
+    sdl_draw_lines(ctx, arr + i, j - i);
+    i = j;
+  }
+}
+
 static bool pix_frame_sdl_lock(pix_frame_t *frame) {
   if (!frame || !frame->user)
     return false;
   pix_frame_sdl_ctx_t *ctx = (pix_frame_sdl_ctx_t *)frame->user;
+  if (ctx->shadow_mode) {
+    sdl_sync_size(frame, ctx);
+    return frame->pixels != NULL;
+  }
   void *pixels = NULL;
   int pitch = 0;
   if (SDL_LockTexture(ctx->texture, NULL, &pixels, &pitch) != 0)
@@ -70,20 +276,14 @@ static void pix_frame_sdl_unlock(pix_frame_t *frame) {
   if (!frame || !frame->user)
     return;
   pix_frame_sdl_ctx_t *ctx = (pix_frame_sdl_ctx_t *)frame->user;
-  SDL_UnlockTexture(ctx->texture);
+  if (ctx->shadow_mode)
+    sdl_upload_dirty(ctx);
+  else
+    SDL_UnlockTexture(ctx->texture);
   SDL_RenderCopy(ctx->renderer, ctx->texture, NULL, NULL);
-  if (ctx->line_count && ctx->line_cmds) {
-    sdl_line_cmd_t *arr = (sdl_line_cmd_t *)ctx->line_cmds;
-    for (size_t i = 0; i < ctx->line_count; ++i) {
-      sdl_line_cmd_t *cmd = &arr[i];
-      SDL_SetRenderDrawBlendMode(ctx->renderer, cmd->a == 255
-                                                    ? SDL_BLENDMODE_NONE
-                                                    : SDL_BLENDMODE_BLEND);
-      SDL_SetRenderDrawColor(ctx->renderer, cmd->r, cmd->g, cmd->b, cmd->a);
-      SDL_RenderDrawLine(ctx->renderer, cmd->x0, cmd->y0, cmd->x1, cmd->y1);
-    }
-    ctx->line_count = 0;
-  }
+  if (ctx->line_count && ctx->line_cmds)
+    sdl_flush_lines(ctx);
+  ctx->line_count = 0;
   SDL_RenderPresent(ctx->renderer);
 }
 
@@ -92,7 +292,8 @@ static void pix_frame_sdl_destroy(pix_frame_t *frame) {
     return;
   pix_frame_sdl_ctx_t *ctx = (pix_frame_sdl_ctx_t *)frame->user;
   if (ctx) {
-    SDL_UnlockTexture(ctx->texture);
+    if (!ctx->shadow_mode)
+      SDL_UnlockTexture(ctx->texture);
     if (ctx->owns_texture && ctx->texture)
       SDL_DestroyTexture(ctx->texture);
     if (ctx->owns_window) {
@@ -104,6 +305,8 @@ static void pix_frame_sdl_destroy(pix_frame_t *frame) {
     }
     if (ctx->line_cmds)
       VG_FREE(ctx->line_cmds);
+    VG_FREE(ctx->shadow);
+    VG_FREE(ctx->front);
     VG_FREE(ctx);
   }
   VG_FREE(frame);
@@ -135,33 +338,95 @@ static bool pix_frame_init_sdl(pix_frame_t *frame, SDL_Window *win,
   frame->get_pixel = pix_frame_get_pixel;
   frame->copy = pix_frame_copy;
   frame->draw_line = pix_frame_sdl_draw_line;
+  frame->fill_span = pix_frame_fill_span;
+  frame->blend_span = pix_frame_blend_span;
   frame->pixels = NULL;
   frame->stride = 0;
   frame->destroy = pix_frame_sdl_destroy;
   return true;
 }
 
+/* SDL texture format with the same memory layout as @p fmt, or
+ * SDL_PIXELFORMAT_UNKNOWN. */
+static Uint32 sdl_texture_format(pix_format_t fmt) {
+  switch (fmt) {
+  case PIX_FMT_RGB24:
+    return SDL_PIXELFORMAT_RGB24;
+  case PIX_FMT_BGR24:
+    return SDL_PIXELFORMAT_BGR24;
+  case PIX_FMT_RGBA32:
+  case PIX_FMT_RGBA32_PREMUL:
+    return SDL_PIXELFORMAT_RGBA32;
+  case PIX_FMT_BGRA32:
+    return SDL_PIXELFORMAT_BGRA32;
+  case PIX_FMT_XRGB32:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    return SDL_PIXELFORMAT_RGB888;
+#else
+    return SDL_PIXELFORMAT_BGRX8888;
+#endif
+  case PIX_FMT_RGB565:
+    return SDL_PIXELFORMAT_RGB565;
+  default:
+    return SDL_PIXELFORMAT_UNKNOWN;
+  }
+}
+
+/* Frame format matching the window surface, so the renderer's upload is a
+ * plain copy. */
+static pix_format_t sdl_native_format(SDL_Window *win) {
+  switch (win ? SDL_GetWindowPixelFormat(win) : SDL_PIXELFORMAT_UNKNOWN) {
+  case SDL_PIXELFORMAT_ARGB8888:
+    return PIX_FMT_BGRA32;
+  case SDL_PIXELFORMAT_ABGR8888:
+    return PIX_FMT_RGBA32;
+  case SDL_PIXELFORMAT_RGB565:
+    return PIX_FMT_RGB565;
+  default:
+    return PIX_FMT_XRGB32;
+  }
+}
+
 static bool pix_frame_init_sdl_auto(pix_frame_t *frame, SDL_Window *win,
                                     SDL_Renderer *ren, int w, int h,
-                                    pix_format_t fmt) {
+                                    pix_format_t fmt, pixsdl_flags_t flags) {
   if (!frame || !ren)
     return false;
-  Uint32 sdl_fmt = (fmt == PIX_FMT_RGB24) ? SDL_PIXELFORMAT_RGB888
-                                          : SDL_PIXELFORMAT_ARGB8888;
-  SDL_Texture *tex =
-      SDL_CreateTexture(ren, sdl_fmt, SDL_TEXTUREACCESS_STREAMING, w, h);
+  if (fmt == PIX_FMT_UNKNOWN)
+    fmt = sdl_native_format(win);
+  Uint32 sdl_fmt = sdl_texture_format(fmt);
+  if (sdl_fmt == SDL_PIXELFORMAT_UNKNOWN)
+    return false;
+  bool shadow = (flags & PIXSDL_SHADOW) != 0;
+  SDL_Texture *tex = SDL_CreateTexture(ren, sdl_fmt,
+                                       shadow ? SDL_TEXTUREACCESS_STATIC
+                                              : SDL_TEXTUREACCESS_STREAMING,
+                                       w, h);
   if (!tex)
     return false;
   if (!pix_frame_init_sdl(frame, win, ren, tex, w, h, fmt)) {
     SDL_DestroyTexture(tex);
     return false;
   }
-  ((pix_frame_sdl_ctx_t *)frame->user)->owns_texture = true;
+  pix_frame_sdl_ctx_t *ctx = (pix_frame_sdl_ctx_t *)frame->user;
+  ctx->owns_texture = true;
+  ctx->sdl_format = sdl_fmt;
+  if (flags & PIXSDL_ACCEL_LINES)
+    frame->caps |= PIX_FRAME_CAP_LINES;
+  if (shadow) {
+    if (!sdl_alloc_shadow(frame, ctx, w, h)) {
+      SDL_DestroyTexture(tex);
+      VG_FREE(ctx);
+      frame->user = NULL;
+      return false;
+    }
+    ctx->shadow_mode = true;
+  }
   return true;
 }
 
-pix_frame_t *pixsdl_frame_init(const char *title, pix_size_t size,
-                               pix_format_t fmt) {
+pix_frame_t *pixsdl_frame_init_ex(const char *title, pix_size_t size,
+                                  pix_format_t fmt, pixsdl_flags_t flags) {
   int w = (int)size.w, h = (int)size.h;
   if (SDL_Init(SDL_INIT_VIDEO) != 0)
     return NULL;
@@ -181,7 +446,7 @@ pix_frame_t *pixsdl_frame_init(const char *title, pix_size_t size,
   }
   if (title && win)
     SDL_SetWindowTitle(win, title);
-  if (!pix_frame_init_sdl_auto(frame, win, ren, w, h, fmt)) {
+  if (!pix_frame_init_sdl_auto(frame, win, ren, w, h, fmt, flags)) {
     SDL_DestroyRenderer(ren);
     SDL_DestroyWindow(win);
     SDL_Quit();
@@ -191,3 +456,8 @@ pix_frame_t *pixsdl_frame_init(const char *title, pix_size_t size,
   ((pix_frame_sdl_ctx_t *)frame->user)->owns_window = true;
   return frame;
 }
+
+pix_frame_t *pixsdl_frame_init(const char *title, pix_size_t size,
+                               pix_format_t fmt) {
+  return pixsdl_frame_init_ex(title, size, fmt, PIXSDL_STREAMING);
+}
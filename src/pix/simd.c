@@ -0,0 +1,588 @@
+#include "simd_internal.h"
+#include <stdbool.h>
+#include <string.h>
+#ifdef VG_ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+/* The 3-byte pattern repeated over 96 bytes: a whole number of pixels and
+ * of 16- and 32-byte vectors. */
+static void pattern24(uint8_t *pat, uint8_t b0, uint8_t b1, uint8_t b2) {
+  for (int i = 0; i < 96; i += 3) {
+    pat[i] = b0;
+    pat[i + 1] = b1;
+    pat[i + 2] = b2;
+  }
+}
+
+/* -------- Portable C -------- */
+static void fill32_c(void *dst, uint32_t value, size_t count) {
+  uint8_t *p = (uint8_t *)dst;
+  uint64_t v2 = (uint64_t)value << 32 | value;
+  for (; count >= 2; count -= 2, p += 8)
+    memcpy(p, &v2, 8);
+  if (count)
+    memcpy(p, &value, 4);
+}
+
+static void fill24_c(void *dst, uint8_t b0, uint8_t b1, uint8_t b2,
+                     size_t count) {
+  uint8_t pat[96];
+  pattern24(pat, b0, b1, b2);
+  uint8_t *p = (uint8_t *)dst;
+  size_t bytes = count * 3u;
+  for (; bytes >= 96; bytes -= 96, p += 96)
+    memcpy(p, pat, 96);
+  memcpy(p, pat, bytes);
+}
+
+/* Reference blends: src-over of straight-alpha RGBA32 with the rounding
+ * (x * a + 127) / 255 used by the span writers. The vector kernels match
+ * them bit for bit and finish their rows with them. */
+void pix_blend_rgba32_ref(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    uint32_t sa = src[3], inv = 255u - sa;
+    if (sa == 0)
+      continue;
+    if (sa == 255u) {
+      memcpy(dst, src, 4);
+      continue;
+    }
+    dst[0] = (uint8_t)((src[0] * sa + dst[0] * inv + 127u) / 255u);
+    dst[1] = (uint8_t)((src[1] * sa + dst[1] * inv + 127u) / 255u);
+    dst[2] = (uint8_t)((src[2] * sa + dst[2] * inv + 127u) / 255u);
+    dst[3] = (uint8_t)(sa + (dst[3] * inv + 127u) / 255u);
+  }
+}
+
+void pix_blend_rgb24_ref(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 3) {
+    uint32_t sa = src[3], inv = 255u - sa;
+    if (sa == 0)
+      continue;
+    dst[0] = (uint8_t)((src[0] * sa + dst[0] * inv + 127u) / 255u);
+    dst[1] = (uint8_t)((src[1] * sa + dst[1] * inv + 127u) / 255u);
+    dst[2] = (uint8_t)((src[2] * sa + dst[2] * inv + 127u) / 255u);
+  }
+}
+
+void pix_blend_rgb565_ref(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 2) {
+    uint32_t sa = src[3], inv = 255u - sa;
+    if (sa == 0)
+      continue;
+    uint16_t d;
+    memcpy(&d, dst, 2);
+    uint32_t dr = ((d >> 11) & 0x1Fu) << 3;
+    uint32_t dg = ((d >> 5) & 0x3Fu) << 2;
+    uint32_t db = (d & 0x1Fu) << 3;
+    uint32_t r = (src[0] * sa + dr * inv + 127u) / 255u;
+    uint32_t g = (src[1] * sa + dg * inv + 127u) / 255u;
+    uint32_t b = (src[2] * sa + db * inv + 127u) / 255u;
+    d = (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
+    memcpy(dst, &d, 2);
+  }
+}
+
+/* Premultiplied src-over: s + (d * (255 - sa) + 127) / 255 on all four
+ * channels, saturating. A zero source word leaves dst alone. */
+void pix_blend_premul_ref(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count; --count, src += 4, dst += 4) {
+    uint32_t inv = 255u - src[3];
+    if (inv == 0u) {
+      memcpy(dst, src, 4);
+      continue;
+    }
+    for (int i = 0; i < 4; ++i) {
+      uint32_t v = src[i] + (dst[i] * inv + 127u) / 255u;
+      dst[i] = (uint8_t)(v > 255u ? 255u : v);
+    }
+  }
+}
+
+/* -------- SSE2 / AVX2 -------- */
+#ifdef PIX_SIMD_SSE2
+static void fill32_sse2(void *dst, uint32_t value, size_t count) {
+  uint8_t *p = (uint8_t *)dst;
+  __m128i v = _mm_set1_epi32((int)value);
+  for (; count >= 16; count -= 16, p += 64) {
+    _mm_storeu_si128((__m128i *)p, v);
+    _mm_storeu_si128((__m128i *)(p + 16), v);
+    _mm_storeu_si128((__m128i *)(p + 32), v);
+    _mm_storeu_si128((__m128i *)(p + 48), v);
+  }
+  for (; count >= 4; count -= 4, p += 16)
+    _mm_storeu_si128((__m128i *)p, v);
+  fill32_c(p, value, count);
+}
+
+static void fill24_sse2(void *dst, uint8_t b0, uint8_t b1, uint8_t b2,
+                        size_t count) {
+  uint8_t pat[96];
+  pattern24(pat, b0, b1, b2);
+  __m128i v0 = _mm_loadu_si128((const __m128i *)pat);
+  __m128i v1 = _mm_loadu_si128((const __m128i *)(pat + 16));
+  __m128i v2 = _mm_loadu_si128((const __m128i *)(pat + 32));
+  uint8_t *p = (uint8_t *)dst;
+  size_t bytes = count * 3u;
+  for (; bytes >= 48; bytes -= 48, p += 48) {
+    _mm_storeu_si128((__m128i *)p, v0);
+    _mm_storeu_si128((__m128i *)(p + 16), v1);
+    _mm_storeu_si128((__m128i *)(p + 32), v2);
+  }
+  memcpy(p, pat, bytes);
+}
+
+/* Exact (x + 127) / 255 on 16-bit lanes holding x + 128. */
+static inline __m128i div255_sse2(__m128i t) {
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/* (s * a + d * (255 - a) + 127) / 255 per 16-bit lane. */
+static inline __m128i mix_sse2(__m128i s, __m128i d, __m128i a) {
+  __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv));
+  return div255_sse2(_mm_add_epi16(t, _mm_set1_epi16(128)));
+}
+
+/* Four RGBA32 pixels. The source alpha byte is replaced by 255 so the
+ * alpha lane comes out as sa + (da * (255 - sa) + 127) / 255. */
+static inline __m128i blend4_sse2(__m128i s, __m128i d) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i a = _mm_srli_epi32(s, 24);
+  a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+  s = _mm_or_si128(s, _mm_set1_epi32((int)0xFF000000u));
+  __m128i lo = mix_sse2(_mm_unpacklo_epi8(s, zero),
+                        _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(a, a));
+  __m128i hi = mix_sse2(_mm_unpackhi_epi8(s, zero),
+                        _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(a, a));
+  return _mm_packus_epi16(lo, hi);
+}
+
+static void blend_rgba32_sse2(uint8_t *dst, const uint8_t *src,
+                              size_t count) {
+  const __m128i amask = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 4; count -= 4, src += 16, dst += 16) {
+    __m128i s = _mm_loadu_si128((const __m128i *)src);
+    __m128i a = _mm_and_si128(s, amask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_setzero_si128())) == 0xFFFF)
+      continue; // transparent
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, amask)) == 0xFFFF) {
+      _mm_storeu_si128((__m128i *)dst, s); // opaque
+      continue;
+    }
+    __m128i d = _mm_loadu_si128((const __m128i *)dst);
+    _mm_storeu_si128((__m128i *)dst, blend4_sse2(s, d));
+  }
+  pix_blend_rgba32_ref(dst, src, count);
+}
+
+/* Four premultiplied pixels over dst. */
+static inline __m128i over4_sse2(__m128i s, __m128i d) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i r = _mm_set1_epi16(128);
+  __m128i a = _mm_srli_epi32(s, 24);
+  a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+  a = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                               _mm_unpacklo_epi32(a, a));
+  __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                               _mm_unpackhi_epi32(a, a));
+  lo = div255_sse2(_mm_add_epi16(lo, r));
+  hi = div255_sse2(_mm_add_epi16(hi, r));
+  return _mm_adds_epu8(s, _mm_packus_epi16(lo, hi));
+}
+
+static void blend_premul_sse2(uint8_t *dst, const uint8_t *src,
+                              size_t count) {
+  const __m128i amask = _mm_set1_epi32((int)0xFF000000u);
+  const __m128i zero = _mm_setzero_si128();
+  for (; count >= 4; count -= 4, src += 16, dst += 16) {
+    __m128i s = _mm_loadu_si128((const __m128i *)src);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF)
+      continue; // transparent
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, amask), amask)) ==
+        0xFFFF) {
+      _mm_storeu_si128((__m128i *)dst, s); // opaque
+      continue;
+    }
+    __m128i d = _mm_loadu_si128((const __m128i *)dst);
+    _mm_storeu_si128((__m128i *)dst, over4_sse2(s, d));
+  }
+  pix_blend_premul_ref(dst, src, count);
+}
+
+/* Eight pixels as 16-bit planes: channel @p shift of two RGBA32 vectors. */
+static inline __m128i plane_sse2(__m128i s0, __m128i s1, int shift) {
+  const __m128i m = _mm_set1_epi32(0xFF);
+  return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, shift), m),
+                         _mm_and_si128(_mm_srli_epi32(s1, shift), m));
+}
+
+static void blend_rgb565_sse2(uint8_t *dst, const uint8_t *src,
+                              size_t count) {
+  const __m128i m5 = _mm_set1_epi16(0x1F), m6 = _mm_set1_epi16(0x3F);
+  for (; count >= 8; count -= 8, src += 32, dst += 16) {
+    __m128i s0 = _mm_loadu_si128((const __m128i *)src);
+    __m128i s1 = _mm_loadu_si128((const __m128i *)(src + 16));
+    __m128i a = plane_sse2(s0, s1, 24);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, _mm_setzero_si128())) == 0xFFFF)
+      continue;
+    __m128i d = _mm_loadu_si128((const __m128i *)dst);
+    __m128i dr = _mm_slli_epi16(_mm_srli_epi16(d, 11), 3);
+    __m128i dg = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(d, 5), m6), 2);
+    __m128i db = _mm_slli_epi16(_mm_and_si128(d, m5), 3);
+    __m128i r = mix_sse2(plane_sse2(s0, s1, 0), dr, a);
+    __m128i g = mix_sse2(plane_sse2(s0, s1, 8), dg, a);
+    __m128i b = mix_sse2(plane_sse2(s0, s1, 16), db, a);
+    r = _mm_slli_epi16(_mm_andnot_si128(_mm_set1_epi16(7), r), 8);
+    g = _mm_slli_epi16(_mm_andnot_si128(_mm_set1_epi16(3), g), 3);
+    b = _mm_srli_epi16(b, 3);
+    _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_or_si128(r, g), b));
+  }
+  pix_blend_rgb565_ref(dst, src, count);
+}
+#endif
+
+#ifdef PIX_SIMD_AVX2
+/* RGB24 needs byte shuffles (SSSE3) to move pixels between 3- and 4-byte
+ * layouts. Loads and stores cover exactly 12 bytes, four pixels. */
+__attribute__((target("ssse3"))) static void
+blend_rgb24_ssse3(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m128i expand =
+      _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i pack =
+      _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  const __m128i amask = _mm_set1_epi32((int)0xFF000000u);
+  for (; count >= 4; count -= 4, src += 16, dst += 12) {
+    __m128i s = _mm_loadu_si128((const __m128i *)src);
+    __m128i sa = _mm_and_si128(s, amask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, _mm_setzero_si128())) == 0xFFFF)
+      continue;
+    int32_t tail;
+    memcpy(&tail, dst + 8, 4);
+    __m128i d = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)dst),
+                                   _mm_cvtsi32_si128(tail));
+    __m128i out = _mm_shuffle_epi8(
+        blend4_sse2(s, _mm_shuffle_epi8(d, expand)), pack);
+    _mm_storel_epi64((__m128i *)dst, out);
+    tail = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+    memcpy(dst + 8, &tail, 4);
+  }
+  pix_blend_rgb24_ref(dst, src, count);
+}
+
+__attribute__((target("avx2"))) static void
+fill32_avx2(void *dst, uint32_t value, size_t count) {
+  uint8_t *p = (uint8_t *)dst;
+  __m256i v = _mm256_set1_epi32((int)value);
+  for (; count >= 32; count -= 32, p += 128) {
+    _mm256_storeu_si256((__m256i *)p, v);
+    _mm256_storeu_si256((__m256i *)(p + 32), v);
+    _mm256_storeu_si256((__m256i *)(p + 64), v);
+    _mm256_storeu_si256((__m256i *)(p + 96), v);
+  }
+  for (; count >= 8; count -= 8, p += 32)
+    _mm256_storeu_si256((__m256i *)p, v);
+  _mm256_zeroupper(); // legacy-SSE tail: avoid the AVX-SSE transition stall
+  fill32_sse2(p, value, count);
+}
+
+__attribute__((target("avx2"))) static void
+fill24_avx2(void *dst, uint8_t b0, uint8_t b1, uint8_t b2, size_t count) {
+  uint8_t pat[96];
+  pattern24(pat, b0, b1, b2);
+  __m256i v0 = _mm256_loadu_si256((const __m256i *)pat);
+  __m256i v1 = _mm256_loadu_si256((const __m256i *)(pat + 32));
+  __m256i v2 = _mm256_loadu_si256((const __m256i *)(pat + 64));
+  uint8_t *p = (uint8_t *)dst;
+  size_t bytes = count * 3u;
+  for (; bytes >= 96; bytes -= 96, p += 96) {
+    _mm256_storeu_si256((__m256i *)p, v0);
+    _mm256_storeu_si256((__m256i *)(p + 32), v1);
+    _mm256_storeu_si256((__m256i *)(p + 64), v2);
+  }
+  memcpy(p, pat, bytes);
+}
+
+__attribute__((target("avx2"))) static inline __m256i mix_avx2(__m256i s,
+                                                               __m256i d,
+                                                               __m256i a) {
+  __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+  __m256i t =
+      _mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, inv));
+  t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+/* As blend_rgba32_sse2 with eight pixels per step. Unpack and pack stay
+ * within 128-bit lanes, so pixels keep their order. */
+__attribute__((target("avx2"))) static void
+blend_rgba32_avx2(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m256i amask = _mm256_set1_epi32((int)0xFF000000u);
+  const __m256i zero = _mm256_setzero_si256();
+  for (; count >= 8; count -= 8, src += 32, dst += 32) {
+    __m256i s = _mm256_loadu_si256((const __m256i *)src);
+    __m256i sa = _mm256_and_si256(s, amask);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, zero)) == -1)
+      continue;
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, amask)) == -1) {
+      _mm256_storeu_si256((__m256i *)dst, s);
+      continue;
+    }
+    __m256i d = _mm256_loadu_si256((const __m256i *)dst);
+    __m256i a = _mm256_srli_epi32(s, 24);
+    a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+    s = _mm256_or_si256(s, amask);
+    __m256i lo = mix_avx2(_mm256_unpacklo_epi8(s, zero),
+                          _mm256_unpacklo_epi8(d, zero),
+                          _mm256_unpacklo_epi32(a, a));
+    __m256i hi = mix_avx2(_mm256_unpackhi_epi8(s, zero),
+                          _mm256_unpackhi_epi8(d, zero),
+                          _mm256_unpackhi_epi32(a, a));
+    _mm256_storeu_si256((__m256i *)dst, _mm256_packus_epi16(lo, hi));
+  }
+  _mm256_zeroupper();
+  blend_rgba32_sse2(dst, src, count);
+}
+
+__attribute__((target("avx2"))) static void
+blend_premul_avx2(uint8_t *dst, const uint8_t *src, size_t count) {
+  const __m256i amask = _mm256_set1_epi32((int)0xFF000000u);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i r = _mm256_set1_epi16(128);
+  for (; count >= 8; count -= 8, src += 32, dst += 32) {
+    __m256i s = _mm256_loadu_si256((const __m256i *)src);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+      continue;
+    __m256i sa = _mm256_and_si256(s, amask);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, amask)) == -1) {
+      _mm256_storeu_si256((__m256i *)dst, s);
+      continue;
+    }
+    __m256i d = _mm256_loadu_si256((const __m256i *)dst);
+    __m256i a = _mm256_srli_epi32(s, 24);
+    a = _mm256_sub_epi16(_mm256_set1_epi16(255),
+                         _mm256_or_si256(a, _mm256_slli_epi32(a, 16)));
+    __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero),
+                                    _mm256_unpacklo_epi32(a, a));
+    __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero),
+                                    _mm256_unpackhi_epi32(a, a));
+    lo = _mm256_add_epi16(lo, r);
+    hi = _mm256_add_epi16(hi, r);
+    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+    _mm256_storeu_si256((__m256i *)dst,
+                        _mm256_adds_epu8(s, _mm256_packus_epi16(lo, hi)));
+  }
+  _mm256_zeroupper();
+  blend_premul_sse2(dst, src, count);
+}
+#endif
+
+/* -------- NEON -------- */
+#ifdef PIX_SIMD_NEON
+static void fill32_neon(void *dst, uint32_t value, size_t count) {
+  uint8_t *p = (uint8_t *)dst;
+  uint8x16_t v = vreinterpretq_u8_u32(vdupq_n_u32(value));
+  for (; count >= 16; count -= 16, p += 64) {
+    vst1q_u8(p, v);
+    vst1q_u8(p + 16, v);
+    vst1q_u8(p + 32, v);
+    vst1q_u8(p + 48, v);
+  }
+  for (; count >= 4; count -= 4, p += 16)
+    vst1q_u8(p, v);
+  fill32_c(p, value, count);
+}
+
+static void fill24_neon(void *dst, uint8_t b0, uint8_t b1, uint8_t b2,
+                        size_t count) {
+  uint8x16x3_t v = {{vdupq_n_u8(b0), vdupq_n_u8(b1), vdupq_n_u8(b2)}};
+  uint8_t *p = (uint8_t *)dst;
+  for (; count >= 16; count -= 16, p += 48)
+    vst3q_u8(p, v); // interleaves back to b0,b1,b2 triples
+  fill24_c(p, b0, b1, b2, count);
+}
+
+/* (s * a + d * (255 - a) + 127) / 255 on eight lanes. */
+static inline uint8x8_t mix_neon(uint8x8_t s, uint8x8_t d, uint8x8_t a) {
+  uint16x8_t t = vmlal_u8(vmull_u8(s, a), d, vmvn_u8(a));
+  t = vaddq_u16(t, vdupq_n_u16(128));
+  return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+static void blend_rgba32_neon(uint8_t *dst, const uint8_t *src,
+                              size_t count) {
+  for (; count >= 8; count -= 8, src += 32, dst += 32) {
+    uint8x8x4_t s = vld4_u8(src), d = vld4_u8(dst);
+    uint8x8_t a = s.val[3];
+    d.val[0] = mix_neon(s.val[0], d.val[0], a);
+    d.val[1] = mix_neon(s.val[1], d.val[1], a);
+    d.val[2] = mix_neon(s.val[2], d.val[2], a);
+    d.val[3] = mix_neon(vdup_n_u8(255), d.val[3], a);
+    vst4_u8(dst, d);
+  }
+  pix_blend_rgba32_ref(dst, src, count);
+}
+
+/* s + (d * inv + 127) / 255, saturating. */
+static inline uint8x8_t over_neon(uint8x8_t s, uint8x8_t d, uint8x8_t inv) {
+  uint16x8_t t = vaddq_u16(vmull_u8(d, inv), vdupq_n_u16(128));
+  return vqadd_u8(s, vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8));
+}
+
+static void blend_premul_neon(uint8_t *dst, const uint8_t *src,
+                              size_t count) {
+  for (; count >= 8; count -= 8, src += 32, dst += 32) {
+    uint8x8x4_t s = vld4_u8(src), d = vld4_u8(dst);
+    uint8x8_t inv = vmvn_u8(s.val[3]);
+    for (int i = 0; i < 4; ++i)
+      d.val[i] = over_neon(s.val[i], d.val[i], inv);
+    vst4_u8(dst, d);
+  }
+  pix_blend_premul_ref(dst, src, count);
+}
+
+static void blend_rgb24_neon(uint8_t *dst, const uint8_t *src, size_t count) {
+  for (; count >= 8; count -= 8, src += 32, dst += 24) {
+    uint8x8x4_t s = vld4_u8(src);
+    uint8x8x3_t d = vld3_u8(dst);
+    uint8x8_t a = s.val[3];
+    d.val[0] = mix_neon(s.val[0], d.val[0], a);
+    d.val[1] = mix_neon(s.val[1], d.val[1], a);
+    d.val[2] = mix_neon(s.val[2], d.val[2], a);
+    vst3_u8(dst, d);
+  }
+  pix_blend_rgb24_ref(dst, src, count);
+}
+
+static void blend_rgb565_neon(uint8_t *dst, const uint8_t *src,
+                              size_t count) {
+  for (; count >= 8; count -= 8, src += 32, dst += 16) {
+    uint8x8x4_t s = vld4_u8(src);
+    uint16x8_t d = vld1q_u16((const uint16_t *)(const void *)dst);
+    uint8x8_t dr = vshl_n_u8(vmovn_u16(vshrq_n_u16(d, 11)), 3);
+    uint8x8_t dg = vshl_n_u8(vmovn_u16(vshrq_n_u16(d, 5)), 2); // drops r
+    uint8x8_t db = vshl_n_u8(vmovn_u16(d), 3);                 // drops g
+    uint8x8_t a = s.val[3];
+    uint8x8_t r = mix_neon(s.val[0], dr, a);
+    uint8x8_t g = mix_neon(s.val[1], dg, a);
+    uint8x8_t b = mix_neon(s.val[2], db, a);
+    uint16x8_t out = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+    out = vorrq_u16(out, vshll_n_u8(vand_u8(g, vdup_n_u8(0xFC)), 3));
+    out = vorrq_u16(out, vmovl_u8(vshr_n_u8(b, 3)));
+    vst1q_u16((uint16_t *)(void *)dst, out);
+  }
+  pix_blend_rgb565_ref(dst, src, count);
+}
+#endif
+
+
+/* -------- Dispatch -------- */
+typedef void (*fill32_fn)(void *, uint32_t, size_t);
+typedef void (*fill24_fn)(void *, uint8_t, uint8_t, uint8_t, size_t);
+typedef void (*blend_fn)(uint8_t *, const uint8_t *, size_t);
+
+typedef struct simd_ops_t {
+  fill32_fn fill32;
+  fill24_fn fill24;
+  blend_fn blend_rgba32, blend_rgb24, blend_rgb565, blend_premul;
+} simd_ops_t;
+
+/* Resolved once, on first use. Band workers reach this concurrently, so with
+ * threads pthread_once both serializes the resolution and publishes the
+ * table before any caller reads it. */
+static simd_ops_t ops;
+#ifdef VG_ENABLE_THREADS
+static pthread_once_t ops_once = PTHREAD_ONCE_INIT;
+#else
+static bool ops_ready;
+#endif
+
+static void simd_init(void) {
+  simd_ops_t o = {fill32_c, fill24_c, pix_blend_rgba32_ref,
+                  pix_blend_rgb24_ref, pix_blend_rgb565_ref,
+                  pix_blend_premul_ref};
+#if defined(PIX_SIMD_SSE2)
+  o.fill32 = fill32_sse2;
+  o.fill24 = fill24_sse2;
+  o.blend_rgba32 = blend_rgba32_sse2;
+  o.blend_rgb565 = blend_rgb565_sse2;
+  o.blend_premul = blend_premul_sse2;
+#if defined(PIX_SIMD_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3"))
+    o.blend_rgb24 = blend_rgb24_ssse3;
+  if (__builtin_cpu_supports("avx2")) {
+    o.fill32 = fill32_avx2;
+    o.fill24 = fill24_avx2;
+    o.blend_rgba32 = blend_rgba32_avx2;
+    o.blend_premul = blend_premul_avx2;
+  }
+#endif
+#elif defined(PIX_SIMD_NEON)
+  o.fill32 = fill32_neon;
+  o.fill24 = fill24_neon;
+  o.blend_rgba32 = blend_rgba32_neon;
+  o.blend_rgb24 = blend_rgb24_neon;
+  o.blend_rgb565 = blend_rgb565_neon;
+  o.blend_premul = blend_premul_neon;
+#endif
+  ops = o;
+}
+
+static const simd_ops_t *simd(void) {
+#ifdef VG_ENABLE_THREADS
+  pthread_once(&ops_once, simd_init);
+#else
+  if (!ops_ready) {
+    simd_init();
+    ops_ready = true;
+  }
+#endif
+  return &ops;
+}
+
+/* Spans shorter than this are stored directly: most fill_span runs are a
+ * few pixels, where the indirect call costs more than the stores. */
+#define FILL_SHORT 8
+
+static inline void fill32_short(uint8_t *p, uint32_t value, size_t count) {
+  for (; count; count--, p += 4)
+    memcpy(p, &value, 4);
+}
+
+void pix_fill32(void *dst, uint32_t value, size_t count) {
+  if (count < FILL_SHORT)
+    fill32_short((uint8_t *)dst, value, count);
+  else
+    simd()->fill32(dst, value, count);
+}
+
+void pix_fill16(void *dst, uint16_t value, size_t count) {
+  // Pairs of halfwords are one 4-byte pattern whatever the alignment.
+  pix_fill32(dst, (uint32_t)value << 16 | value, count / 2);
+  if (count & 1)
+    memcpy((uint8_t *)dst + (count - 1) * 2u, &value, 2);
+}
+
+void pix_fill24(void *dst, uint8_t b0, uint8_t b1, uint8_t b2, size_t count) {
+  simd()->fill24(dst, b0, b1, b2, count);
+}
+
+void pix_blend_rgba32(uint8_t *dst, const uint8_t *src, size_t count) {
+  simd()->blend_rgba32(dst, src, count);
+}
+
+void pix_blend_rgb24(uint8_t *dst, const uint8_t *src, size_t count) {
+  simd()->blend_rgb24(dst, src, count);
+}
+
+void pix_blend_rgb565(uint8_t *dst, const uint8_t *src, size_t count) {
+  simd()->blend_rgb565(dst, src, count);
+}
+
+void pix_blend_premul(uint8_t *dst, const uint8_t *src, size_t count) {
+  simd()->blend_premul(dst, src, count);
+}
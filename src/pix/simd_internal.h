@@ -0,0 +1,67 @@
+/* Internal vector kernels (not public API).
+ *
+ * Built with PIX_ENABLE_SIMD, the kernels use SSE2, SSSE3 or AVX2 on x86
+ * (the latter two picked at run time) and NEON on ARM; without it, or on other
+ * targets, portable C. Pointers need no particular alignment.
+ */
+#pragma once
+#include <pix/pix.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* PIX_SIMD_SSE2 / PIX_SIMD_AVX2 (GCC-style x86, where SSSE3 and AVX2 code
+ * can be compiled per function and chosen at run time) / PIX_SIMD_NEON. */
+#if defined(PIX_ENABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define PIX_SIMD_SSE2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PIX_SIMD_AVX2
+#endif
+#elif defined(PIX_ENABLE_SIMD) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PIX_SIMD_NEON
+#endif
+
+/* Store @p count copies of the 4 bytes of @p value (native order). */
+void pix_fill32(void *dst, uint32_t value, size_t count);
+
+/* Store @p count copies of the 2 bytes of @p value (native order). */
+void pix_fill16(void *dst, uint16_t value, size_t count);
+
+/* Store @p count copies of the 3-byte pattern @p b0, @p b1, @p b2. */
+void pix_fill24(void *dst, uint8_t b0, uint8_t b1, uint8_t b2, size_t count);
+
+/* Src-over @p count straight-alpha RGBA32 pixels from @p src onto RGBA32,
+ * RGB24 or RGB565 pixels at @p dst, rounding (x * a + 127) / 255. */
+void pix_blend_rgba32(uint8_t *dst, const uint8_t *src, size_t count);
+void pix_blend_rgb24(uint8_t *dst, const uint8_t *src, size_t count);
+void pix_blend_rgb565(uint8_t *dst, const uint8_t *src, size_t count);
+
+/* Src-over @p count premultiplied RGBA32 pixels onto premultiplied RGBA32:
+ * every channel is s + (d * (255 - sa) + 127) / 255, saturating. */
+void pix_blend_premul(uint8_t *dst, const uint8_t *src, size_t count);
+
+/* Scalar references for the blends above; the vector kernels must match
+ * them exactly. */
+void pix_blend_rgba32_ref(uint8_t *dst, const uint8_t *src, size_t count);
+void pix_blend_rgb24_ref(uint8_t *dst, const uint8_t *src, size_t count);
+void pix_blend_rgb565_ref(uint8_t *dst, const uint8_t *src, size_t count);
+void pix_blend_premul_ref(uint8_t *dst, const uint8_t *src, size_t count);
+
+/* Row converter: @p count pixels from @p src to @p dst, no blending. Alpha
+ * is dropped, or set opaque when @p dst has it; luma is pix_luma and RGB565
+ * expands by shifting (low bits zero). */
+typedef void (*pix_convert_fn)(uint8_t *dst, const uint8_t *src,
+                               size_t count);
+
+/* Direct converter from @p src format to @p dst format (a copy when they
+ * match), or NULL when the pair has none. */
+pix_convert_fn pix_convert_row_fn(pix_format_t dst, pix_format_t src);
+
+/* Convert @p count pixels, through RGBA32 when the pair has no direct
+ * converter. Returns false when either format is unsupported. */
+bool pix_convert_row(pix_format_t dst_format, uint8_t *dst,
+                     pix_format_t src_format, const uint8_t *src,
+                     size_t count);
@@ -0,0 +1,116 @@
+// Per-frame bump allocator. See arena_internal.h.
+#include <stdint.h>
+#include <string.h>
+
+#include "arena_internal.h"
+#include <vg/vg.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_BLOCK (64 * 1024)
+
+struct vg_arena_block_t {
+  vg_arena_block_t *next;
+  size_t size; /* usable bytes */
+  size_t used;
+};
+
+static size_t arena_round(size_t n) {
+  return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static uint8_t *block_data(vg_arena_block_t *b) {
+  return (uint8_t *)b + arena_round(sizeof(vg_arena_block_t));
+}
+
+static vg_arena_block_t *block_new(size_t size) {
+  vg_arena_block_t *b = (vg_arena_block_t *)VG_MALLOC(
+      arena_round(sizeof(vg_arena_block_t)) + size);
+  if (!b)
+    return NULL;
+  b->next = NULL;
+  b->size = size;
+  b->used = 0;
+  return b;
+}
+
+void *vg__arena_alloc(vg_arena_t *a, size_t bytes) {
+  if (!a)
+    return VG_MALLOC(bytes);
+  bytes = arena_round(bytes ? bytes : 1);
+  vg_arena_block_t *b = a->head;
+  if (!b || b->size - b->used < bytes) {
+    // Blocks at least double so a frame that overflows chains few of them.
+    size_t size = a->reserve > ARENA_MIN_BLOCK ? a->reserve : ARENA_MIN_BLOCK;
+    if (b && size < b->size * 2)
+      size = b->size * 2;
+    if (size < bytes)
+      size = bytes;
+    b = block_new(size);
+    if (!b)
+      return NULL;
+    b->next = a->head;
+    a->head = b;
+  }
+  void *p = block_data(b) + b->used;
+  b->used += bytes;
+  a->used += bytes;
+  if (a->used > a->high_water)
+    a->high_water = a->used;
+  return p;
+}
+
+void *vg__arena_realloc(vg_arena_t *a, void *p, size_t old_bytes,
+                        size_t bytes) {
+  if (!a)
+    return VG_REALLOC(p, bytes);
+  if (!p)
+    return vg__arena_alloc(a, bytes);
+  vg_arena_block_t *b = a->head;
+  size_t old_size = arena_round(old_bytes ? old_bytes : 1);
+  size_t new_size = arena_round(bytes ? bytes : 1);
+  if ((uint8_t *)p + old_size == block_data(b) + b->used &&
+      b->size - (b->used - old_size) >= new_size) {
+    // Top of the current block: resize in place.
+    b->used = b->used - old_size + new_size;
+    a->used = a->used - old_size + new_size;
+    if (a->used > a->high_water)
+      a->high_water = a->used;
+    return p;
+  }
+  void *q = vg__arena_alloc(a, bytes);
+  if (q)
+    memcpy(q, p, old_bytes < bytes ? old_bytes : bytes);
+  return q;
+}
+
+void vg__arena_release(vg_arena_t *a, void *p) {
+  if (!a)
+    VG_FREE(p);
+}
+
+void vg__arena_reset(vg_arena_t *a) {
+  if (!a)
+    return;
+  if (a->head && a->head->next) {
+    // The last frame overflowed: swap the chain for one block that holds it.
+    size_t size = a->high_water;
+    vg__arena_free(a);
+    a->head = block_new(size > a->reserve ? size : a->reserve);
+  } else if (a->head) {
+    a->head->used = 0;
+  }
+  a->used = 0;
+}
+
+void vg__arena_free(vg_arena_t *a) {
+  if (!a)
+    return;
+  vg_arena_block_t *b = a->head;
+  while (b) {
+    vg_arena_block_t *next = b->next;
+    VG_FREE(b);
+    b = next;
+  }
+  a->head = NULL;
+  a->used = 0;
+}
@@ -0,0 +1,42 @@
+/* Internal bump allocator for per-frame render temporaries (not public API).
+ *
+ * Allocations are carved from a block in order and never freed one by one;
+ * vg__arena_reset hands everything back at once. When a frame needs more
+ * than the current block, further blocks are chained, and the next reset
+ * replaces the chain by one block of the high-water size, so a steady scene
+ * settles on a single block and no heap calls at all.
+ *
+ * Every function also accepts a NULL arena and then falls back to
+ * VG_MALLOC / VG_REALLOC / VG_FREE, which lets code that owns long-lived
+ * storage (cached shapes) share the allocation paths with scratch code.
+ */
+#pragma once
+#include <stddef.h>
+#include <vg/vg.h>
+
+typedef struct vg_arena_block_t vg_arena_block_t;
+
+typedef struct vg_arena_t {
+  vg_arena_block_t *head; /* block being carved (most recent first) */
+  size_t used;            /* bytes handed out since the last reset */
+  size_t high_water;      /* most bytes handed out between two resets */
+  size_t reserve;         /* minimum block size */
+} vg_arena_t;
+
+/* Allocate @p bytes, 16-byte aligned. NULL when out of memory. */
+void *vg__arena_alloc(vg_arena_t *a, size_t bytes);
+
+/* Grow or shrink @p p (of @p old_bytes) to @p bytes, keeping the contents.
+ * The most recent allocation grows in place while its block has room. On
+ * failure @p p stays valid and NULL is returned. */
+void *vg__arena_realloc(vg_arena_t *a, void *p, size_t old_bytes,
+                        size_t bytes);
+
+/* Free @p p when @p a is NULL; arena memory is only returned by reset. */
+void vg__arena_release(vg_arena_t *a, void *p);
+
+/* Invalidate every allocation and start over (see above). */
+void vg__arena_reset(vg_arena_t *a);
+
+/* Release all blocks. The arena may be used again afterwards. */
+void vg__arena_free(vg_arena_t *a);
@@ -1,7 +1,11 @@
 /* vg/canvas.c - clean, format-agnostic canvas implementation */
 #include "../pix/frame_internal.h"
+#include "arena_internal.h" /* per-frame scratch arena */
 #include "fill_internal.h"  /* internal fill */
+#include "image_internal.h" /* image sampler */
+#include "pool_internal.h"  /* internal worker pool */
 #include "shape_internal.h" /* internal shape_create/destroy */
+#include "stroke_internal.h" /* internal stroke */
 #include <math.h>
 #include <pix/pix.h>
 #include <string.h>
@@ -13,6 +17,7 @@ vg_canvas_t vg_canvas_init(size_t capacity) {
   c.capacity = capacity;
   c.shapes = NULL;
   c.next = NULL;
+  c.drawn_size = (pix_size_t){0, 0};
   if (capacity == 0)
     return c;
   c.shapes = (vg_shape_t **)VG_MALLOC(sizeof(vg_shape_t *) * capacity);
@@ -81,46 +86,79 @@ void vg_canvas_destroy(vg_canvas_t *canvas) {
   canvas->size = 0;
   canvas->capacity = 0;
   canvas->next = NULL;
+  canvas->drawn_size = (pix_size_t){0, 0};
 }
 
 /* -------- Stroke rendering (Wu AA) -------- */
 static inline float _fpart(float x) { return x - floorf(x); }
 static inline float _rfpart(float x) { return 1.f - _fpart(x); }
 
-static inline void blend_cov(pix_frame_t *f, int x, int y, pix_color_t c,
-                             float cov) {
-  if ((unsigned)x >= f->size.w || (unsigned)y >= f->size.h)
+/* Wu lines plot pixel pairs on two neighbouring rows (or columns). Plots are
+ * batched into per-row coverage runs, keyed by row parity so both halves of a
+ * pair extend their own run, and each run is handed to the frame's blend span
+ * writer in a single call. */
+#define AA_RUN_MAX 64
+
+typedef struct aa_run_t {
+  int y, x0, len;
+  uint8_t cov[AA_RUN_MAX];
+} aa_run_t;
+
+typedef struct aa_target_t {
+  pix_frame_t *frame;
+  pix_blend_span_fn blend;
+  pix_color_t color;
+  int x0, y0, x1, y1; /* inclusive clip */
+  aa_run_t run[2];
+} aa_target_t;
+
+static void aa_target_init(aa_target_t *t, pix_frame_t *f, pix_color_t c,
+                           pix_point_t clip_min, pix_point_t clip_max) {
+  t->frame = f;
+  t->blend = pix_frame_blend_span_fn(f->format);
+  t->color = c;
+  t->x0 = clip_min.x;
+  t->y0 = clip_min.y;
+  t->x1 = clip_max.x;
+  t->y1 = clip_max.y;
+  t->run[0].len = 0;
+  t->run[1].len = 0;
+}
+
+static void aa_run_flush(aa_target_t *t, aa_run_t *r) {
+  if (r->len && t->blend)
+    t->blend(t->frame, (int16_t)r->y, (int16_t)r->x0, r->cov,
+             (uint16_t)r->len, t->color);
+  r->len = 0;
+}
+
+static void aa_target_flush(aa_target_t *t) {
+  aa_run_flush(t, &t->run[0]);
+  aa_run_flush(t, &t->run[1]);
+}
+
+static void plot_aa(aa_target_t *t, int x, int y, float cov) {
+  if (x < t->x0 || x > t->x1 || y < t->y0 || y > t->y1)
     return;
   if (cov <= 0.f)
     return;
   if (cov > 1.f)
     cov = 1.f;
-  uint8_t sa = (uint8_t)(c >> 24);
-  if (sa == 0)
+  uint8_t c8 = (uint8_t)(cov * 255.f + 0.5f);
+  if (!c8)
     return;
-  uint8_t sr = (c >> 16) & 0xFF, sg = (c >> 8) & 0xFF, sb = c & 0xFF;
-  float a = (sa / 255.f) * cov;
-  pix_color_t dstc =
-      pix_frame_get_pixel(f, (pix_point_t){(int16_t)x, (int16_t)y});
-  uint8_t da = (dstc >> 24) & 0xFF, dr = (dstc >> 16) & 0xFF,
-          dg = (dstc >> 8) & 0xFF, db = dstc & 0xFF;
-  float fa = a + (1.f - a) * (da / 255.f);
-  float inv = (1.f - a);
-  uint8_t or = (uint8_t)fminf(255.f, sr * a + dr * inv);
-  uint8_t og = (uint8_t)fminf(255.f, sg * a + dg * inv);
-  uint8_t ob = (uint8_t)fminf(255.f, sb * a + db * inv);
-  uint8_t oa = (uint8_t)fminf(255.f, fa * 255.f);
-  pix_color_t out = ((pix_color_t)oa << 24) | ((pix_color_t)or << 16) |
-                    ((pix_color_t)og << 8) | (pix_color_t)ob;
-  pix_frame_set_pixel(f, (pix_point_t){(int16_t)x, (int16_t)y}, out);
-}
-
-static void plot_aa(pix_frame_t *f, int x, int y, pix_color_t c, float cov) {
-  blend_cov(f, x, y, c, cov);
-}
-
-static void draw_line_aa(pix_frame_t *f, float x0, float y0, float x1, float y1,
-                         pix_color_t c) {
+  aa_run_t *r = &t->run[y & 1];
+  if (r->len && (r->y != y || r->x0 + r->len != x || r->len == AA_RUN_MAX))
+    aa_run_flush(t, r);
+  if (!r->len) {
+    r->y = y;
+    r->x0 = x;
+  }
+  r->cov[r->len++] = c8;
+}
+
+static void draw_line_aa(aa_target_t *f, float x0, float y0, float x1,
+                         float y1) {
   bool steep = fabsf(y1 - y0) > fabsf(x1 - x0);
   if (steep) {
     float t = x0;
@@ -146,11 +184,11 @@ static void draw_line_aa(pix_frame_t *f, float x0, float y0, float x1, float y1,
   int xpxl1 = (int)xend;
   int ypxl1 = (int)floorf(yend);
   if (steep) {
-    plot_aa(f, ypxl1, xpxl1, c, _rfpart(yend) * xgap);
-    plot_aa(f, ypxl1 + 1, xpxl1, c, _fpart(yend) * xgap);
+    plot_aa(f, ypxl1, xpxl1, _rfpart(yend) * xgap);
+    plot_aa(f, ypxl1 + 1, xpxl1, _fpart(yend) * xgap);
   } else {
-    plot_aa(f, xpxl1, ypxl1, c, _rfpart(yend) * xgap);
-    plot_aa(f, xpxl1, ypxl1 + 1, c, _fpart(yend) * xgap);
+    plot_aa(f, xpxl1, ypxl1, _rfpart(yend) * xgap);
+    plot_aa(f, xpxl1, ypxl1 + 1, _fpart(yend) * xgap);
   }
   float intery = yend + grad;
   xend = floorf(x1 + 0.5f);
@@ -160,24 +198,27 @@ static void draw_line_aa(pix_frame_t *f, float x0, float y0, float x1, float y1,
   int ypxl2 = (int)floorf(yend);
   if (steep) {
     for (int x = xpxl1 + 1; x < xpxl2; ++x) {
-      plot_aa(f, (int)floorf(intery), x, c, _rfpart(intery));
-      plot_aa(f, (int)floorf(intery) + 1, x, c, _fpart(intery));
+      plot_aa(f, (int)floorf(intery), x, _rfpart(intery));
+      plot_aa(f, (int)floorf(intery) + 1, x, _fpart(intery));
       intery += grad;
     }
-    plot_aa(f, ypxl2, xpxl2, c, _rfpart(yend) * xgap);
-    plot_aa(f, ypxl2 + 1, xpxl2, c, _fpart(yend) * xgap);
+    plot_aa(f, ypxl2, xpxl2, _rfpart(yend) * xgap);
+    plot_aa(f, ypxl2 + 1, xpxl2, _fpart(yend) * xgap);
   } else {
     for (int x = xpxl1 + 1; x < xpxl2; ++x) {
-      plot_aa(f, x, (int)floorf(intery), c, _rfpart(intery));
-      plot_aa(f, x, (int)floorf(intery) + 1, c, _fpart(intery));
+      plot_aa(f, x, (int)floorf(intery), _rfpart(intery));
+      plot_aa(f, x, (int)floorf(intery) + 1, _fpart(intery));
       intery += grad;
     }
-    plot_aa(f, xpxl2, ypxl2, c, _rfpart(yend) * xgap);
-    plot_aa(f, xpxl2, ypxl2 + 1, c, _fpart(yend) * xgap);
+    plot_aa(f, xpxl2, ypxl2, _rfpart(yend) * xgap);
+    plot_aa(f, xpxl2, ypxl2 + 1, _fpart(yend) * xgap);
   }
 }
 
 /* -------- Image blitting -------- */
+/* Image blits write inside the clip rectangle only; each destination pixel
+ * depends on nothing but its own position, so clipped blits match full
+ * ones. */
 static bool vg_transform_inverse_affine(const vg_transform_t *in,
                                         vg_transform_t *out) {
   float a = in->m[0][0], b = in->m[0][1], tx = in->m[0][2];
@@ -198,249 +239,862 @@ static bool vg_transform_inverse_affine(const vg_transform_t *in,
   return true;
 }
 
-static void blit_scaled_contain(pix_frame_t *dst, const vg_image_ref_t *img,
-                                const pix_frame_t *srcf, pix_size_t src_full) {
-  int sw = src_full.w, sh = src_full.h;
-  int dw_max = dst->size.w, dh_max = dst->size.h;
-  float sx = (float)dw_max / (float)sw;
-  float sy = (float)dh_max / (float)sh;
+static void blit_copy_rows(pix_frame_t *dst, const vg_image_ref_t *img,
+                           const pix_frame_t *srcf, pix_size_t src_full,
+                           const vg_bounds_t *clip) {
+  if (!dst->copy)
+    return;
+  pix_point_t dst_origin = img->dst_origin, src_origin = img->src_origin;
+  int top = dst_origin.y, bottom = dst_origin.y + (int)src_full.h - 1;
+  int left = dst_origin.x, right = dst_origin.x + (int)src_full.w - 1;
+  if (top < clip->y0) {
+    src_origin.y = (int16_t)(src_origin.y + (clip->y0 - top));
+    dst_origin.y = (int16_t)clip->y0;
+    top = clip->y0;
+  }
+  if (left < clip->x0) {
+    src_origin.x = (int16_t)(src_origin.x + (clip->x0 - left));
+    dst_origin.x = (int16_t)clip->x0;
+    left = clip->x0;
+  }
+  if (bottom > clip->y1)
+    bottom = clip->y1;
+  if (right > clip->x1)
+    right = clip->x1;
+  if (top > bottom || left > right)
+    return;
+  src_full.h = (uint16_t)(bottom - top + 1);
+  src_full.w = (uint16_t)(right - left + 1);
+  dst->copy(dst, dst_origin, (pix_frame_t *)srcf, src_origin, src_full,
+            (pix_blit_flags_t)img->flags);
+}
+
+/* Floor / ceiling of a / b for b > 0. */
+static inline int64_t fix_div_floor(int64_t a, int64_t b) {
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static inline int64_t fix_div_ceil(int64_t a, int64_t b) {
+  return -fix_div_floor(-a, b);
+}
+
+/* Clip [*x0, *x1) to the pixels x with 0 <= u0 + x * du < limit; false
+ * when none remain. */
+static bool span_range(int64_t u0, int64_t du, int64_t limit, int *x0,
+                       int *x1) {
+  int64_t lo, hi;
+  if (du > 0) {
+    lo = fix_div_ceil(-u0, du);
+    hi = fix_div_ceil(limit - u0, du);
+  } else if (du < 0) {
+    lo = fix_div_floor(u0 - limit, -du) + 1;
+    hi = fix_div_floor(u0, -du) + 1;
+  } else {
+    if (u0 < 0 || u0 >= limit)
+      return false;
+    return *x0 < *x1;
+  }
+  if (lo > *x0)
+    *x0 = lo > *x1 ? *x1 : (int)lo;
+  if (hi < *x1)
+    *x1 = hi < *x0 ? *x0 : (int)hi;
+  return *x0 < *x1;
+}
+
+/* Whether an untransformed image shape is scaled to fit @p frame: drawn at
+ * the origin, in the frame's format, from a rectangle of another size. */
+static bool image_fits_frame(const vg_image_ref_t *img, pix_size_t src_full,
+                             const pix_frame_t *frame) {
+  return img->dst_origin.x == 0 && img->dst_origin.y == 0 &&
+         (src_full.w != frame->size.w || src_full.h != frame->size.h) &&
+         img->frame->format == frame->format;
+}
+
+/* Destination rectangle of blit_scaled_contain: @p src scaled uniformly to
+ * the largest size inside @p frame, centered. */
+static void contain_rect(pix_size_t frame, pix_size_t src, int *x0, int *y0,
+                         int *w, int *h) {
+  float sx = (float)frame.w / (float)src.w;
+  float sy = (float)frame.h / (float)src.h;
   float s = sx < sy ? sx : sy;
   if (s <= 0.f)
     s = 1.f;
-  int dw = (int)lroundf(sw * s);
-  if (dw < 1)
-    dw = 1;
-  int dh = (int)lroundf(sh * s);
-  if (dh < 1)
-    dh = 1;
-  int dx0 = (dw_max - dw) / 2;
-  int dy0 = (dh_max - dh) / 2;
-  for (int y = 0; y < dh; ++y) {
-    int syi = (int)((float)y / dh * sh);
-    if (syi >= sh)
-      syi = sh - 1;
-    for (int x = 0; x < dw; ++x) {
-      int sxi = (int)((float)x / dw * sw);
-      if (sxi >= sw)
-        sxi = sw - 1;
-      pix_color_t c = pix_frame_get_pixel(
-          srcf, (pix_point_t){(int16_t)(img->src_origin.x + sxi),
-                              (int16_t)(img->src_origin.y + syi)});
-      pix_frame_set_pixel(
-          dst, (pix_point_t){(int16_t)(dx0 + x), (int16_t)(dy0 + y)}, c);
-    }
+  *w = (int)lroundf(src.w * s);
+  if (*w < 1)
+    *w = 1;
+  *h = (int)lroundf(src.h * s);
+  if (*h < 1)
+    *h = 1;
+  *x0 = (frame.w - *w) / 2;
+  *y0 = (frame.h - *h) / 2;
+}
+
+/* Source texels per destination pixel along u and v for the inverse
+ * transform @p inv. */
+static void inv_footprint(const vg_transform_t *inv, double *fu, double *fv) {
+  double m00 = inv->m[0][0], m01 = inv->m[0][1];
+  double m10 = inv->m[1][0], m11 = inv->m[1][1];
+  *fu = sqrt(m00 * m00 + m01 * m01);
+  *fv = sqrt(m10 * m10 + m11 * m11);
+}
+
+/* Mip level for a blit whose pixels span @p fu x @p fv source texels: the
+ * deepest whose texels are no larger than a pixel along the more reduced
+ * axis, or along the less reduced one for area sampling, which averages
+ * the rest. */
+static int mip_level(const vg_image_ref_t *img, double fu, double fv) {
+  bool area = img->sampling == VG_IMAGE_AREA;
+  double f = (fu > fv) != area ? fu : fv;
+  int k = 0;
+  for (; k < VG_IMAGE_MIP_MAX && f >= 2.0; f *= 0.5)
+    ++k;
+  return k;
+}
+
+/* Rectangle to sample for level @p k: the shape's own, or the deepest built
+ * mip level up to @p k. */
+static const pix_frame_t *mip_source(const vg_image_ref_t *img,
+                                     pix_size_t src_full, int k,
+                                     pix_point_t *origin, pix_size_t *size) {
+  if (img->mips && k > img->mips->count)
+    k = img->mips->count;
+  if (!img->mips || k == 0) {
+    *origin = img->src_origin;
+    *size = src_full;
+    return img->frame;
   }
+  const pix_frame_t *level = img->mips->level[k - 1];
+  *origin = (pix_point_t){0, 0};
+  *size = level->size;
+  return level;
 }
 
-static void blit_transformed(pix_frame_t *dst, const vg_image_ref_t *img,
-                             const pix_frame_t *srcf, pix_size_t src_full,
-                             const vg_transform_t *xf) {
-  bool axis = fabsf(xf->m[0][1]) < 1e-6f && fabsf(xf->m[1][0]) < 1e-6f;
-  if (axis) {
-    float sx = xf->m[0][0], sy = xf->m[1][1];
-    float tx = xf->m[0][2], ty = xf->m[1][2];
-    if (fabsf(sx) < 1e-12f || fabsf(sy) < 1e-12f)
-      return;
-    int sw = src_full.w, sh = src_full.h;
-    int dx0 = (int)floorf((float)img->dst_origin.x * sx + tx);
-    int dy0 = (int)floorf((float)img->dst_origin.y * sy + ty);
-    int dx1 = (int)ceilf((float)(img->dst_origin.x + sw) * sx + tx);
-    int dy1 = (int)ceilf((float)(img->dst_origin.y + sh) * sy + ty);
-    if (dx0 > dx1) {
-      int t = dx0;
-      dx0 = dx1;
-      dx1 = t;
-    }
-    if (dy0 > dy1) {
-      int t = dy0;
-      dy0 = dy1;
-      dy1 = t;
-    }
-    if (dx0 < 0)
-      dx0 = 0;
-    if (dy0 < 0)
-      dy0 = 0;
-    if (dx1 > (int)dst->size.w)
-      dx1 = (int)dst->size.w;
-    if (dy1 > (int)dst->size.h)
-      dy1 = (int)dst->size.h;
-    if (dx0 >= dx1 || dy0 >= dy1)
-      return;
-    float inv_sx = 1.f / sx, inv_sy = 1.f / sy;
-    for (int y = dy0; y < dy1; ++y) {
-      float syf = ((float)y - ty) * inv_sy - (float)img->dst_origin.y;
-      int syi = (int)floorf(syf);
-      if (syi < 0 || syi >= sh)
-        continue;
-      for (int x = dx0; x < dx1; ++x) {
-        float sxf = ((float)x - tx) * inv_sx - (float)img->dst_origin.x;
-        int sxi = (int)floorf(sxf);
-        if (sxi < 0 || sxi >= sw)
-          continue;
-        pix_color_t c = pix_frame_get_pixel(
-            srcf, (pix_point_t){(int16_t)(img->src_origin.x + sxi),
-                                (int16_t)(img->src_origin.y + syi)});
-        pix_frame_set_pixel(dst, (pix_point_t){(int16_t)x, (int16_t)y}, c);
-      }
-    }
+static void blit_scaled_contain(pix_frame_t *dst, const vg_image_ref_t *img,
+                                pix_size_t src_full, const vg_bounds_t *clip) {
+  int dx0, dy0, dw, dh;
+  contain_rect(dst->size, src_full, &dx0, &dy0, &dw, &dh);
+  int ya = clip->y0 > dy0 ? clip->y0 : dy0;
+  int yb = clip->y1 < dy0 + dh - 1 ? clip->y1 : dy0 + dh - 1;
+  int xa = clip->x0 > dx0 ? clip->x0 : dx0;
+  int xb = clip->x1 < dx0 + dw - 1 ? clip->x1 : dx0 + dw - 1;
+  if (xa > xb || ya > yb)
     return;
+  pix_point_t origin;
+  pix_size_t size;
+  const pix_frame_t *srcf = mip_source(
+      img, src_full,
+      mip_level(img, (double)src_full.w / dw, (double)src_full.h / dh),
+      &origin, &size);
+  vg_sampler_t smp;
+  if (!vg__sampler_init(&smp, srcf, origin, size, img->sampling, img->flags))
+    return;
+  // Pixel centers map to source positions (x - dx0 + 0.5) * sw / dw.
+  int sw = size.w, sh = size.h;
+  int64_t du = ((int64_t)sw << VG_FIX_SHIFT) / dw;
+  int64_t fv = ((int64_t)sh << VG_FIX_SHIFT) / dh;
+  int64_t u0 = ((int64_t)(1 - 2 * dx0) * sw << VG_FIX_SHIFT) / (2 * dw);
+  for (int y = ya; y <= yb; ++y) {
+    int64_t v = ((int64_t)(2 * (y - dy0) + 1) * sh << VG_FIX_SHIFT) / (2 * dh);
+    vg__sampler_span(&smp, dst, y, xa, xb + 1, u0, v, du, 0, du, fv);
   }
+}
+
+static void blit_transformed(pix_frame_t *dst, const vg_image_ref_t *img,
+                             pix_size_t src_full, const vg_transform_t *xf,
+                             const vg_bounds_t *clip) {
+  bool axis = fabsf(xf->m[0][1]) < 1e-6f && fabsf(xf->m[1][0]) < 1e-6f;
   vg_transform_t inv;
   if (!vg_transform_inverse_affine(xf, &inv)) {
-    if (dst->copy) {
-      dst->copy(dst, img->dst_origin, (pix_frame_t *)srcf, img->src_origin,
-                src_full, (pix_blit_flags_t)img->flags);
-    }
+    if (!axis) // a zero axis scale draws nothing
+      blit_copy_rows(dst, img, img->frame, src_full, clip);
     return;
   }
-  float x0 = (float)img->dst_origin.x, y0 = (float)img->dst_origin.y;
-  float x1 = x0 + src_full.w, y1 = y0 + src_full.h;
-  float cx[4], cy[4];
-  vg_transform_point(xf, x0, y0, &cx[0], &cy[0]);
-  vg_transform_point(xf, x1, y0, &cx[1], &cy[1]);
-  vg_transform_point(xf, x1, y1, &cx[2], &cy[2]);
-  vg_transform_point(xf, x0, y1, &cx[3], &cy[3]);
-  float minx = cx[0], maxx = cx[0], miny = cy[0], maxy = cy[0];
+  double fu, fv;
+  inv_footprint(&inv, &fu, &fv);
+  pix_point_t origin;
+  pix_size_t size;
+  const pix_frame_t *srcf =
+      mip_source(img, src_full, mip_level(img, fu, fv), &origin, &size);
+  vg_sampler_t smp;
+  if (!vg__sampler_init(&smp, srcf, origin, size, img->sampling, img->flags))
+    return;
+  // Source position of a destination pixel center, in texels of the source
+  // rectangle: u = inv.m00 * x + inv.m01 * y + ou (likewise v), plus half a
+  // pixel on x and y. Along a row u and v step by the first column of inv.
+  // A mip level rescales the rectangle's texel grid to its own size.
+  double rx = (double)size.w / src_full.w, ry = (double)size.h / src_full.h;
+  double m00 = inv.m[0][0] * rx, m01 = inv.m[0][1] * rx;
+  double m10 = inv.m[1][0] * ry, m11 = inv.m[1][1] * ry;
+  double ou = (inv.m[0][2] - img->dst_origin.x) * rx + 0.5 * (m00 + m01);
+  double ov = (inv.m[1][2] - img->dst_origin.y) * ry + 0.5 * (m10 + m11);
+  const double one = (double)VG_FIX_ONE;
+  int64_t du = llround(m00 * one), dv = llround(m10 * one);
+  int64_t fu_fix = llround(fu * rx * one), fv_fix = llround(fv * ry * one);
+  int64_t w = (int64_t)size.w << VG_FIX_SHIFT;
+  int64_t h = (int64_t)size.h << VG_FIX_SHIFT;
+  // Rows the transformed rectangle can reach.
+  float x0 = (float)img->dst_origin.x, fy0 = (float)img->dst_origin.y;
+  float x1 = x0 + src_full.w, fy1 = fy0 + src_full.h;
+  float cy[4], cx;
+  vg_transform_point(xf, x0, fy0, &cx, &cy[0]);
+  vg_transform_point(xf, x1, fy0, &cx, &cy[1]);
+  vg_transform_point(xf, x1, fy1, &cx, &cy[2]);
+  vg_transform_point(xf, x0, fy1, &cx, &cy[3]);
+  float miny = cy[0], maxy = cy[0];
   for (int i = 1; i < 4; ++i) {
-    if (cx[i] < minx)
-      minx = cx[i];
-    if (cx[i] > maxx)
-      maxx = cx[i];
     if (cy[i] < miny)
       miny = cy[i];
     if (cy[i] > maxy)
       maxy = cy[i];
   }
-  int ix0 = (int)floorf(minx);
-  if (ix0 < 0)
-    ix0 = 0;
   int iy0 = (int)floorf(miny);
-  if (iy0 < 0)
-    iy0 = 0;
-  int ix1 = (int)ceilf(maxx);
-  if (ix1 > (int)dst->size.w)
-    ix1 = dst->size.w;
+  if (iy0 < clip->y0)
+    iy0 = clip->y0;
   int iy1 = (int)ceilf(maxy);
-  if (iy1 > (int)dst->size.h)
-    iy1 = dst->size.h;
-  int sw = src_full.w, sh = src_full.h;
+  if (iy1 > clip->y1 + 1)
+    iy1 = clip->y1 + 1;
+  // Each row meets the source in one interval: the pixels where u lies in
+  // [0, w) intersected with those where v lies in [0, h). Both bounds are
+  // solved exactly on the fixed-point steps the sampler takes, so the span
+  // holds every inside pixel and nothing else.
   for (int y = iy0; y < iy1; ++y) {
-    for (int x = ix0; x < ix1; ++x) {
-      float ux, uy;
-      vg_transform_point(&inv, (float)x, (float)y, &ux, &uy);
-      float sx_f = ux - (float)img->dst_origin.x;
-      float sy_f = uy - (float)img->dst_origin.y;
-      if (sx_f < 0.f || sy_f < 0.f || sx_f >= (float)sw || sy_f >= (float)sh)
-        continue;
-      int sxi = (int)sx_f, syi = (int)sy_f;
-      pix_color_t c = pix_frame_get_pixel(
-          srcf, (pix_point_t){(int16_t)(img->src_origin.x + sxi),
-                              (int16_t)(img->src_origin.y + syi)});
-      pix_frame_set_pixel(dst, (pix_point_t){(int16_t)x, (int16_t)y}, c);
-    }
+    int64_t u0 = llround((m01 * y + ou) * one);
+    int64_t v0 = llround((m11 * y + ov) * one);
+    int sx0 = clip->x0, sx1 = clip->x1 + 1;
+    if (span_range(u0, du, w, &sx0, &sx1) &&
+        span_range(v0, dv, h, &sx0, &sx1))
+      vg__sampler_span(&smp, dst, y, sx0, sx1, u0, v0, du, dv, fu_fix,
+                       fv_fix);
   }
 }
 
+/* Build the mip levels an image shape samples when drawn into @p frame.
+ * Called from shape_device_bounds, which every render path runs on one
+ * thread before drawing, so parallel bands only read the levels. */
+static void image_prepare(vg_shape_t *shape, const pix_frame_t *frame) {
+  vg_image_ref_t *img = &shape->data.img;
+  if (!img->mips || !img->frame)
+    return;
+  pix_size_t src_full = img->src_size.w ? img->src_size : img->frame->size;
+  double fu, fv;
+  vg_transform_t inv;
+  if (shape->transform) {
+    if (!vg_transform_inverse_affine(shape->transform, &inv))
+      return;
+    inv_footprint(&inv, &fu, &fv);
+  } else if (image_fits_frame(img, src_full, frame)) {
+    int dx0, dy0, dw, dh;
+    contain_rect(frame->size, src_full, &dx0, &dy0, &dw, &dh);
+    fu = (double)src_full.w / dw;
+    fv = (double)src_full.h / dh;
+  } else {
+    return;
+  }
+  int k = mip_level(img, fu, fv);
+  if (k > img->mips->count)
+    vg__image_mips_build(img->mips, img->frame, img->src_origin, src_full,
+                         k);
+}
+
+/* -------- Device bounds -------- */
+/* Conservative pixel rectangle @p shape may touch in @p frame, clamped to
+ * it; false if the shape draws nothing there. Builds on the shape's cached
+ * geometry bounds, plus one pixel for AA coverage. @p clipped (optional)
+ * tells whether the clamp cut anything off. Visible image shapes also get
+ * their mip levels here (image_prepare). */
+static bool shape_device_bounds(vg_shape_t *shape, const pix_frame_t *frame,
+                                vg_bounds_t *out, bool *clipped) {
+  vg_boundsf_t b;
+  if (shape->kind == VG_SHAPE_PATH &&
+      vg_shape_get_fill_color(shape) == PIX_COLOR_NONE &&
+      (vg_shape_get_stroke_color(shape) == PIX_COLOR_NONE ||
+       vg_shape_get_stroke_width(shape) <= 0.f))
+    return false;
+  if (!vg__shape_bounds(shape, &b))
+    return false;
+  if (shape->kind == VG_SHAPE_IMAGE && !shape->transform &&
+      shape->data.img.dst_origin.x == 0 && shape->data.img.dst_origin.y == 0 &&
+      (b.x1 != frame->size.w || b.y1 != frame->size.h)) {
+    // Possibly scaled to fit (blit_scaled_contain): anywhere in the frame.
+    b.x1 = frame->size.w;
+    b.y1 = frame->size.h;
+  }
+  float minx = floorf(b.x0 - 1.f), miny = floorf(b.y0 - 1.f);
+  float maxx = ceilf(b.x1 + 1.f), maxy = ceilf(b.y1 + 1.f);
+  float w = frame->size.w - 1, h = frame->size.h - 1;
+  if (maxx < 0.f || maxy < 0.f || minx > w || miny > h)
+    return false;
+  out->x0 = minx < 0.f ? 0 : (int)minx;
+  out->y0 = miny < 0.f ? 0 : (int)miny;
+  out->x1 = maxx > w ? (int)w : (int)maxx;
+  out->y1 = maxy > h ? (int)h : (int)maxy;
+  if (clipped)
+    *clipped = minx < 0.f || miny < 0.f || maxx > w || maxy > h;
+  if (shape->kind == VG_SHAPE_IMAGE)
+    image_prepare(shape, frame);
+  return true;
+}
+
+static bool bounds_overlap(const vg_bounds_t *a, const vg_bounds_t *b) {
+  return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+static vg_bounds_t bounds_intersect(const vg_bounds_t *a,
+                                    const vg_bounds_t *b) {
+  vg_bounds_t r;
+  r.x0 = a->x0 > b->x0 ? a->x0 : b->x0;
+  r.y0 = a->y0 > b->y0 ? a->y0 : b->y0;
+  r.x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+  r.y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+  return r;
+}
+
 /* -------- Render loop -------- */
-void vg_canvas_render(const vg_canvas_t *canvas, pix_frame_t *frame) {
-  if (!canvas || !frame)
+/* Storage reused across the shapes of one render (or one band): the sweep
+ * scratch plus edge tables for shapes that are not cached. */
+typedef struct render_scratch_t {
+  vg_fill_scratch_t sweep;
+  vg_fill_t fill;
+  vg_stroke_t stroke;
+} render_scratch_t;
+
+/* Point every table of @p rs at @p arena, dropping what it held. */
+static void render_scratch_init(render_scratch_t *rs, vg_arena_t *arena) {
+  memset(rs, 0, sizeof(*rs));
+  rs->sweep.raster.arena = arena;
+  rs->sweep.scan.arena = arena;
+  rs->fill.raster.arena = arena;
+  rs->fill.scan.arena = arena;
+  rs->stroke.raster.arena = arena;
+}
+
+/* A render context keeps one arena per thread slot (see vg__pool_run).
+ * Each render resets the arenas it uses, so temporaries live for one frame
+ * and, once the arenas have grown to the scene, cost no heap calls. */
+typedef struct render_slot_t {
+  vg_arena_t arena;
+  render_scratch_t rs;
+} render_slot_t;
+
+struct vg_render_ctx_t {
+  render_slot_t *slots;
+  size_t count;
+  size_t reserve;          /* initial arena block size */
+  vg_render_stats_t stats; /* of the last render */
+};
+
+vg_render_ctx_t *vg_render_ctx_create(size_t reserve) {
+  vg_render_ctx_t *ctx = (vg_render_ctx_t *)VG_MALLOC(sizeof(vg_render_ctx_t));
+  if (!ctx)
+    return NULL;
+  ctx->slots = NULL;
+  ctx->count = 0;
+  ctx->reserve = reserve;
+  memset(&ctx->stats, 0, sizeof(ctx->stats));
+  return ctx;
+}
+
+static void render_ctx_release(vg_render_ctx_t *ctx) {
+  for (size_t i = 0; i < ctx->count; ++i)
+    vg__arena_free(&ctx->slots[i].arena);
+  VG_FREE(ctx->slots);
+  ctx->slots = NULL;
+  ctx->count = 0;
+}
+
+void vg_render_ctx_destroy(vg_render_ctx_t *ctx) {
+  if (!ctx)
     return;
-  for (vg_canvas_t *chunk = (vg_canvas_t *)canvas; chunk; chunk = chunk->next) {
-    for (size_t i = 0; i < chunk->size; ++i) {
-      vg_shape_t *shape = chunk->shapes[i];
-      if (!shape)
-        continue;
-      if (shape->kind == VG_SHAPE_PATH) {
-        if (vg_shape_get_fill_color(shape) != PIX_COLOR_NONE) {
-          vg_fill_path(vg_shape_path(shape), vg_shape_get_transform(shape),
-                       frame, vg_shape_get_fill_color(shape),
-                       vg_shape_get_fill_rule(shape));
+  render_ctx_release(ctx);
+  VG_FREE(ctx);
+}
+
+size_t vg_render_ctx_high_water(const vg_render_ctx_t *ctx) {
+  size_t total = 0;
+  for (size_t i = 0; ctx && i < ctx->count; ++i)
+    total += ctx->slots[i].arena.high_water;
+  return total;
+}
+
+void vg_render_ctx_stats(const vg_render_ctx_t *ctx, vg_render_stats_t *stats) {
+  if (!stats)
+    return;
+  if (ctx)
+    *stats = ctx->stats;
+  else
+    memset(stats, 0, sizeof(*stats));
+}
+
+static void render_stats_count(vg_render_stats_t *stats, bool visible,
+                               bool clipped) {
+  stats->shapes++;
+  if (!visible)
+    stats->culled++;
+  else if (clipped)
+    stats->clipped++;
+  else
+    stats->inside++;
+}
+
+/* Start a frame on the first @p n slots. Returns false when out of memory. */
+static bool render_ctx_begin(vg_render_ctx_t *ctx, size_t n) {
+  if (n > ctx->count) {
+    render_slot_t *slots = (render_slot_t *)VG_REALLOC(
+        ctx->slots, n * sizeof(render_slot_t));
+    if (!slots)
+      return false;
+    // Slots hold pointers to their own arena, so a moved array is re-aimed
+    // by the loop below.
+    for (size_t i = ctx->count; i < n; ++i) {
+      memset(&slots[i].arena, 0, sizeof(vg_arena_t));
+      slots[i].arena.reserve = ctx->reserve;
+    }
+    ctx->slots = slots;
+    ctx->count = n;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    vg__arena_reset(&ctx->slots[i].arena);
+    render_scratch_init(&ctx->slots[i].rs, &ctx->slots[i].arena);
+  }
+  memset(&ctx->stats, 0, sizeof(ctx->stats));
+  return true;
+}
+
+static int16_t round_coord(float v) {
+  if (v < (float)INT16_MIN)
+    return INT16_MIN;
+  if (v > (float)INT16_MAX)
+    return INT16_MAX;
+  return (int16_t)lrintf(v);
+}
+
+/* Hand a hairline stroke to the backend's accelerated draw_line, one call
+ * per segment with endpoints rounded to pixels. */
+static void hairlines_to_backend(pix_frame_t *frame, const vg_path_t *seg,
+                                 const vg_transform_t *xf, pix_color_t color) {
+  for (; seg; seg = seg->next) {
+    pix_point_t prev = {0, 0};
+    for (size_t i = 0; i < seg->size; ++i) {
+      float x = seg->points[i].x, y = seg->points[i].y;
+      if (xf) {
+        float tx = xf->m[0][0] * x + xf->m[0][1] * y + xf->m[0][2];
+        float ty = xf->m[1][0] * x + xf->m[1][1] * y + xf->m[1][2];
+        x = tx;
+        y = ty;
+      }
+      pix_point_t pt = {round_coord(x), round_coord(y)};
+      if (i)
+        frame->draw_line(frame, prev, pt, color);
+      prev = pt;
+    }
+  }
+}
+
+static bool stroke_style_equal(const vg_stroke_style_t *a,
+                               const vg_stroke_style_t *b) {
+  return a->width == b->width && a->cap == b->cap && a->join == b->join &&
+         a->miter_limit == b->miter_limit;
+}
+
+/* Draw one shape (fill then stroke, or image) into the @p clip rectangle of
+ * @p frame (inclusive, inside the frame). Pixels inside the clip come out
+ * exactly as in a full-frame render, which is what lets bands render
+ * concurrently and damaged regions be redrawn alone. @p cached lets cached
+ * shapes use their retained tables, which are built for one clip, so it is
+ * only set when @p clip is the shape's whole bounds. @p backend_lines lets
+ * hairlines go to an accelerated frame->draw_line, which does not clip and
+ * is queued per render; only vg_canvas_render sets it, since a damage render
+ * must leave the frame as a full render would. */
+static void vg__render_shape(vg_shape_t *shape, pix_frame_t *frame,
+                             const vg_bounds_t *clip, render_scratch_t *rs,
+                             bool cached, bool backend_lines) {
+  pix_point_t clip_min = {(int16_t)clip->x0, (int16_t)clip->y0};
+  pix_point_t clip_max = {(int16_t)clip->x1, (int16_t)clip->y1};
+  if (shape->kind == VG_SHAPE_PATH) {
+    vg_shape_cache_t *cache =
+        cached ? vg__shape_cache_sync(shape, frame->size) : NULL;
+    if (vg_shape_get_fill_color(shape) != PIX_COLOR_NONE) {
+      vg_fill_quality_t quality = vg_shape_get_fill_quality(shape);
+      vg_fill_t *fill = &rs->fill;
+      if (cache) {
+        fill = &cache->fill;
+        if (!cache->fill_valid || cache->quality != quality) {
+          cache->quality = quality;
+          cache->fill_valid = vg__fill_build(
+              fill, vg_shape_path(shape), vg_shape_get_transform(shape),
+              quality, frame, clip_min, clip_max);
         }
-        if (vg_shape_get_stroke_color(shape) != PIX_COLOR_NONE) {
-          vg_path_t *seg = vg_shape_path(shape);
-          float width = vg_shape_get_stroke_width(shape);
-          if (width <= 0.0f) {
-            // Width exactly zero or negative: treat as disabled stroke (common
-            // in tiger data where stroke flags may be set but width=0 meaning
-            // none).
-            continue;
+      } else {
+        vg__fill_build(fill, vg_shape_path(shape),
+                       vg_shape_get_transform(shape), quality, frame, clip_min,
+                       clip_max);
+      }
+      vg__fill_draw(fill, &rs->sweep, frame, vg_shape_get_fill_color(shape),
+                    vg_shape_get_fill_rule(shape));
+    }
+    if (vg_shape_get_stroke_color(shape) != PIX_COLOR_NONE) {
+      vg_path_t *seg = vg_shape_path(shape);
+      float width = vg_shape_get_stroke_width(shape);
+      if (width <= 0.0f) {
+        // Width exactly zero or negative: treat as disabled stroke (common
+        // in tiger data where stroke flags may be set but width=0 meaning
+        // none).
+        return;
+      }
+      pix_color_t scolor = vg_shape_get_stroke_color(shape);
+      const vg_transform_t *sxf = vg_shape_get_transform(shape);
+      if (width > 1.01f) {
+        // Wide strokes: outline with caps and joins, filled in one pass.
+        vg_stroke_style_t style = {width, vg_shape_get_stroke_cap(shape),
+                                   vg_shape_get_stroke_join(shape),
+                                   vg_shape_get_miter_limit(shape)};
+        vg_stroke_t *st = &rs->stroke;
+        if (cache) {
+          st = &cache->stroke;
+          if (!cache->stroke_valid ||
+              !stroke_style_equal(&cache->style, &style)) {
+            cache->style = style;
+            cache->stroke_valid = vg__stroke_build(st, seg, sxf, &style, frame,
+                                                   clip_min, clip_max);
           }
-          if (width < 0.5f) // sub‑pixel widths still get single AA line
-            width = 0.5f;
-          pix_color_t scolor = vg_shape_get_stroke_color(shape);
-          const vg_transform_t *sxf = vg_shape_get_transform(shape);
-          while (seg) {
-            if (seg->size >= 2) {
-              for (size_t si = 1; si < seg->size; ++si) {
-                pix_point_t a = seg->points[si - 1];
-                pix_point_t b = seg->points[si];
-                float x0 = a.x, y0 = a.y;
-                float x1 = b.x, y1 = b.y;
-                if (sxf) {
-                  float tx0 =
-                      sxf->m[0][0] * x0 + sxf->m[0][1] * y0 + sxf->m[0][2];
-                  float ty0 =
-                      sxf->m[1][0] * x0 + sxf->m[1][1] * y0 + sxf->m[1][2];
-                  float tx1 =
-                      sxf->m[0][0] * x1 + sxf->m[0][1] * y1 + sxf->m[0][2];
-                  float ty1 =
-                      sxf->m[1][0] * x1 + sxf->m[1][1] * y1 + sxf->m[1][2];
-                  x0 = tx0;
-                  y0 = ty0;
-                  x1 = tx1;
-                  y1 = ty1;
-                }
-                if (width <= 1.01f) {
-                  draw_line_aa(frame, x0, y0, x1, y1, scolor);
-                } else {
-                  int layers = (int)ceilf(width);
-                  float half = (layers - 1) * 0.5f;
-                  float dx = x1 - x0, dy = y1 - y0;
-                  float len = sqrtf(dx * dx + dy * dy) + 1e-6f;
-                  float nx = -dy / len, ny = dx / len;
-                  for (int li = 0; li < layers; ++li) {
-                    float o = (li - half);
-                    float ox = nx * o, oy = ny * o;
-                    draw_line_aa(frame, x0 + ox, y0 + oy, x1 + ox, y1 + oy,
-                                 scolor);
-                  }
-                }
-              }
+        } else {
+          vg__stroke_build(st, seg, sxf, &style, frame, clip_min, clip_max);
+        }
+        vg__stroke_draw(st, &rs->sweep.raster, frame, scolor);
+        return;
+      }
+      if (backend_lines && (frame->caps & PIX_FRAME_CAP_LINES) &&
+          frame->draw_line) {
+        hairlines_to_backend(frame, seg, sxf, scolor);
+        return;
+      }
+      // Hairlines (sub‑pixel widths included) are single Wu AA lines.
+      aa_target_t aa;
+      aa_target_init(&aa, frame, scolor, clip_min, clip_max);
+      while (seg) {
+        if (seg->size >= 2) {
+          for (size_t si = 1; si < seg->size; ++si) {
+            pix_point_t a = seg->points[si - 1];
+            pix_point_t b = seg->points[si];
+            float x0 = a.x, fy0 = a.y;
+            float x1 = b.x, fy1 = b.y;
+            if (sxf) {
+              float tx0 = sxf->m[0][0] * x0 + sxf->m[0][1] * fy0 + sxf->m[0][2];
+              float ty0 = sxf->m[1][0] * x0 + sxf->m[1][1] * fy0 + sxf->m[1][2];
+              float tx1 = sxf->m[0][0] * x1 + sxf->m[0][1] * fy1 + sxf->m[0][2];
+              float ty1 = sxf->m[1][0] * x1 + sxf->m[1][1] * fy1 + sxf->m[1][2];
+              x0 = tx0;
+              fy0 = ty0;
+              x1 = tx1;
+              fy1 = ty1;
             }
-            seg = seg->next;
+            draw_line_aa(&aa, x0, fy0, x1, fy1);
           }
         }
-      } else if (shape->kind == VG_SHAPE_IMAGE) {
-        const vg_image_ref_t *img = &shape->data.img;
-        if (!img->frame)
+        seg = seg->next;
+      }
+      aa_target_flush(&aa);
+    }
+  } else if (shape->kind == VG_SHAPE_IMAGE) {
+    const vg_image_ref_t *img = &shape->data.img;
+    if (!img->frame)
+      return;
+    const pix_frame_t *srcf = img->frame;
+    pix_size_t src_full = img->src_size.w
+                              ? img->src_size
+                              : (pix_size_t){srcf->size.w, srcf->size.h};
+    const vg_transform_t *xf = vg_shape_get_transform(shape);
+    if (xf)
+      blit_transformed(frame, img, src_full, xf, clip);
+    else if (image_fits_frame(img, src_full, frame))
+      blit_scaled_contain(frame, img, src_full, clip);
+    else
+      blit_copy_rows(frame, img, srcf, src_full, clip);
+  }
+}
+
+void vg_canvas_render(const vg_canvas_t *canvas, pix_frame_t *frame,
+                      vg_render_ctx_t *ctx) {
+  if (!canvas || !frame || !frame->size.w || !frame->size.h)
+    return;
+  vg_render_ctx_t local = {NULL, 0, 0, {0, 0, 0, 0}};
+  vg_render_ctx_t *rc = ctx ? ctx : &local;
+  if (!render_ctx_begin(rc, 1))
+    return;
+  render_scratch_t *rs = &rc->slots[0].rs;
+  for (vg_canvas_t *chunk = (vg_canvas_t *)canvas; chunk; chunk = chunk->next) {
+    for (size_t i = 0; i < chunk->size; ++i) {
+      vg_shape_t *shape = chunk->shapes[i];
+      if (!shape)
+        continue;
+      // Off-frame shapes are dropped before any setup; the rest are
+      // clipped to their own bounds, which leaves nothing to clip for
+      // shapes inside the frame and sizes the row tables to the shape.
+      vg_bounds_t bounds;
+      bool clipped = false;
+      bool visible = shape_device_bounds(shape, frame, &bounds, &clipped);
+      render_stats_count(&rc->stats, visible, clipped);
+      if (visible)
+        vg__render_shape(shape, frame, &bounds, rs, true, true);
+    }
+  }
+  render_ctx_release(&local);
+}
+
+/* -------- Damage render -------- */
+static bool bounds_touch(const vg_bounds_t *a, const vg_bounds_t *b) {
+  return a->x0 <= b->x1 + 1 && b->x0 <= a->x1 + 1 && a->y0 <= b->y1 + 1 &&
+         b->y0 <= a->y1 + 1;
+}
+
+static vg_bounds_t bounds_union(const vg_bounds_t *a, const vg_bounds_t *b) {
+  vg_bounds_t u;
+  u.x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+  u.y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+  u.x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+  u.y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+  return u;
+}
+
+static long bounds_area(const vg_bounds_t *b) {
+  return (long)(b->x1 - b->x0 + 1) * (long)(b->y1 - b->y0 + 1);
+}
+
+/* Add @p b to a list of disjoint rectangles: it absorbs every rectangle it
+ * touches, and once the list is full it merges with the one whose union
+ * grows least. */
+static void damage_add(vg_bounds_t *list, size_t *count, vg_bounds_t b) {
+  for (;;) {
+    size_t i = 0;
+    while (i < *count && !bounds_touch(&list[i], &b))
+      ++i;
+    if (i < *count) {
+      b = bounds_union(&b, &list[i]);
+      list[i] = list[--*count];
+      continue;
+    }
+    if (*count < VG_DAMAGE_MAX_RECTS)
+      break;
+    size_t best = 0;
+    long best_growth = 0;
+    for (i = 0; i < *count; ++i) {
+      vg_bounds_t u = bounds_union(&b, &list[i]);
+      long growth = bounds_area(&u) - bounds_area(&list[i]) - bounds_area(&b);
+      if (i == 0 || growth < best_growth) {
+        best = i;
+        best_growth = growth;
+      }
+    }
+    b = bounds_union(&b, &list[best]);
+    list[best] = list[--*count];
+  }
+  list[(*count)++] = b;
+}
+
+/* Whether @p shape still matches its drawn snapshot. */
+static bool shape_drawn_same(const vg_shape_t *shape) {
+  const vg_shape_drawn_t *d = &shape->drawn;
+  if (!d->valid || d->revision != shape->revision)
+    return false;
+  if (shape->kind == VG_SHAPE_PATH &&
+      d->generation != shape->data.v.path.generation)
+    return false;
+  if (d->has_transform != (shape->transform != NULL))
+    return false;
+  return !shape->transform ||
+         memcmp(&d->xf, shape->transform, sizeof(vg_transform_t)) == 0;
+}
+
+static void shape_drawn_update(vg_shape_t *shape, const pix_frame_t *frame) {
+  vg_shape_drawn_t *d = &shape->drawn;
+  d->valid = true;
+  d->revision = shape->revision;
+  d->generation =
+      shape->kind == VG_SHAPE_PATH ? shape->data.v.path.generation : 0;
+  d->has_transform = shape->transform != NULL;
+  if (shape->transform)
+    d->xf = *shape->transform;
+  d->visible = shape_device_bounds(shape, frame, &d->bounds, &d->clipped);
+}
+
+void vg_canvas_invalidate(vg_canvas_t *canvas) {
+  if (canvas)
+    canvas->drawn_size = (pix_size_t){0, 0};
+}
+
+void vg_canvas_render_damage(vg_canvas_t *canvas, pix_frame_t *frame,
+                             pix_color_t background, vg_render_ctx_t *ctx,
+                             vg_damage_t *damage) {
+  if (damage)
+    damage->count = 0;
+  if (!canvas || !frame || !frame->size.w || !frame->size.h)
+    return;
+  vg_bounds_t full = {0, 0, frame->size.w - 1, frame->size.h - 1};
+  bool redraw_all = canvas->drawn_size.w != frame->size.w ||
+                    canvas->drawn_size.h != frame->size.h;
+  vg_bounds_t rects[VG_DAMAGE_MAX_RECTS];
+  size_t count = 0;
+  for (vg_canvas_t *chunk = canvas; chunk; chunk = chunk->next) {
+    for (size_t i = 0; i < chunk->size; ++i) {
+      vg_shape_t *shape = chunk->shapes[i];
+      if (!shape || (!redraw_all && shape_drawn_same(shape)))
+        continue;
+      // Damage where the shape was and where it is now.
+      bool was = shape->drawn.valid && shape->drawn.visible;
+      vg_bounds_t old = shape->drawn.bounds;
+      shape_drawn_update(shape, frame);
+      if (redraw_all)
+        continue;
+      if (was)
+        damage_add(rects, &count, old);
+      if (shape->drawn.visible)
+        damage_add(rects, &count, shape->drawn.bounds);
+    }
+  }
+  long area = 0;
+  for (size_t i = 0; i < count; ++i)
+    area += bounds_area(&rects[i]);
+  // Past three quarters of the frame one full pass is cheaper.
+  if (redraw_all || area * 4 > bounds_area(&full) * 3) {
+    rects[0] = full;
+    count = 1;
+  }
+  canvas->drawn_size = frame->size;
+  if (!count)
+    return;
+  vg_render_ctx_t local = {NULL, 0, 0, {0, 0, 0, 0}};
+  vg_render_ctx_t *rc = ctx ? ctx : &local;
+  if (!render_ctx_begin(rc, 1))
+    return;
+  render_scratch_t *rs = &rc->slots[0].rs;
+  for (vg_canvas_t *chunk = canvas; chunk; chunk = chunk->next)
+    for (size_t i = 0; i < chunk->size; ++i)
+      if (chunk->shapes[i])
+        render_stats_count(&rc->stats, chunk->shapes[i]->drawn.visible,
+                           chunk->shapes[i]->drawn.clipped);
+  for (size_t r = 0; r < count; ++r) {
+    const vg_bounds_t *clip = &rects[r];
+    bool whole = count == 1 && clip->x0 == 0 && clip->y0 == 0 &&
+                 clip->x1 == full.x1 && clip->y1 == full.y1;
+    pix_frame_clear_rect(
+        frame, (pix_point_t){(int16_t)clip->x0, (int16_t)clip->y0},
+        (pix_size_t){(uint16_t)(clip->x1 - clip->x0 + 1),
+                     (uint16_t)(clip->y1 - clip->y0 + 1)},
+        background);
+    for (vg_canvas_t *chunk = canvas; chunk; chunk = chunk->next) {
+      for (size_t i = 0; i < chunk->size; ++i) {
+        vg_shape_t *shape = chunk->shapes[i];
+        if (!shape || !shape->drawn.visible ||
+            !bounds_overlap(&shape->drawn.bounds, clip))
           continue;
-        const pix_frame_t *srcf = img->frame;
-        pix_size_t src_full = img->src_size.w
-                                  ? img->src_size
-                                  : (pix_size_t){srcf->size.w, srcf->size.h};
-        const vg_transform_t *xf = vg_shape_get_transform(shape);
-        if (xf)
-          blit_transformed(frame, img, srcf, src_full, xf);
-        else {
-          bool at_origin = (img->dst_origin.x == 0 && img->dst_origin.y == 0);
-          bool size_match =
-              (src_full.w == frame->size.w && src_full.h == frame->size.h);
-          bool fmt_match = (srcf->format == frame->format);
-          bool do_scale = at_origin && !size_match && fmt_match;
-          if (do_scale)
-            blit_scaled_contain(frame, img, srcf, src_full);
-          else if (frame->copy) {
-            frame->copy(frame, img->dst_origin, (pix_frame_t *)srcf,
-                        img->src_origin, src_full,
-                        (pix_blit_flags_t)img->flags);
-          }
-        }
+        vg_bounds_t sc = bounds_intersect(&shape->drawn.bounds, clip);
+        vg__render_shape(shape, frame, &sc, rs, whole, false);
       }
     }
+    if (damage) {
+      damage->rects[r].origin = (pix_point_t){(int16_t)clip->x0,
+                                              (int16_t)clip->y0};
+      damage->rects[r].size =
+          (pix_size_t){(uint16_t)(clip->x1 - clip->x0 + 1),
+                       (uint16_t)(clip->y1 - clip->y0 + 1)};
+    }
   }
+  if (damage)
+    damage->count = count;
+  render_ctx_release(&local);
 }
 
-/* Bounding box (ignores transforms) */
+/* -------- Parallel render -------- */
+/* The frame is cut into full-width horizontal bands (more bands than threads
+ * so uneven scenes still balance). Every band walks the shapes in canvas
+ * order, skipping those whose device rows miss it. */
+#define RENDER_BANDS_PER_THREAD 4
+#define RENDER_BAND_MIN_ROWS 16
+
+typedef struct band_shape_t {
+  vg_shape_t *shape;
+  vg_bounds_t bounds; /* device pixels the shape may touch */
+} band_shape_t;
+
+typedef struct band_job_t {
+  pix_frame_t *frame;
+  render_slot_t *slots; /* per pool slot scratch */
+  band_shape_t *shapes;
+  size_t count;
+  int band_rows;
+} band_job_t;
+
+static void band_render(void *arg, size_t index, size_t slot) {
+  band_job_t *job = (band_job_t *)arg;
+  vg_bounds_t band = {0, (int)index * job->band_rows,
+                      job->frame->size.w - 1, 0};
+  band.y1 = band.y0 + job->band_rows - 1;
+  if (band.y1 >= (int)job->frame->size.h)
+    band.y1 = job->frame->size.h - 1;
+  render_scratch_t *rs = &job->slots[slot].rs;
+  for (size_t i = 0; i < job->count; ++i) {
+    const band_shape_t *b = &job->shapes[i];
+    if (b->bounds.y1 >= band.y0 && b->bounds.y0 <= band.y1) {
+      vg_bounds_t clip = bounds_intersect(&b->bounds, &band);
+      vg__render_shape(b->shape, job->frame, &clip, rs, false, false);
+    }
+  }
+}
+
+void vg_canvas_render_parallel(const vg_canvas_t *canvas, pix_frame_t *frame,
+                               vg_pool_t *pool, vg_render_ctx_t *ctx) {
+  size_t threads = vg_pool_threads(pool);
+  // Frames without mapped pixels draw through backend calls that are not
+  // safe to issue from several threads.
+  if (threads < 2 || !frame || !frame->pixels) {
+    vg_canvas_render(canvas, frame, ctx);
+    return;
+  }
+  if (!canvas || !frame->size.w || !frame->size.h)
+    return;
+  vg_render_ctx_t local = {NULL, 0, 0, {0, 0, 0, 0}};
+  vg_render_ctx_t *rc = ctx ? ctx : &local;
+  if (!render_ctx_begin(rc, threads))
+    return;
+  size_t total = 0;
+  for (const vg_canvas_t *chunk = canvas; chunk; chunk = chunk->next)
+    total += chunk->size;
+  band_job_t job;
+  job.frame = frame;
+  job.slots = rc->slots;
+  job.count = 0;
+  job.shapes = (band_shape_t *)vg__arena_alloc(
+      &rc->slots[0].arena, (total ? total : 1) * sizeof(band_shape_t));
+  if (!job.shapes) {
+    render_ctx_release(&local);
+    return;
+  }
+  for (const vg_canvas_t *chunk = canvas; chunk; chunk = chunk->next) {
+    for (size_t i = 0; i < chunk->size; ++i) {
+      band_shape_t *b = &job.shapes[job.count];
+      b->shape = chunk->shapes[i];
+      if (!b->shape)
+        continue;
+      bool clipped = false;
+      bool visible =
+          shape_device_bounds(b->shape, frame, &b->bounds, &clipped);
+      render_stats_count(&rc->stats, visible, clipped);
+      if (visible)
+        job.count++;
+    }
+  }
+  size_t bands = threads * RENDER_BANDS_PER_THREAD;
+  size_t max_bands = frame->size.h / RENDER_BAND_MIN_ROWS;
+  if (bands > max_bands)
+    bands = max_bands ? max_bands : 1;
+  job.band_rows = (int)((frame->size.h + bands - 1) / bands);
+  bands = (frame->size.h + job.band_rows - 1) / job.band_rows;
+  if (job.count)
+    vg__pool_run(pool, bands, band_render, &job);
+  render_ctx_release(&local);
+}
+
+/* Bounding box: union of the shapes' cached bounds */
 void vg_canvas_bbox(const vg_canvas_t *canvas, pix_point_t *origin,
                     pix_size_t *size) {
   if (origin) {
@@ -454,83 +1108,33 @@ void vg_canvas_bbox(const vg_canvas_t *canvas, pix_point_t *origin,
   if (!canvas)
     return;
   bool first = true;
-  int minx = 0, miny = 0, maxx = 0, maxy = 0;
+  vg_boundsf_t u = {0.f, 0.f, 0.f, 0.f};
   for (const vg_canvas_t *chunk = canvas; chunk; chunk = chunk->next) {
     for (size_t i = 0; i < chunk->size; ++i) {
-      const vg_shape_t *shape = chunk->shapes[i];
-      if (!shape)
+      vg_boundsf_t b;
+      if (!chunk->shapes[i] || !vg__shape_bounds(chunk->shapes[i], &b))
         continue;
-      if (shape->kind == VG_SHAPE_PATH) {
-        vg_path_t *p = vg_shape_path((vg_shape_t *)shape);
-        while (p) {
-          for (size_t pi = 0; pi < p->size; ++pi) {
-            pix_point_t pt = p->points[pi];
-            int x = pt.x;
-            int y = pt.y;
-            if (first) {
-              minx = maxx = x;
-              miny = maxy = y;
-              first = false;
-            } else {
-              if (x < minx)
-                minx = x;
-              if (x > maxx)
-                maxx = x;
-              if (y < miny)
-                miny = y;
-              if (y > maxy)
-                maxy = y;
-            }
-          }
-          p = p->next;
-        }
-      } else if (shape->kind == VG_SHAPE_IMAGE) {
-        const vg_image_ref_t *img = &shape->data.img;
-        if (!img->frame)
-          continue;
-        int x0 = img->dst_origin.x;
-        int y0 = img->dst_origin.y;
-        int w = img->src_size.w ? img->src_size.w : img->frame->size.w;
-        int h = img->src_size.h ? img->src_size.h : img->frame->size.h;
-        int x1 = x0 + w;
-        int y1 = y0 + h;
-        if (first) {
-          minx = x0;
-          miny = y0;
-          maxx = x1;
-          maxy = y1;
-          first = false;
-        } else {
-          if (x0 < minx)
-            minx = x0;
-          if (y0 < miny)
-            miny = y0;
-          if (x1 > maxx)
-            maxx = x1;
-          if (y1 > maxy)
-            maxy = y1;
-        }
+      if (first) {
+        u = b;
+        first = false;
+      } else {
+        u.x0 = fminf(u.x0, b.x0);
+        u.y0 = fminf(u.y0, b.y0);
+        u.x1 = fmaxf(u.x1, b.x1);
+        u.y1 = fmaxf(u.y1, b.y1);
       }
     }
   }
   if (!first) {
+    int minx = (int)floorf(u.x0), miny = (int)floorf(u.y0);
+    int w = (int)ceilf(u.x1) - minx, h = (int)ceilf(u.y1) - miny;
     if (origin) {
       origin->x = (int16_t)minx;
       origin->y = (int16_t)miny;
     }
     if (size) {
-      int w = maxx - minx;
-      int h = maxy - miny;
-      if (w < 0)
-        w = 0;
-      if (h < 0)
-        h = 0;
-      if (w > 0xFFFF)
-        w = 0xFFFF;
-      if (h > 0xFFFF)
-        h = 0xFFFF;
-      size->w = (uint16_t)w;
-      size->h = (uint16_t)h;
+      size->w = (uint16_t)(w > 0xFFFF ? 0xFFFF : w);
+      size->h = (uint16_t)(h > 0xFFFF ? 0xFFFF : h);
     }
   }
 }
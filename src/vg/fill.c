@@ -1,19 +1,22 @@
-// Simplified polygon fill (even-odd / non-zero) with optional small gap
-// bridging. All debug / diagnostic instrumentation removed.
+// Polygon fill front end: exact-coverage AA (raster.c) by default, or the
+// simplified binary scanline fill (even-odd / non-zero) on request. Each fill
+// is built (edge table) then drawn, so cached shapes can keep the built state
+// between renders.
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "../pix/frame_internal.h"
 #include "fill_internal.h"
+#include "path_internal.h"
+#include "raster_internal.h"
 #include <pix/pix.h>
 #include <vg/vg.h>
 
-// Bridging configuration (kept minimal, always enabled):
-static const int FILL_BRIDGE_THRESH = 4; // max empty rows to simple-bridge
-static const int FILL_ADAPTIVE_MAX = 8;  // max empty rows for adaptive bridge
-
 typedef struct SimpleEdge {
-  float x;     // current x at scanline center
-  float dx_dy; // slope (delta x per 1 y)
+  float x;      // x at the current scanline center
+  float x0, y0; // upper end point
+  float dx_dy;  // slope (delta x per 1 y)
   int y_end;   // exclusive end scanline
   int winding; // +1 / -1 for non-zero fill
   struct SimpleEdge *next;
@@ -21,34 +24,39 @@ typedef struct SimpleEdge {
 
 // No debug tinting retained.
 
-static void vg__fill_path_simple(const vg_path_t *path,
-                                 const vg_transform_t *xf, pix_frame_t *frame,
-                                 pix_color_t color, vg_fill_rule_t rule,
-                                 int clip_x0, int clip_y0, int clip_x1,
-                                 int clip_y1) {
-  if (!path)
-    return;
-  // rule parameter used below for even-odd vs non-zero logic
+// Grow a scratch array to hold at least @p n elements (contents dropped).
+static bool scan_reserve(vg_arena_t *arena, void **p, size_t *capacity,
+                         size_t n, size_t size) {
+  if (n <= *capacity)
+    return true;
+  vg__arena_release(arena, *p);
+  *p = vg__arena_alloc(arena, n * size);
+  *capacity = *p ? n : 0;
+  return *p != NULL;
+}
+
+static void vg__scan_build(vg_scan_t *s, const vg_path_t *path,
+                           const vg_transform_t *xf) {
+  s->count = 0;
+  // Rows are limited to the clip, and x is computed per row rather than
+  // accumulated, so every row comes out the same however the frame is
+  // banded.
+  int win_y0 = s->clip_y0, win_y1 = s->clip_y1;
   // 1. Count segments
-  int est = 0;
+  size_t est = 0;
   const vg_path_t *seg = path;
   while (seg) {
     if (seg->size > 1)
-      est += (int)seg->size;
+      est += seg->size;
     seg = seg->next;
   }
   if (est == 0)
     return;
-  // Temp edge list
-  typedef struct {
-    float x0, y0, x1, y1, dx_dy;
-    int y_start, y_end;
-    int winding;
-  } TmpEdge;
-  TmpEdge *tmp = (TmpEdge *)VG_MALLOC(sizeof(TmpEdge) * est);
-  if (!tmp)
+  if (!scan_reserve(s->arena, (void **)&s->edges, &s->capacity, est,
+                    sizeof(vg_scan_edge_t)))
     return;
-  int ec = 0;
+  vg_scan_edge_t *tmp = s->edges;
+  size_t ec = 0;
   float gmin = 1e30f, gmax = -1e30f;
   seg = path;
   while (seg) {
@@ -86,10 +94,10 @@ static void vg__fill_path_simple(const vg_path_t *path,
       int y_end = (int)ceilf(y1 - 0.5f);
       if (y_end <= y_start)
         continue;
-      if (y_start < clip_y0)
-        y_start = clip_y0;
-      if (y_end > clip_y1 + 1)
-        y_end = clip_y1 + 1;
+      if (y_start < win_y0)
+        y_start = win_y0;
+      if (y_end > win_y1 + 1)
+        y_end = win_y1 + 1;
       if (y_start >= y_end)
         continue;
       float dx_dy = (x1 - x0) / (y1 - y0);
@@ -99,8 +107,6 @@ static void vg__fill_path_simple(const vg_path_t *path,
         gmax = y1;
       tmp[ec].x0 = x0;
       tmp[ec].y0 = y0;
-      tmp[ec].x1 = x1;
-      tmp[ec].y1 = y1;
       tmp[ec].dx_dy = dx_dy;
       tmp[ec].y_start = y_start;
       tmp[ec].y_end = y_end;
@@ -109,39 +115,61 @@ static void vg__fill_path_simple(const vg_path_t *path,
     }
     seg = seg->next;
   }
-  if (ec == 0) {
-    VG_FREE(tmp);
+  s->count = ec;
+  s->gmin = gmin;
+  s->gmax = gmax;
+}
+
+/* Write the run [x0,x1] of row @p y, clipped to [clip_x0,clip_x1]. */
+static inline void scan_emit(pix_fill_span_fn fill_span, pix_frame_t *frame,
+                             int y, int x0, int x1, int clip_x0, int clip_x1,
+                             pix_color_t color) {
+  if (x0 < clip_x0)
+    x0 = clip_x0;
+  if (x1 > clip_x1)
+    x1 = clip_x1;
+  if (x0 <= x1)
+    fill_span(frame, (int16_t)y, (int16_t)x0, (int16_t)(x1 + 1), color);
+}
+
+static void vg__scan_draw(const vg_scan_t *s, vg_scan_scratch_t *scratch,
+                          pix_frame_t *frame, pix_color_t color,
+                          vg_fill_rule_t rule) {
+  // Runs are written in the frame's native format through its span writer
+  // (opaque runs overwrite, translucent runs blend src-over).
+  pix_fill_span_fn fill_span = pix_frame_fill_span_fn(frame->format);
+  if (!fill_span || s->count == 0)
     return;
-  }
-  // (debug bookkeeping removed)
+  int clip_x0 = s->clip_x0, clip_x1 = s->clip_x1;
+  const vg_scan_edge_t *tmp = s->edges;
+  int ec = (int)s->count;
   // Buckets
-  int global_y0 =
-      clip_y0 > (int)floorf(gmin - 0.5f) ? clip_y0 : (int)floorf(gmin - 0.5f);
-  int global_y1 =
-      clip_y1 < (int)ceilf(gmax - 0.5f) ? clip_y1 : (int)ceilf(gmax - 0.5f);
-  if (global_y0 > global_y1) {
-    VG_FREE(tmp);
+  int global_y0 = s->clip_y0 > (int)floorf(s->gmin - 0.5f)
+                      ? s->clip_y0
+                      : (int)floorf(s->gmin - 0.5f);
+  int global_y1 = s->clip_y1 < (int)ceilf(s->gmax - 0.5f)
+                      ? s->clip_y1
+                      : (int)ceilf(s->gmax - 0.5f);
+  if (global_y0 > global_y1)
     return;
-  }
   int bucket_n = global_y1 - global_y0 + 2;
-  SimpleEdge **buckets =
-      (SimpleEdge **)VG_MALLOC(sizeof(SimpleEdge *) * bucket_n);
-  SimpleEdge *pool = (SimpleEdge *)VG_MALLOC(sizeof(SimpleEdge) * ec);
-  if (!buckets || !pool) {
-    VG_FREE(buckets);
-    VG_FREE(pool);
-    VG_FREE(tmp);
+  if (!scan_reserve(scratch->arena, (void **)&scratch->buckets,
+                    &scratch->buckets_capacity, (size_t)bucket_n,
+                    sizeof(SimpleEdge *)) ||
+      !scan_reserve(scratch->arena, (void **)&scratch->pool,
+                    &scratch->pool_capacity, (size_t)ec, sizeof(SimpleEdge)))
     return;
-  }
+  SimpleEdge **buckets = scratch->buckets;
+  SimpleEdge *pool = scratch->pool;
   for (int i = 0; i < bucket_n; i++)
     buckets[i] = NULL;
   for (int i = 0; i < ec; i++) {
-    TmpEdge *te = &tmp[i];
+    const vg_scan_edge_t *te = &tmp[i];
     int b = te->y_start - global_y0;
     if (b < 0 || b >= bucket_n)
       continue;
-    float x_init = te->x0 + (((float)te->y_start + 0.5f) - te->y0) * te->dx_dy;
-    pool[i].x = x_init;
+    pool[i].x0 = te->x0;
+    pool[i].y0 = te->y0;
     pool[i].dx_dy = te->dx_dy;
     pool[i].y_end = te->y_end;
     pool[i].winding = te->winding;
@@ -149,19 +177,6 @@ static void vg__fill_path_simple(const vg_path_t *path,
     buckets[b] = &pool[i];
   }
   SimpleEdge *active = NULL;
-  int *row_min = NULL;
-  int *row_max = NULL;
-  { // allocate span bounds for bridging
-    size_t rows = (size_t)(global_y1 - global_y0 + 1);
-    row_min = (int *)VG_MALLOC(rows * sizeof(int));
-    row_max = (int *)VG_MALLOC(rows * sizeof(int));
-    if (row_min && row_max) {
-      for (int i = 0; i <= global_y1 - global_y0; ++i) {
-        row_min[i] = 0x7FFFFFFF;
-        row_max[i] = -0x7FFFFFFF;
-      }
-    }
-  }
   for (int y = global_y0; y <= global_y1; ++y) {
     // insert
     int bi = y - global_y0;
@@ -184,6 +199,8 @@ static void vg__fill_path_simple(const vg_path_t *path,
     }
     if (!active)
       continue;
+    for (SimpleEdge *se = active; se; se = se->next)
+      se->x = se->x0 + ((float)y + 0.5f - se->y0) * se->dx_dy;
     // sort by x (insertion)
     SimpleEdge *sorted = NULL;
     SimpleEdge *e = active;
@@ -202,10 +219,7 @@ static void vg__fill_path_simple(const vg_path_t *path,
       e = n;
     }
     active = sorted;
-    int span_count_this_row = 0;
-    // Build spans
-    // Even-odd family (with or without bridging) share parity span building;
-    // RAW variant skips the later bridging pass via its distinct enum.
+    // Build spans (both even-odd rules share parity span building)
     if (rule == VG_FILL_EVEN_ODD || rule == VG_FILL_EVEN_ODD_RAW) {
       int inside = 0;
       float prev_x = 0.f;
@@ -216,27 +230,12 @@ static void vg__fill_path_simple(const vg_path_t *path,
           if (R > L) {
             int sx = (int)ceilf(L);
             int ex = (int)floorf(R - 1e-6f);
-            if (sx < clip_x0)
-              sx = clip_x0;
-            if (ex > clip_x1)
-              ex = clip_x1;
-            if (sx <= ex && y >= clip_y0 && y <= clip_y1) {
-              if (sx < 0)
-                sx = 0;
-              if (ex >= (int)frame->size.w)
-                ex = (int)frame->size.w - 1;
-              if (y >= 0 && y < (int)frame->size.h) {
-                uint32_t *row =
-                    (uint32_t *)((char *)frame->pixels + y * frame->stride);
-                for (int xi = sx; xi <= ex; ++xi)
-                  row[xi] = color;
-                span_count_this_row++;
-                if (row_min && sx < row_min[y - global_y0])
-                  row_min[y - global_y0] = sx;
-                if (row_max && ex > row_max[y - global_y0])
-                  row_max[y - global_y0] = ex;
-              }
-            }
+            if (sx < 0)
+              sx = 0;
+            if (ex >= (int)frame->size.w)
+              ex = (int)frame->size.w - 1;
+            if (sx <= ex)
+              scan_emit(fill_span, frame, y, sx, ex, clip_x0, clip_x1, color);
           }
         }
         inside = !inside;
@@ -253,27 +252,12 @@ static void vg__fill_path_simple(const vg_path_t *path,
           if (R > L) {
             int sx = (int)ceilf(L);
             int ex = (int)floorf(R - 1e-6f);
-            if (sx < clip_x0)
-              sx = clip_x0;
-            if (ex > clip_x1)
-              ex = clip_x1;
-            if (sx <= ex && y >= clip_y0 && y <= clip_y1) {
-              if (sx < 0)
-                sx = 0;
-              if (ex >= (int)frame->size.w)
-                ex = (int)frame->size.w - 1;
-              if (y >= 0 && y < (int)frame->size.h) {
-                uint32_t *row =
-                    (uint32_t *)((char *)frame->pixels + y * frame->stride);
-                for (int xi = sx; xi <= ex; ++xi)
-                  row[xi] = color;
-                span_count_this_row++;
-                if (row_min && sx < row_min[y - global_y0])
-                  row_min[y - global_y0] = sx;
-                if (row_max && ex > row_max[y - global_y0])
-                  row_max[y - global_y0] = ex;
-              }
-            }
+            if (sx < 0)
+              sx = 0;
+            if (ex >= (int)frame->size.w)
+              ex = (int)frame->size.w - 1;
+            if (sx <= ex)
+              scan_emit(fill_span, frame, y, sx, ex, clip_x0, clip_x1, color);
           }
         }
         if (winding == 0 && new_w != 0)
@@ -281,119 +265,127 @@ static void vg__fill_path_simple(const vg_path_t *path,
         winding = new_w;
       }
     }
-    // advance
-    for (SimpleEdge *se = active; se; se = se->next)
-      se->x += se->dx_dy;
   }
-  // Bridging pass: fill short internal empty gaps by extending/interpolating
-  // neighbor coverage (always enabled; previously debug-toggled).
-  if (row_min && row_max && rule == VG_FILL_EVEN_ODD) {
-    int rows = global_y1 - global_y0 + 1;
-    int i = 0;
-    while (i < rows) {
-      // skip filled rows
-      while (i < rows && !(row_min[i] == 0x7FFFFFFF))
-        i++;
-      int gap_start = i;
-      while (i < rows && row_min[i] == 0x7FFFFFFF)
-        i++;
-      int gap_end = i - 1;
-      if (gap_start <= gap_end) {
-        int gap_len = gap_end - gap_start + 1;
-        if (gap_start > 0 && gap_end < rows - 1) {
-          int prev_min = row_min[gap_start - 1];
-          int prev_max = row_max[gap_start - 1];
-          int next_min = row_min[gap_end + 1];
-          int next_max = row_max[gap_end + 1];
-          int have_neighbors =
-              (prev_min != 0x7FFFFFFF && next_min != 0x7FFFFFFF);
-          // 1. Simple small-gap bridge (union of neighbor spans)
-          if (have_neighbors && gap_len <= FILL_BRIDGE_THRESH) {
-            int fill_min = prev_min < next_min ? prev_min : next_min;
-            int fill_max = prev_max > next_max ? prev_max : next_max;
-            if (fill_min <= fill_max) {
-              for (int gy = gap_start; gy <= gap_end; ++gy) {
-                int y = global_y0 + gy;
-                int fmin = fill_min, fmax = fill_max;
-                if (fmin < 0)
-                  fmin = 0;
-                if (fmax >= (int)frame->size.w)
-                  fmax = (int)frame->size.w - 1;
-                uint32_t *rowp =
-                    (uint32_t *)((char *)frame->pixels + y * frame->stride);
-                uint32_t draw_color = color;
-                for (int x = fmin; x <= fmax; ++x)
-                  rowp[x] = draw_color;
-                row_min[gy] = fmin;
-                row_max[gy] = fmax;
-              }
-            }
-          }
-          // 2. Adaptive interpolation for medium gaps beyond threshold
-          else if (have_neighbors && gap_len <= FILL_ADAPTIVE_MAX) {
-            int prev_w = prev_max - prev_min + 1;
-            int next_w = next_max - next_min + 1;
-            int max_allow_w = (prev_w > next_w ? prev_w : next_w) + 2; // guard
-            for (int gy = gap_start; gy <= gap_end; ++gy) {
-              float t = (float)(gy - gap_start + 1) / (float)(gap_len + 1);
-              float fminf = prev_min + t * (next_min - prev_min);
-              float fmaxf = prev_max + t * (next_max - prev_max);
-              int fmin = (int)floorf(fminf + 0.5f);
-              int fmax = (int)floorf(fmaxf + 0.5f);
-              if (fmin > fmax) {
-                // fallback to union bounds
-                fmin = prev_min < next_min ? prev_min : next_min;
-                fmax = prev_max > next_max ? prev_max : next_max;
-              }
-              if (fmax - fmin + 1 > max_allow_w) {
-                // clamp width
-                int center = (fmin + fmax) / 2;
-                int half = max_allow_w / 2;
-                fmin = center - half;
-                fmax = fmin + max_allow_w - 1;
-              }
-              if (fmin < 0)
-                fmin = 0;
-              if (fmax >= (int)frame->size.w)
-                fmax = (int)frame->size.w - 1;
-              int y = global_y0 + gy;
-              if (y >= 0 && y < (int)frame->size.h && fmin <= fmax) {
-                uint32_t *rowp =
-                    (uint32_t *)((char *)frame->pixels + y * frame->stride);
-                uint32_t draw_color = color;
-                for (int x = fmin; x <= fmax; ++x)
-                  rowp[x] = draw_color;
-                row_min[gy] = fmin;
-                row_max[gy] = fmax;
-              }
-            }
-          }
+}
+
+static void vg__scan_free(vg_scan_t *s) {
+  vg_arena_t *arena = s->arena;
+  vg__arena_release(arena, s->edges);
+  memset(s, 0, sizeof(*s));
+  s->arena = arena;
+}
+
+// Coverage fill: every contour is implicitly closed and fed to the cell
+// rasterizer; points are transformed once each.
+static void vg__raster_build(vg_raster_t *r, const vg_path_t *path,
+                             const vg_transform_t *xf) {
+  for (const vg_path_t *seg = path; seg; seg = seg->next) {
+    if (!seg->size)
+      continue;
+    const vg_path_t *end = vg__path_contour_end(seg);
+    float fx = seg->points[0].x, fy = seg->points[0].y;
+    if (xf) {
+      float tx = xf->m[0][0] * fx + xf->m[0][1] * fy + xf->m[0][2];
+      float ty = xf->m[1][0] * fx + xf->m[1][1] * fy + xf->m[1][2];
+      fx = tx;
+      fy = ty;
+    }
+    float px = fx, py = fy;
+    size_t i = 1;
+    for (const vg_path_t *s = seg;; s = s->next, i = 0) {
+      for (; i < s->size; ++i) {
+        float x = s->points[i].x, y = s->points[i].y;
+        if (xf) {
+          float tx = xf->m[0][0] * x + xf->m[0][1] * y + xf->m[0][2];
+          float ty = xf->m[1][0] * x + xf->m[1][1] * y + xf->m[1][2];
+          x = tx;
+          y = ty;
         }
+        vg__raster_line(r, px, py, x, y);
+        px = x;
+        py = y;
       }
+      if (s == end)
+        break;
     }
+    vg__raster_line(r, px, py, fx, fy);
+    seg = end;
   }
-  VG_FREE(pool);
-  VG_FREE(buckets);
-  VG_FREE(tmp);
-  if (row_min)
-    VG_FREE(row_min);
-  if (row_max)
-    VG_FREE(row_max);
 }
 
-void vg_fill_path_clipped(const vg_path_t *path, const vg_transform_t *xf,
-                          pix_frame_t *frame, pix_color_t color,
-                          vg_fill_rule_t rule, pix_point_t clip_min,
-                          pix_point_t clip_max) {
+bool vg__fill_build(vg_fill_t *f, const vg_path_t *path,
+                    const vg_transform_t *xf, vg_fill_quality_t quality,
+                    const pix_frame_t *frame, pix_point_t clip_min,
+                    pix_point_t clip_max) {
+  f->ready = false;
   if (!frame || !path)
+    return false;
+  int x0 = clip_min.x < 0 ? 0 : clip_min.x;
+  int y0 = clip_min.y < 0 ? 0 : clip_min.y;
+  int x1 = clip_max.x >= (int)frame->size.w ? (int)frame->size.w - 1
+                                            : clip_max.x;
+  int y1 = clip_max.y >= (int)frame->size.h ? (int)frame->size.h - 1
+                                            : clip_max.y;
+  if (x0 > x1 || y0 > y1)
+    return false;
+  f->quality = quality;
+  if (quality == VG_FILL_QUALITY_FAST) {
+    f->scan.clip_x0 = x0;
+    f->scan.clip_y0 = y0;
+    f->scan.clip_x1 = x1;
+    f->scan.clip_y1 = y1;
+    vg__scan_build(&f->scan, path, xf);
+  } else {
+    if (!vg__raster_begin(&f->raster, x0, y0, x1, y1))
+      return false;
+    vg__raster_build(&f->raster, path, xf);
+  }
+  f->ready = true;
+  return true;
+}
+
+void vg__fill_draw(vg_fill_t *f, vg_fill_scratch_t *scratch,
+                   pix_frame_t *frame, pix_color_t color, vg_fill_rule_t rule) {
+  if (!f->ready || !frame)
     return;
-  vg__fill_path_simple(path, xf, frame, color, rule, clip_min.x, clip_min.y,
-                       clip_max.x, clip_max.y);
+  if (f->quality == VG_FILL_QUALITY_FAST)
+    vg__scan_draw(&f->scan, &scratch->scan, frame, color, rule);
+  else
+    vg__raster_fill(&f->raster, &scratch->raster, frame, color, rule);
+}
+
+void vg__fill_free(vg_fill_t *f) {
+  vg__scan_free(&f->scan);
+  vg__raster_free(&f->raster);
+  f->ready = false;
+}
+
+void vg__fill_scratch_free(vg_fill_scratch_t *scratch) {
+  vg_scan_scratch_t *s = &scratch->scan;
+  vg_arena_t *arena = s->arena;
+  vg__arena_release(arena, s->pool);
+  vg__arena_release(arena, s->buckets);
+  memset(s, 0, sizeof(*s));
+  s->arena = arena;
+  vg__raster_scratch_free(&scratch->raster);
+}
+
+void vg_fill_path_clipped(const vg_path_t *path, const vg_transform_t *xf,
+                          pix_frame_t *frame, pix_color_t color,
+                          vg_fill_rule_t rule, vg_fill_quality_t quality,
+                          pix_point_t clip_min, pix_point_t clip_max) {
+  vg_fill_t f = {0};
+  vg_fill_scratch_t scratch = {0};
+  if (vg__fill_build(&f, path, xf, quality, frame, clip_min, clip_max))
+    vg__fill_draw(&f, &scratch, frame, color, rule);
+  vg__fill_free(&f);
+  vg__fill_scratch_free(&scratch);
 }
 
 void vg_fill_path(const vg_path_t *path, const vg_transform_t *xf,
-                  pix_frame_t *frame, pix_color_t color, vg_fill_rule_t rule) {
+                  pix_frame_t *frame, pix_color_t color, vg_fill_rule_t rule,
+                  vg_fill_quality_t quality) {
   vg_fill_path_clipped(
-      path, xf, frame, color, rule, (pix_point_t){0, 0},
+      path, xf, frame, color, rule, quality, (pix_point_t){0, 0},
       (pix_point_t){(int16_t)frame->size.w - 1, (int16_t)frame->size.h - 1});
 }
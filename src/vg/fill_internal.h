@@ -1,12 +1,68 @@
 #pragma once
+#include "raster_internal.h"
 #include <pix/pix.h>
 #include <vg/vg.h>
 /* Internal fill API (formerly public). */
 void vg_fill_path(const struct vg_path_t *path,
                   const struct vg_transform_t *xform, struct pix_frame_t *frame,
-                  pix_color_t color, vg_fill_rule_t rule);
+                  pix_color_t color, vg_fill_rule_t rule,
+                  vg_fill_quality_t quality);
 void vg_fill_path_clipped(const struct vg_path_t *path,
                           const struct vg_transform_t *xform,
                           struct pix_frame_t *frame, pix_color_t color,
-                          vg_fill_rule_t rule, pix_point_t clip_min,
-                          pix_point_t clip_max);
+                          vg_fill_rule_t rule, vg_fill_quality_t quality,
+                          pix_point_t clip_min, pix_point_t clip_max);
+
+/* Binary scanline edge (VG_FILL_QUALITY_FAST), rows limited to the clip. */
+typedef struct vg_scan_edge_t {
+  float x0, y0;       /* upper end point (device space) */
+  float dx_dy;        /* slope */
+  int y_start, y_end; /* first / one past last scanline */
+  int winding;        /* +1 downward, -1 upward */
+} vg_scan_edge_t;
+
+/* Binary scanline edge table. */
+typedef struct vg_scan_t {
+  int clip_x0, clip_y0, clip_x1, clip_y1; /* inclusive clip */
+  vg_scan_edge_t *edges;
+  size_t count, capacity;
+  float gmin, gmax; /* y extent of the stored edges */
+  vg_arena_t *arena; /* storage source, NULL for the heap */
+} vg_scan_t;
+
+/* Binary scanline sweep scratch. */
+typedef struct vg_scan_scratch_t {
+  struct SimpleEdge *pool;
+  size_t pool_capacity;
+  struct SimpleEdge **buckets;
+  size_t buckets_capacity;
+  vg_arena_t *arena; /* storage source, NULL for the heap */
+} vg_scan_scratch_t;
+
+/* Sweep scratch shared by every fill and stroke drawn in one render. */
+typedef struct vg_fill_scratch_t {
+  vg_raster_scratch_t raster;
+  vg_scan_scratch_t scan;
+} vg_fill_scratch_t;
+
+/* A fill split in two: build transforms the path into the edge table for
+ * one clip, draw sweeps it with a color and rule. Drawing leaves the edges
+ * intact and all storage is kept until vg__fill_free, so a retained
+ * vg_fill_t redraws without setup, and without allocation once the shared
+ * scratch has grown. Storage comes from raster.arena / scan.arena.
+ * Zero-initialize before first use. */
+typedef struct vg_fill_t {
+  vg_fill_quality_t quality;
+  vg_raster_t raster; /* VG_FILL_QUALITY_AA */
+  vg_scan_t scan;     /* VG_FILL_QUALITY_FAST */
+  bool ready;         /* built successfully */
+} vg_fill_t;
+
+bool vg__fill_build(vg_fill_t *f, const struct vg_path_t *path,
+                    const struct vg_transform_t *xform,
+                    vg_fill_quality_t quality, const pix_frame_t *frame,
+                    pix_point_t clip_min, pix_point_t clip_max);
+void vg__fill_draw(vg_fill_t *f, vg_fill_scratch_t *scratch,
+                   pix_frame_t *frame, pix_color_t color, vg_fill_rule_t rule);
+void vg__fill_free(vg_fill_t *f);
+void vg__fill_scratch_free(vg_fill_scratch_t *scratch);
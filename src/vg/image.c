@@ -0,0 +1,312 @@
+// Image sampler: fills destination rows from a source rectangle stepped in
+// 16.16 fixed point (see image_internal.h). Texels are read through direct
+// row pointers into 0xAARRGGBB words, filtered there and handed to the
+// destination's copy function in chunks, so format conversion and alpha
+// blending stay with the frame code.
+#include "image_internal.h"
+#include "../pix/color_internal.h"
+#include "../pix/frame_internal.h"
+#include "../pix/simd_internal.h"
+#include <limits.h>
+#include <string.h>
+
+// Pixels staged per destination copy call.
+#define SPAN_CHUNK 256
+
+static inline int fix_floor(int64_t v) { return (int)(v >> VG_FIX_SHIFT); }
+
+static inline int fix_ceil(int64_t v) {
+  return (int)((v + VG_FIX_ONE - 1) >> VG_FIX_SHIFT);
+}
+
+static inline int clampi(int v, int lo, int hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static inline uint32_t premultiply(uint32_t c) {
+  uint32_t a = c >> 24;
+  if (a == 255u)
+    return c;
+  if (a == 0)
+    return 0;
+  return (a << 24) | ((uint32_t)pix_mul255((c >> 16) & 0xFFu, a) << 16) |
+         ((uint32_t)pix_mul255((c >> 8) & 0xFFu, a) << 8) |
+         pix_mul255(c & 0xFFu, a);
+}
+
+/* Row @p j of the source rectangle, clamped to the frame. */
+static inline const uint8_t *src_row(const vg_sampler_t *s, int j) {
+  return s->pixels + (size_t)(s->oy + clampi(j, s->jlo, s->jhi)) * s->stride;
+}
+
+/* Texel @p i of a row from src_row, as 0xAARRGGBB (premultiplied when the
+ * sampler filters a straight alpha source). */
+static inline uint32_t texel(const vg_sampler_t *s, const uint8_t *row,
+                             int i) {
+  i = s->ox + clampi(i, s->ilo, s->ihi);
+  const uint8_t *p = row + (size_t)i * s->bpp;
+  uint32_t c;
+  switch (s->format) {
+  case PIX_FMT_RGB24:
+    return 0xFF000000u | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) |
+           p[2];
+  case PIX_FMT_BGR24:
+    return 0xFF000000u | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) |
+           p[0];
+  case PIX_FMT_RGBA32:
+  case PIX_FMT_RGBA32_PREMUL:
+    c = ((uint32_t)p[3] << 24) | ((uint32_t)p[0] << 16) |
+        ((uint32_t)p[1] << 8) | p[2];
+    break;
+  case PIX_FMT_BGRA32:
+    c = ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+        ((uint32_t)p[1] << 8) | p[0];
+    break;
+  case PIX_FMT_XRGB32:
+    return 0xFF000000u | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) |
+           p[0];
+  case PIX_FMT_GRAY8:
+    return 0xFF000000u | (p[0] * 0x010101u);
+  case PIX_FMT_RGB565: {
+    uint32_t v = *(const uint16_t *)p;
+    return 0xFF000000u | (((v >> 11) & 0x1Fu) << 19) |
+           (((v >> 5) & 0x3Fu) << 10) | ((v & 0x1Fu) << 3);
+  }
+  default:
+    return 0;
+  }
+  return s->premultiply ? premultiply(c) : c;
+}
+
+/* Per-channel (a * (256 - f) + b * f) / 256, two channels per multiply. */
+static inline uint32_t lerp_argb(uint32_t a, uint32_t b, uint32_t f) {
+  uint32_t g = 256u - f;
+  uint32_t rb = (((a & 0x00FF00FFu) * g + (b & 0x00FF00FFu) * f +
+                  0x00800080u) >> 8) & 0x00FF00FFu;
+  uint32_t ag = (((a >> 8) & 0x00FF00FFu) * g +
+                 ((b >> 8) & 0x00FF00FFu) * f + 0x00800080u) & 0xFF00FF00u;
+  return rb | ag;
+}
+
+static inline void put_rgba(uint8_t *o, uint32_t c) {
+  o[0] = (uint8_t)(c >> 16);
+  o[1] = (uint8_t)(c >> 8);
+  o[2] = (uint8_t)c;
+  o[3] = (uint8_t)(c >> 24);
+}
+
+static void sample_nearest(const vg_sampler_t *s, uint8_t *out, int n,
+                           int64_t u, int64_t v, int64_t du, int64_t dv) {
+  int jr = INT_MIN;
+  const uint8_t *row = NULL;
+  for (int k = 0; k < n; ++k, u += du, v += dv, out += 4) {
+    int j = fix_floor(v);
+    if (j != jr) {
+      row = src_row(s, j);
+      jr = j;
+    }
+    put_rgba(out, texel(s, row, fix_floor(u)));
+  }
+}
+
+static void sample_bilinear(const vg_sampler_t *s, uint8_t *out, int n,
+                            int64_t u, int64_t v, int64_t du, int64_t dv) {
+  // Texel centers sit at i + 0.5: shift by half a texel so the integer
+  // part names the upper-left texel of the 2x2 neighbourhood.
+  u -= VG_FIX_ONE / 2;
+  v -= VG_FIX_ONE / 2;
+  int jr = INT_MIN;
+  const uint8_t *r0 = NULL, *r1 = NULL;
+  for (int k = 0; k < n; ++k, u += du, v += dv, out += 4) {
+    int i = fix_floor(u), j = fix_floor(v);
+    uint32_t fx = (uint32_t)(u >> (VG_FIX_SHIFT - 8)) & 0xFFu;
+    uint32_t fy = (uint32_t)(v >> (VG_FIX_SHIFT - 8)) & 0xFFu;
+    if (j != jr) {
+      r0 = src_row(s, j);
+      r1 = src_row(s, j + 1);
+      jr = j;
+    }
+    uint32_t top = lerp_argb(texel(s, r0, i), texel(s, r0, i + 1), fx);
+    uint32_t bot = lerp_argb(texel(s, r1, i), texel(s, r1, i + 1), fx);
+    put_rgba(out, lerp_argb(top, bot, fy));
+  }
+}
+
+/* Average of the texels whose centers fall inside the pixel's footprint,
+ * at least one texel wide on each axis. */
+static void sample_area(const vg_sampler_t *s, uint8_t *out, int n,
+                        int64_t u, int64_t v, int64_t du, int64_t dv,
+                        int64_t fu, int64_t fv) {
+  int64_t hu = (fu > VG_FIX_ONE ? fu : VG_FIX_ONE) / 2;
+  int64_t hv = (fv > VG_FIX_ONE ? fv : VG_FIX_ONE) / 2;
+  for (int k = 0; k < n; ++k, u += du, v += dv, out += 4) {
+    int ia = clampi(fix_ceil(u - hu - VG_FIX_ONE / 2), s->ilo, s->ihi);
+    int ib = clampi(fix_ceil(u + hu - VG_FIX_ONE / 2) - 1, ia, s->ihi);
+    int ja = clampi(fix_ceil(v - hv - VG_FIX_ONE / 2), s->jlo, s->jhi);
+    int jb = clampi(fix_ceil(v + hv - VG_FIX_ONE / 2) - 1, ja, s->jhi);
+    uint64_t sa = 0, sr = 0, sg = 0, sb = 0;
+    for (int j = ja; j <= jb; ++j) {
+      const uint8_t *row = src_row(s, j);
+      for (int i = ia; i <= ib; ++i) {
+        uint32_t c = texel(s, row, i);
+        sa += c >> 24;
+        sr += (c >> 16) & 0xFFu;
+        sg += (c >> 8) & 0xFFu;
+        sb += c & 0xFFu;
+      }
+    }
+    uint64_t cnt = (uint64_t)(ib - ia + 1) * (uint64_t)(jb - ja + 1);
+    uint64_t half = cnt / 2;
+    put_rgba(out, (uint32_t)((sa + half) / cnt) << 24 |
+                      (uint32_t)((sr + half) / cnt) << 16 |
+                      (uint32_t)((sg + half) / cnt) << 8 |
+                      (uint32_t)((sb + half) / cnt));
+  }
+}
+
+bool vg__sampler_init(vg_sampler_t *s, const pix_frame_t *src,
+                      pix_point_t origin, pix_size_t size,
+                      vg_image_sampling_t mode, unsigned flags) {
+  size_t bpp = src ? pix_format_bytes(src->format) : 0;
+  if (!bpp || !src->pixels || !size.w || !size.h)
+    return false;
+  int ox = origin.x, oy = origin.y;
+  s->ilo = ox < 0 ? -ox : 0;
+  s->jlo = oy < 0 ? -oy : 0;
+  s->ihi = (ox + size.w < src->size.w ? size.w : src->size.w - ox) - 1;
+  s->jhi = (oy + size.h < src->size.h ? size.h : src->size.h - oy) - 1;
+  if (s->ihi < s->ilo || s->jhi < s->jlo)
+    return false;
+  s->pixels = (const uint8_t *)src->pixels;
+  s->stride = src->stride;
+  s->bpp = bpp;
+  s->ox = ox;
+  s->oy = oy;
+  s->format = src->format;
+  s->mode = mode;
+  // Filters mix neighbours, which is only right on premultiplied colors.
+  s->premultiply = mode != VG_IMAGE_NEAREST &&
+                   (src->format == PIX_FMT_RGBA32 ||
+                    src->format == PIX_FMT_BGRA32);
+  s->out_format = (s->premultiply || src->format == PIX_FMT_RGBA32_PREMUL)
+                      ? PIX_FMT_RGBA32_PREMUL
+                      : PIX_FMT_RGBA32;
+  s->flags = (pix_blit_flags_t)flags;
+  return true;
+}
+
+void vg__sampler_span(const vg_sampler_t *s, pix_frame_t *dst, int y, int x0,
+                      int x1, int64_t u0, int64_t v0, int64_t du, int64_t dv,
+                      int64_t fu, int64_t fv) {
+  uint8_t buf[SPAN_CHUNK * 4];
+  pix_frame_t row;
+  memset(&row, 0, sizeof(row));
+  row.pixels = buf;
+  row.stride = sizeof(buf);
+  row.format = s->out_format;
+  bool (*copy)(pix_frame_t *, pix_point_t, const pix_frame_t *, pix_point_t,
+               pix_size_t, pix_blit_flags_t) =
+      dst->copy ? dst->copy : pix_frame_copy;
+  vg_image_sampling_t mode = s->mode;
+  if (mode == VG_IMAGE_AREA && fu <= VG_FIX_ONE && fv <= VG_FIX_ONE)
+    mode = VG_IMAGE_BILINEAR; // magnifying: nothing to average
+  int64_t u = u0 + (int64_t)x0 * du, v = v0 + (int64_t)x0 * dv;
+  while (x0 < x1) {
+    int n = x1 - x0 < SPAN_CHUNK ? x1 - x0 : SPAN_CHUNK;
+    switch (mode) {
+    case VG_IMAGE_BILINEAR:
+      sample_bilinear(s, buf, n, u, v, du, dv);
+      break;
+    case VG_IMAGE_AREA:
+      sample_area(s, buf, n, u, v, du, dv, fu, fv);
+      break;
+    default:
+      sample_nearest(s, buf, n, u, v, du, dv);
+      break;
+    }
+    row.size = (pix_size_t){(uint16_t)n, 1};
+    copy(dst, (pix_point_t){(int16_t)x0, (int16_t)y}, &row,
+         (pix_point_t){0, 0}, row.size, s->flags);
+    u += (int64_t)n * du;
+    v += (int64_t)n * dv;
+    x0 += n;
+  }
+}
+
+/* One row of a level: 2x2 box averages of rows @p r0 and @p r1 of @p w
+ * 4-byte pixels; an odd last column averages with itself. */
+static void box_halve_row(uint8_t *out, const uint8_t *r0, const uint8_t *r1,
+                          int w) {
+  int x = 0;
+  for (; x < w / 2; ++x, out += 4, r0 += 8, r1 += 8)
+    for (int c = 0; c < 4; ++c)
+      out[c] = (uint8_t)((r0[c] + r0[c + 4] + r1[c] + r1[c + 4] + 2) >> 2);
+  if (w & 1)
+    for (int c = 0; c < 4; ++c)
+      out[c] = (uint8_t)((r0[c] + r1[c] + 1) >> 1);
+}
+
+bool vg__image_mips_build(vg_image_mips_t *m, const pix_frame_t *src,
+                          pix_point_t origin, pix_size_t size, int levels) {
+  if (levels > VG_IMAGE_MIP_MAX)
+    levels = VG_IMAGE_MIP_MAX;
+  if (!src->pixels || !pix_format_bytes(src->format) || origin.x < 0 ||
+      origin.y < 0 || origin.x + size.w > src->size.w ||
+      origin.y + size.h > src->size.h)
+    return false; // levels must cover the whole rectangle
+  // Straight alpha is premultiplied on the way down, so levels of alpha
+  // sources are RGBA32_PREMUL and the others RGBA32.
+  bool alpha = src->format == PIX_FMT_RGBA32 ||
+               src->format == PIX_FMT_RGBA32_PREMUL ||
+               src->format == PIX_FMT_BGRA32;
+  pix_format_t format = alpha ? PIX_FMT_RGBA32_PREMUL : PIX_FMT_RGBA32;
+  uint8_t *tmp = NULL; // two source rows in the level format
+  bool ok = true;
+  while (ok && m->count < levels) {
+    const pix_frame_t *from = m->count ? m->level[m->count - 1] : src;
+    pix_point_t at = m->count ? (pix_point_t){0, 0} : origin;
+    pix_size_t sz = m->count ? from->size : size;
+    if (sz.w == 1 && sz.h == 1)
+      break; // nothing left to reduce
+    pix_size_t half = {(uint16_t)((sz.w + 1) / 2), (uint16_t)((sz.h + 1) / 2)};
+    pix_frame_t *level = pix_frame_init_mem(half, format, 0);
+    bool convert = from->format != format;
+    if (convert && !tmp)
+      tmp = (uint8_t *)VG_MALLOC((size_t)size.w * 8u);
+    if (!level || (convert && !tmp)) {
+      if (level)
+        level->destroy(level);
+      ok = false;
+      break;
+    }
+    size_t bpp = pix_format_bytes(from->format);
+    for (int y = 0; y < half.h; ++y) {
+      int y1 = 2 * y + 1 < sz.h ? 2 * y + 1 : 2 * y;
+      const uint8_t *r0 = (const uint8_t *)from->pixels +
+                          (size_t)(at.y + 2 * y) * from->stride +
+                          (size_t)at.x * bpp;
+      const uint8_t *r1 = r0 + (size_t)(y1 - 2 * y) * from->stride;
+      if (convert) {
+        uint8_t *t1 = tmp + (size_t)sz.w * 4u;
+        ok = pix_convert_row(format, tmp, from->format, r0, sz.w) &&
+             pix_convert_row(format, t1, from->format, r1, sz.w);
+        r0 = tmp;
+        r1 = t1;
+      }
+      box_halve_row((uint8_t *)level->pixels + (size_t)y * level->stride, r0,
+                    r1, sz.w);
+    }
+    if (ok)
+      m->level[m->count++] = level;
+    else
+      level->destroy(level);
+  }
+  VG_FREE(tmp);
+  return ok;
+}
+
+void vg__image_mips_clear(vg_image_mips_t *m) {
+  for (int i = 0; i < m->count; ++i)
+    m->level[i]->destroy(m->level[i]);
+  m->count = 0;
+}
@@ -0,0 +1,66 @@
+/* Internal image sampler for image shape blits (not public API).
+ *
+ * Source coordinates are 16.16 fixed point in the source rectangle's texel
+ * space, where texel i covers [i, i + 1). A span maps destination pixel x
+ * of a row to (u0 + x * du, v0 + x * dv), with (u0, v0) belonging to
+ * column 0 of that row; callers include the half-pixel offset of the pixel
+ * center. Anchoring to column 0 rather than to the span start keeps the
+ * result of a pixel independent of how a render is banded or clipped.
+ */
+#pragma once
+#include <pix/pix.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <vg/vg.h>
+
+#define VG_FIX_SHIFT 16
+#define VG_FIX_ONE ((int64_t)1 << VG_FIX_SHIFT)
+
+/* Reductions of an image shape's source rectangle for minified blits
+ * (vg_shape_set_image_mipmaps). level[k] is the rectangle box-filtered
+ * k + 1 times by 2x2, each size halved and rounded up; levels are added on
+ * demand and count says how many exist. */
+#define VG_IMAGE_MIP_MAX 16
+
+typedef struct vg_image_mips_t {
+  int count;
+  pix_frame_t *level[VG_IMAGE_MIP_MAX];
+} vg_image_mips_t;
+
+typedef struct vg_sampler_t {
+  const uint8_t *pixels; /* source frame pixels */
+  size_t stride;
+  size_t bpp;
+  int ox, oy;              /* source rectangle origin in the frame */
+  int ilo, ihi, jlo, jhi;  /* texel indices inside the frame, inclusive */
+  pix_format_t format;     /* source format */
+  vg_image_sampling_t mode;
+  bool premultiply;        /* premultiply straight texels on fetch */
+  pix_format_t out_format; /* RGBA32, or RGBA32_PREMUL when filtering alpha */
+  pix_blit_flags_t flags;  /* passed to the destination copy */
+} vg_sampler_t;
+
+/* Prepare sampling of the @p size rectangle at @p origin of @p src, which
+ * is clipped to the frame. false if nothing of it lies inside the frame or
+ * the format is unsupported. */
+bool vg__sampler_init(vg_sampler_t *s, const pix_frame_t *src,
+                      pix_point_t origin, pix_size_t size,
+                      vg_image_sampling_t mode, unsigned flags);
+
+/* Write pixels [x0, x1) of row @p y of @p dst, already clipped to the
+ * frame. (@p fu, @p fv) is the extent of one destination pixel in texels,
+ * used by VG_IMAGE_AREA. Coordinates outside the source clamp to its
+ * edge. */
+void vg__sampler_span(const vg_sampler_t *s, pix_frame_t *dst, int y, int x0,
+                      int x1, int64_t u0, int64_t v0, int64_t du, int64_t dv,
+                      int64_t fu, int64_t fv);
+
+/* Extend @p m to @p levels levels (fewer once a level is 1x1) from the
+ * @p size rectangle at @p origin of @p src. false if out of memory or the
+ * rectangle is not inside the frame; the levels built so far stay
+ * usable. */
+bool vg__image_mips_build(vg_image_mips_t *m, const pix_frame_t *src,
+                          pix_point_t origin, pix_size_t size, int levels);
+
+/* Free every level of @p m. */
+void vg__image_mips_clear(vg_image_mips_t *m);
@@ -10,6 +10,7 @@ vg_path_t vg_path_init(size_t capacity) {
   path.size = 0;
   path.capacity = capacity;
   path.next = NULL;
+  path.generation = 0;
   return path;
 }
 
@@ -47,6 +48,7 @@ static vg_path_t *append_point_seg(vg_path_t *seg, pix_point_t pt) {
     }
     n->size = 0;
     n->next = NULL;
+    n->generation = 0;
     seg->next = n;
     seg = n;
   }
@@ -57,6 +59,7 @@ static vg_path_t *append_point_seg(vg_path_t *seg, pix_point_t pt) {
 bool vg_path_append(vg_path_t *path, const pix_point_t *first, ...) {
   if (!path || !first)
     return false;
+  path->generation++;
   const pix_point_t *pt = first;
   va_list ap;
   va_start(ap, first);
@@ -81,6 +84,7 @@ bool vg_path_append(vg_path_t *path, const pix_point_t *first, ...) {
       }
       n->size = 0;
       n->next = NULL;
+      n->generation = 0;
       tail->next = n;
       tail = n;
     }
@@ -112,6 +116,27 @@ bool vg_path_break(vg_path_t *path, size_t reserve) {
   }
   n->size = 0;
   n->next = NULL;
+  n->generation = 0;
   seg->next = n;
+  path->generation++;
   return true;
 }
+
+void vg_path_touch(vg_path_t *path) {
+  if (path)
+    path->generation++;
+}
+
+const vg_path_t *vg__path_contour_end(const vg_path_t *start) {
+  if (!start || start->size == 0)
+    return start;
+  pix_point_t first = start->points[0];
+  const vg_path_t *seg = start;
+  while (seg->next && seg->size == seg->capacity && seg->next->size) {
+    pix_point_t last = seg->points[seg->size - 1];
+    if (last.x == first.x && last.y == first.y)
+      break;
+    seg = seg->next;
+  }
+  return seg;
+}
@@ -4,3 +4,10 @@
 /* Internal path initializer (capacity must be >0). */
 vg_path_t vg_path_init(size_t capacity);
 void vg_path_finish(vg_path_t *path); /* internal */
+
+/* Contours: a contour starts at a segment and runs through the overflow
+ * segments vg_path_append chains on when one fills up. A segment that is
+ * not full (e.g. ended by vg_path_break), is empty, or returns to the
+ * contour's first point ends it. Returns the last segment of the contour
+ * beginning at @p start. */
+const vg_path_t *vg__path_contour_end(const vg_path_t *start);
@@ -0,0 +1,157 @@
+// Worker thread pool: workers sleep on a condition variable between jobs
+// and claim task indices from a shared counter. See pool_internal.h.
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "pool_internal.h"
+#include <vg/vg.h>
+
+#ifdef VG_ENABLE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+struct vg_pool_t {
+  size_t threads; /* including the calling thread */
+#ifdef VG_ENABLE_THREADS
+  pthread_t *workers;
+  pthread_mutex_t lock;
+  pthread_cond_t wake; /* a job was posted, or quit */
+  pthread_cond_t done; /* the last task of a job finished */
+  vg_pool_task_fn fn;
+  void *arg;
+  size_t count, next, pending; /* job size, next unclaimed, unfinished */
+  size_t slots;                /* slots handed out in the current job */
+  unsigned generation;         /* bumped per job */
+  bool quit;
+#endif
+};
+
+#ifdef VG_ENABLE_THREADS
+/* Run tasks of the current job until none are left unclaimed. Called and
+ * returns with the lock held. */
+static void pool_drain(vg_pool_t *pool, size_t slot) {
+  while (pool->next < pool->count) {
+    size_t index = pool->next++;
+    vg_pool_task_fn fn = pool->fn;
+    void *arg = pool->arg;
+    pthread_mutex_unlock(&pool->lock);
+    fn(arg, index, slot);
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->pending == 0)
+      pthread_cond_signal(&pool->done);
+  }
+}
+
+static void *pool_worker(void *p) {
+  vg_pool_t *pool = (vg_pool_t *)p;
+  pthread_mutex_lock(&pool->lock);
+  unsigned seen = pool->generation;
+  for (;;) {
+    while (!pool->quit && pool->generation == seen)
+      pthread_cond_wait(&pool->wake, &pool->lock);
+    if (pool->quit)
+      break;
+    seen = pool->generation;
+    pool_drain(pool, pool->slots++);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+#endif
+
+vg_pool_t *vg_pool_create(size_t threads) {
+  vg_pool_t *pool = (vg_pool_t *)VG_MALLOC(sizeof(vg_pool_t));
+  if (!pool)
+    return NULL;
+  pool->threads = 1;
+#ifdef VG_ENABLE_THREADS
+  if (threads == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = n > 0 ? (size_t)n : 1;
+  }
+  pool->workers = NULL;
+  pool->fn = NULL;
+  pool->arg = NULL;
+  pool->count = pool->next = pool->pending = pool->slots = 0;
+  pool->generation = 0;
+  pool->quit = false;
+  if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+    VG_FREE(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->wake, NULL) != 0) {
+    pthread_mutex_destroy(&pool->lock);
+    VG_FREE(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->done, NULL) != 0) {
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    VG_FREE(pool);
+    return NULL;
+  }
+  if (threads > 1)
+    pool->workers = (pthread_t *)VG_MALLOC((threads - 1) * sizeof(pthread_t));
+  if (pool->workers) {
+    for (size_t i = 0; i + 1 < threads; ++i) {
+      if (pthread_create(&pool->workers[i], NULL, pool_worker, pool) != 0)
+        break;
+      pool->threads++;
+    }
+  }
+#else
+  (void)threads;
+#endif
+  return pool;
+}
+
+void vg_pool_destroy(vg_pool_t *pool) {
+  if (!pool)
+    return;
+#ifdef VG_ENABLE_THREADS
+  pthread_mutex_lock(&pool->lock);
+  pool->quit = true;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 0; i + 1 < pool->threads; ++i)
+    pthread_join(pool->workers[i], NULL);
+  VG_FREE(pool->workers);
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->lock);
+#endif
+  VG_FREE(pool);
+}
+
+size_t vg_pool_threads(const vg_pool_t *pool) {
+  return pool ? pool->threads : 1;
+}
+
+void vg__pool_run(vg_pool_t *pool, size_t count, vg_pool_task_fn fn,
+                  void *arg) {
+  if (!fn)
+    return;
+#ifdef VG_ENABLE_THREADS
+  if (pool && pool->threads > 1 && count > 1) {
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->count = count;
+    pool->next = 0;
+    pool->pending = count;
+    pool->slots = 1; /* the caller is slot 0 */
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pool_drain(pool, 0);
+    while (pool->pending)
+      pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    return;
+  }
+#else
+  (void)pool;
+#endif
+  for (size_t i = 0; i < count; ++i)
+    fn(arg, i, 0);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <vg/vg.h>
+
+/* Internal job API: a job is @p count independent tasks run as
+ * fn(arg, index, slot) by the pool's workers and the calling thread,
+ * returning once every task has finished. Tasks are claimed in index order.
+ * @p slot identifies the thread running the task within the job (0 for the
+ * caller, below vg_pool_threads), so tasks can use per-thread scratch
+ * without locking. A pool runs one job at a time; a NULL or single-thread
+ * pool runs the tasks inline in slot 0. */
+typedef void (*vg_pool_task_fn)(void *arg, size_t index, size_t slot);
+
+void vg__pool_run(vg_pool_t *pool, size_t count, vg_pool_task_fn fn,
+                  void *arg);
@@ -0,0 +1,511 @@
+// Analytic-coverage (exact area) polygon rasterizer: an active edge list
+// over a dense row of accumulation cells. See raster_internal.h.
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raster_internal.h"
+
+#define PIXEL_BITS 8
+#define ONE_PIXEL (1 << PIXEL_BITS)
+
+// Keep fixed-point coordinates and their differences inside int32.
+static const float RASTER_COORD_MAX = 2097152.0f; // 2^21 px
+
+static inline int32_t to_fixed(float v) {
+  if (v > RASTER_COORD_MAX)
+    v = RASTER_COORD_MAX;
+  else if (v < -RASTER_COORD_MAX)
+    v = -RASTER_COORD_MAX;
+  return (int32_t)lrintf(v * (float)ONE_PIXEL);
+}
+
+/* Arithmetic shift floors negative coordinates (as FreeType's TRUNC). */
+static inline int32_t trunc_px(int32_t v) { return v >> PIXEL_BITS; }
+
+/* Floor division by a positive denominator: quotient and remainder >= 0. */
+static inline void floor_divmod(int64_t p, int64_t d, int32_t *q, int32_t *r) {
+  int64_t qq = p / d, rr = p % d;
+  if (rr < 0) {
+    qq--;
+    rr += d;
+  }
+  *q = (int32_t)qq;
+  *r = (int32_t)rr;
+}
+
+bool vg__raster_begin(vg_raster_t *r, int clip_x0, int clip_y0, int clip_x1,
+                      int clip_y1) {
+  r->clip_x0 = clip_x0;
+  r->clip_y0 = clip_y0;
+  r->clip_x1 = clip_x1;
+  r->clip_y1 = clip_y1;
+  r->count = 0;
+  r->min_y = INT32_MAX;
+  r->max_y = INT32_MIN;
+  r->oom = false;
+  size_t rows = clip_y1 >= clip_y0 ? (size_t)(clip_y1 - clip_y0 + 1) : 0;
+  if (rows > r->rows_capacity) {
+    int32_t *heads = (int32_t *)vg__arena_realloc(
+        r->arena, r->rows, r->rows_capacity * sizeof(int32_t),
+        rows * sizeof(int32_t));
+    if (!heads) {
+      r->oom = true;
+      return false;
+    }
+    r->rows = heads;
+    r->rows_capacity = rows;
+  }
+  for (size_t i = 0; i < rows; ++i)
+    r->rows[i] = -1;
+  return true;
+}
+
+void vg__raster_free(vg_raster_t *r) {
+  if (!r)
+    return;
+  vg_arena_t *arena = r->arena;
+  vg__arena_release(arena, r->edges);
+  vg__arena_release(arena, r->rows);
+  memset(r, 0, sizeof(*r));
+  r->arena = arena;
+}
+
+void vg__raster_scratch_free(vg_raster_scratch_t *s) {
+  if (!s)
+    return;
+  vg_arena_t *arena = s->arena;
+  vg__arena_release(arena, s->active);
+  vg__arena_release(arena, s->cells);
+  vg__arena_release(arena, s->coverage);
+  memset(s, 0, sizeof(*s));
+  s->arena = arena;
+}
+
+/* Size the scratch for @p width clip columns and @p edges active edges. */
+static bool raster_scratch_reserve(vg_raster_scratch_t *s, size_t width,
+                                   size_t edges) {
+  if (edges > s->active_capacity) {
+    vg_active_t *active = (vg_active_t *)vg__arena_realloc(
+        s->arena, s->active, s->active_capacity * sizeof(vg_active_t),
+        edges * sizeof(vg_active_t));
+    if (!active)
+      return false;
+    s->active = active;
+    s->active_capacity = edges;
+  }
+  if (width > s->width_capacity || !s->cells) {
+    // Cells start zeroed and every sweep leaves the cells it visits zeroed.
+    vg__arena_release(s->arena, s->cells);
+    vg__arena_release(s->arena, s->coverage);
+    s->cells = (vg_cell_t *)vg__arena_alloc(s->arena,
+                                            (width + 1) * sizeof(vg_cell_t));
+    s->coverage = (uint8_t *)vg__arena_alloc(s->arena, width + 1);
+    s->width_capacity = s->cells && s->coverage ? width : 0;
+    if (!s->cells || !s->coverage) {
+      vg__arena_release(s->arena, s->cells);
+      vg__arena_release(s->arena, s->coverage);
+      s->cells = NULL;
+      s->coverage = NULL;
+      return false;
+    }
+    memset(s->cells, 0, (width + 1) * sizeof(vg_cell_t));
+  }
+  return true;
+}
+
+/* x where the line (x0,y0)-(x0+dx,y0+dy) crosses @p y, floored, so that a
+ * clipped edge starts and ends on exactly the positions the row DDA of the
+ * unclipped edge reaches (clip rows never change a row's coverage). */
+static inline int32_t x_at(int32_t x0, int32_t y0, int64_t dx, int32_t dy,
+                           int32_t y) {
+  int32_t q, rem;
+  floor_divmod(((int64_t)y - y0) * dx, dy, &q, &rem);
+  return x0 + q;
+}
+
+void vg__raster_line(vg_raster_t *r, float fx0, float fy0, float fx1,
+                     float fy1) {
+  if (r->oom)
+    return;
+  int32_t x0 = to_fixed(fx0), y0 = to_fixed(fy0);
+  int32_t x1 = to_fixed(fx1), y1 = to_fixed(fy1);
+  if (y0 == y1)
+    return; // horizontal edges carry no cover
+  int32_t sign = 1;
+  if (y0 > y1) { // walk downwards; orientation kept in sign
+    int32_t t = x0;
+    x0 = x1;
+    x1 = t;
+    t = y0;
+    y0 = y1;
+    y1 = t;
+    sign = -1;
+  }
+  int32_t top = r->clip_y0 * ONE_PIXEL;
+  int32_t bottom = (r->clip_y1 + 1) * ONE_PIXEL;
+  if (y1 <= top || y0 >= bottom)
+    return;
+  if (r->count == r->capacity) {
+    size_t cap = r->capacity ? r->capacity * 2 : 256;
+    vg_edge_t *edges = (vg_edge_t *)vg__arena_realloc(
+        r->arena, r->edges, r->capacity * sizeof(vg_edge_t),
+        cap * sizeof(vg_edge_t));
+    if (!edges) {
+      r->oom = true;
+      return;
+    }
+    r->edges = edges;
+    r->capacity = cap;
+  }
+  vg_edge_t *e = &r->edges[r->count];
+  int64_t dx = (int64_t)x1 - x0;
+  int32_t dy = y1 - y0;
+  e->ax = y0 < top ? x_at(x0, y0, dx, dy, top) : x0;
+  e->ay = y0 < top ? top : y0;
+  e->bx = y1 > bottom ? x_at(x0, y0, dx, dy, bottom) : x1;
+  e->by = y1 > bottom ? bottom : y1;
+  e->sign = sign;
+  e->ey1 = trunc_px(e->ay);
+  e->ey2 = trunc_px(e->by - 1);
+  if (e->ey1 != e->ey2) {
+    // Step x from row to row with an error term instead of dividing per
+    // row: x_first ends the (possibly partial) first row, then each full
+    // row advances by lift plus a carry accumulated from rem. Both derive
+    // from the unclipped edge.
+    int32_t delta;
+    e->dy = dy;
+    floor_divmod(((int64_t)(e->ey1 + 1) * ONE_PIXEL - y0) * dx, dy, &delta,
+                 &e->mod0);
+    e->x_first = x0 + delta;
+    e->mod0 -= dy;
+    e->lift = e->rem = 0;
+    if (e->ey2 - e->ey1 > 1)
+      floor_divmod((int64_t)ONE_PIXEL * dx, dy, &e->lift, &e->rem);
+  }
+  int32_t row = e->ey1 - r->clip_y0;
+  e->next = r->rows[row];
+  r->rows[row] = (int32_t)r->count++;
+  if (e->ey1 < r->min_y)
+    r->min_y = e->ey1;
+  if (e->ey2 > r->max_y)
+    r->max_y = e->ey2;
+}
+
+/* -------- Cell accumulation -------- */
+static inline void raster_add(vg_raster_t *r, int32_t ex, int32_t cover,
+                              int32_t area) {
+  // Cells left of the clip only matter for the cover they carry to the
+  // right, so they collapse into one column just outside the clip.
+  if (ex < r->clip_x0)
+    ex = r->clip_x0 - 1;
+  else if (ex > r->clip_x1)
+    return;
+  vg_cell_t *c = &r->cells[ex - r->clip_x0 + 1];
+  c->cover += cover;
+  c->area += area;
+}
+
+/* Walk one row: the edge runs from (xa, fya) to (xb, fyb), fy relative to
+ * the top of the row with fya < fyb. Each pixel column crossed receives its
+ * share of the extent; a DDA (as in FreeType) avoids per-column divisions.
+ *
+ * Columns outside the clip are skipped by jumping the DDA rather than by
+ * trimming the run, so every column inside receives exactly what an
+ * unclipped walk gives it: clip rectangles never change coverage. */
+static void raster_hline(vg_raster_t *r, int32_t xa, int32_t fya, int32_t xb,
+                         int32_t fyb, int32_t sign) {
+  int32_t left = r->clip_x0 * ONE_PIXEL;
+  int32_t right = (r->clip_x1 + 1) * ONE_PIXEL;
+  if (xa >= right && xb >= right)
+    return;
+  if (xa < left && xb < left) {
+    raster_add(r, r->clip_x0 - 1, sign * (fyb - fya), 0);
+    return;
+  }
+  int32_t dy = fyb - fya;
+  if (dy <= 0)
+    return;
+  int32_t ex1 = trunc_px(xa), ex2 = trunc_px(xb);
+  int32_t fx1 = xa - ex1 * ONE_PIXEL, fx2 = xb - ex2 * ONE_PIXEL;
+  if (ex1 == ex2) {
+    raster_add(r, ex1, sign * dy, sign * dy * (fx1 + fx2));
+    return;
+  }
+  // Within one row dy <= ONE_PIXEL, so the products below fit in 32 bits
+  // and the (much cheaper) 32-bit divide suffices.
+  int32_t dx, first, incr, p;
+  if (xb > xa) {
+    dx = xb - xa;
+    p = (ONE_PIXEL - fx1) * dy;
+    first = ONE_PIXEL;
+    incr = 1;
+  } else {
+    dx = xa - xb;
+    p = fx1 * dy;
+    first = 0;
+    incr = -1;
+  }
+  int32_t delta = p / dx;
+  int32_t mod = p % dx;
+  raster_add(r, ex1, sign * delta, sign * delta * (fx1 + first));
+  int32_t y = fya + delta;
+  ex1 += incr;
+  if (ex1 != ex2) {
+    int32_t pp = ONE_PIXEL * dy;
+    int32_t lift = pp / dx;
+    int32_t rem = pp % dx;
+    // Full columns before the clip: after s of them the DDA stands at
+    // y = fya + floor((p + s * pp) / dx), so jump straight there. Skipped
+    // columns on the left still hand their cover to the clip edge.
+    int32_t skip = 0;
+    if (incr > 0 && ex1 < r->clip_x0)
+      skip = (ex2 < r->clip_x0 ? ex2 : r->clip_x0) - ex1;
+    else if (incr < 0 && ex1 > r->clip_x1)
+      skip = ex1 - (ex2 > r->clip_x1 ? ex2 : r->clip_x1);
+    if (skip > 0) {
+      int64_t total = (int64_t)p + (int64_t)skip * pp;
+      int32_t ys = fya + (int32_t)(total / dx);
+      mod = (int32_t)(total % dx);
+      if (incr > 0)
+        raster_add(r, r->clip_x0 - 1, sign * (ys - y), 0);
+      y = ys;
+      ex1 += incr * skip;
+    }
+    while (ex1 != ex2) {
+      if (incr > 0 ? ex1 > r->clip_x1 : ex1 < r->clip_x0)
+        break; // the rest lies past the clip (cover only, if on the left)
+      delta = lift;
+      mod += rem;
+      if (mod >= dx) {
+        mod -= dx;
+        delta++;
+      }
+      raster_add(r, ex1, sign * delta, sign * delta * ONE_PIXEL);
+      y += delta;
+      ex1 += incr;
+    }
+    if (ex1 != ex2) {
+      if (incr < 0)
+        raster_add(r, r->clip_x0 - 1, sign * (fyb - y), 0);
+      return;
+    }
+  }
+  delta = fyb - y;
+  raster_add(r, ex2, sign * delta, sign * delta * (fx2 + ONE_PIXEL - first));
+}
+
+/* Accumulate edge @p a's part of row @p ey and record the cell columns it
+ * touched, clamped to the stored range. */
+static inline void raster_edge_row(vg_raster_t *r, vg_active_t *a,
+                                   int32_t ey) {
+  const vg_edge_t *e = &r->edges[a->edge];
+  int32_t row_top = ey * ONE_PIXEL;
+  int32_t xa = a->x, xb, fya = 0, fyb = ONE_PIXEL;
+  if (ey == e->ey1)
+    fya = e->ay - row_top;
+  if (ey == e->ey2) {
+    xb = e->bx;
+    fyb = e->by - row_top;
+  } else if (ey == e->ey1) {
+    xb = e->x_first;
+  } else {
+    int32_t delta = e->lift;
+    a->mod += e->rem;
+    if (a->mod >= 0) {
+      a->mod -= e->dy;
+      delta++;
+    }
+    xb = xa + delta;
+  }
+  a->x = xb;
+  int32_t lo = trunc_px(xa < xb ? xa : xb), hi = trunc_px(xa < xb ? xb : xa);
+  int32_t dy = fyb - fya;
+  if (lo >= r->clip_x0 && hi <= r->clip_x1 && hi - lo <= 1 && dy > 0) {
+    // One or two columns inside the clip, the common cases, inline.
+    vg_cell_t *c = &r->cells[lo - r->clip_x0 + 1];
+    int32_t base = 2 * lo * ONE_PIXEL;
+    if (lo == hi) {
+      c->cover += e->sign * dy;
+      c->area += e->sign * dy * (xa + xb - base);
+    } else {
+      // Split dy where the edge crosses the column boundary (as the first
+      // step of raster_hline).
+      int32_t edge_x = (lo + 1) * ONE_PIXEL;
+      int32_t left = xa < xb ? (edge_x - xa) * dy / (xb - xa)
+                             : dy - (xa - edge_x) * dy / (xa - xb);
+      c[0].cover += e->sign * left;
+      c[0].area += e->sign * left * ((xa < xb ? xa : xb) + edge_x - base);
+      c[1].cover += e->sign * (dy - left);
+      c[1].area += e->sign * (dy - left) *
+                   ((xa < xb ? xb : xa) + edge_x - base - 2 * ONE_PIXEL);
+    }
+  } else {
+    raster_hline(r, xa, fya, xb, fyb, e->sign);
+  }
+  a->lo = lo < r->clip_x0 ? r->clip_x0 - 1 : lo;
+  a->hi = hi < r->clip_x0 ? r->clip_x0 - 1 : hi > r->clip_x1 ? r->clip_x1 : hi;
+}
+
+/* -------- Sweep -------- */
+static inline int raster_coverage(int32_t area2, bool even_odd) {
+  int c = area2 >> (PIXEL_BITS + 1);
+  if (c < 0)
+    c = -c;
+  if (even_odd) {
+    c &= 2 * ONE_PIXEL - 1;
+    if (c > ONE_PIXEL)
+      c = 2 * ONE_PIXEL - c;
+  }
+  return c > 255 ? 255 : c;
+}
+
+/* Row emitter: partial coverage accumulates into a contiguous run that is
+ * blended in one call; long fully covered runs go straight to fill_span. */
+typedef struct raster_out_t {
+  pix_frame_t *frame;
+  pix_fill_span_fn fill;
+  pix_blend_span_fn blend;
+  pix_color_t color;
+  int16_t y;
+  int run_x0, run_len;
+  uint8_t *cov; /* clip-width coverage buffer */
+  int cov_x0;   /* column of cov[0] */
+} raster_out_t;
+
+static void out_flush(raster_out_t *o) {
+  if (o->run_len)
+    o->blend(o->frame, o->y, (int16_t)o->run_x0,
+             o->cov + (o->run_x0 - o->cov_x0), (uint16_t)o->run_len, o->color);
+  o->run_len = 0;
+}
+
+static void out_span(raster_out_t *o, int x0, int x1, int c) {
+  if (x0 >= x1)
+    return;
+  if (c == 0) {
+    out_flush(o);
+    return;
+  }
+  if (c == 255 && x1 - x0 > 2) {
+    out_flush(o);
+    o->fill(o->frame, o->y, (int16_t)x0, (int16_t)x1, o->color);
+    return;
+  }
+  if (o->run_len && o->run_x0 + o->run_len != x0)
+    out_flush(o);
+  if (!o->run_len)
+    o->run_x0 = x0;
+  memset(o->cov + (x0 - o->cov_x0), c, (size_t)(x1 - x0));
+  o->run_len += x1 - x0;
+}
+
+void vg__raster_fill(vg_raster_t *r, vg_raster_scratch_t *scratch,
+                     pix_frame_t *frame, pix_color_t color,
+                     vg_fill_rule_t rule) {
+  if (!r->count || !frame || r->oom)
+    return;
+  raster_out_t o;
+  o.frame = frame;
+  o.fill = pix_frame_fill_span_fn(frame->format);
+  o.blend = pix_frame_blend_span_fn(frame->format);
+  if (!o.fill || !o.blend)
+    return;
+  if (!raster_scratch_reserve(scratch, (size_t)(r->clip_x1 - r->clip_x0 + 1),
+                              r->count))
+    return;
+  r->cells = scratch->cells;
+  o.color = color;
+  o.run_len = 0;
+  o.cov = scratch->coverage;
+  o.cov_x0 = r->clip_x0;
+  bool even_odd = (rule == VG_FILL_EVEN_ODD || rule == VG_FILL_EVEN_ODD_RAW);
+  const vg_edge_t *edges = r->edges;
+  vg_active_t *active = scratch->active;
+  vg_cell_t *cells = scratch->cells;
+  uint8_t *cov = scratch->coverage;
+  const int32_t x_min = r->clip_x0, x_max = r->clip_x1;
+  size_t n = 0;
+  for (int32_t ey = r->min_y; ey <= r->max_y; ++ey) {
+    // Drop the edges that ended on the previous row (compacting here, well
+    // after the sweep read them, keeps stores and loads apart), then admit
+    // the edges starting on this row; the insertion sort below moves them
+    // into place.
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (active[i].ey2 < ey)
+        continue;
+      if (k != i)
+        active[k] = active[i];
+      k++;
+    }
+    n = k;
+    for (int32_t i = r->rows[ey - r->clip_y0]; i >= 0; i = edges[i].next) {
+      active[n].x = edges[i].ax;
+      active[n].mod = edges[i].mod0;
+      active[n].edge = i;
+      active[n++].ey2 = edges[i].ey2;
+    }
+    if (!n)
+      continue;
+    for (size_t i = 0; i < n; ++i)
+      raster_edge_row(r, &active[i], ey);
+    // Order by first touched column; nearly sorted from the previous row.
+    for (size_t i = 1; i < n; ++i) {
+      if (active[i - 1].lo <= active[i].lo)
+        continue;
+      vg_active_t v = active[i];
+      size_t j = i;
+      while (j > 0 && active[j - 1].lo > v.lo) {
+        active[j] = active[j - 1];
+        --j;
+      }
+      active[j] = v;
+    }
+    // Sweep the touched column ranges; between them coverage is constant.
+    // Touched pixels join the pending run as a block (zero coverage blends
+    // nothing), so the inner loop is branch-free.
+    o.y = (int16_t)ey;
+    int32_t cover = 0;
+    int32_t done = x_min - 2; // last column swept
+    for (size_t i = 0; i < n; ++i) {
+      const vg_active_t *a = &active[i];
+      if (a->lo > x_max || a->hi <= done)
+        continue;
+      int32_t x = a->lo > done ? a->lo : done + 1;
+      if (cover && x > done + 1)
+        out_span(&o, done + 1, x,
+                 raster_coverage(cover * (2 * ONE_PIXEL), even_odd));
+      if (x < x_min) { // the left-clip column only carries cover
+        cover += cells[0].cover;
+        cells[0].cover = 0;
+        cells[0].area = 0;
+        x = x_min;
+      }
+      if (x <= a->hi) {
+        if (o.run_len && o.run_x0 + o.run_len != x)
+          out_flush(&o);
+        if (!o.run_len)
+          o.run_x0 = x;
+        o.run_len = a->hi + 1 - o.run_x0;
+        vg_cell_t *c = &cells[x - x_min + 1];
+        uint8_t *dst = cov + (x - x_min);
+        for (int32_t m = a->hi - x; m >= 0; --m, ++c, ++dst) {
+          cover += c->cover;
+          *dst = (uint8_t)raster_coverage(cover * (2 * ONE_PIXEL) - c->area,
+                                          even_odd);
+          c->cover = 0;
+          c->area = 0;
+        }
+      }
+      done = a->hi;
+    }
+    // Cover left over means the polygon continues past the right clip.
+    if (cover && done < x_max)
+      out_span(&o, done + 1, x_max + 1,
+               raster_coverage(cover * (2 * ONE_PIXEL), even_odd));
+    out_flush(&o);
+  }
+  r->cells = NULL;
+}
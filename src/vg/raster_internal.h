@@ -0,0 +1,93 @@
+/* Internal analytic-coverage polygon rasterizer (not public API).
+ *
+ * Coverage is accumulated per cell in the style of the libart / FreeType
+ * "gray" rasterizers: every pixel an edge passes through receives the signed
+ * vertical extent of the edge inside it (cover) and the edge's horizontal
+ * position within the pixel weighted by that extent (area). Sweeping a row
+ * left to right and summing covers yields the exact area coverage of every
+ * pixel; pixels between touched cells share the running cover and are
+ * emitted as spans.
+ *
+ * Edges are bucketed by their first row and walked with an active edge list,
+ * so only one row of cells exists at a time: cells accumulate into a dense
+ * clip-width row buffer and the sweep visits only the column ranges the
+ * active edges touched (kept sorted by insertion, as edges rarely reorder
+ * between rows). Coordinates are 24.8 fixed point.
+ */
+#pragma once
+#include "../pix/frame_internal.h"
+#include "arena_internal.h"
+#include <pix/pix.h>
+#include <vg/vg.h>
+
+typedef struct vg_cell_t {
+  int32_t cover; /* signed vertical extent inside the pixel (1/256 px) */
+  int32_t area;  /* signed sum of extent * (entry + exit x within pixel) */
+} vg_cell_t;
+
+typedef struct vg_edge_t {
+  int32_t ay, by;    /* clipped top / bottom y (24.8), ay < by */
+  int32_t ax, bx;    /* x at ay / by */
+  int32_t x_first;   /* x where the edge leaves its first row */
+  int32_t ey1, ey2;  /* first / last pixel row */
+  int32_t lift, rem; /* per full row x step (DDA) */
+  int32_t mod0, dy;  /* initial DDA error term and its denominator */
+  int32_t next;      /* next edge starting in the same row, -1 ends */
+  int32_t sign;      /* +1 downward, -1 upward in the source contour */
+} vg_edge_t;
+
+typedef struct vg_raster_t {
+  int clip_x0, clip_y0, clip_x1, clip_y1; /* inclusive clip in pixels */
+  vg_edge_t *edges;                        /* edge storage */
+  size_t count, capacity;
+  int32_t *rows; /* per clip row: first edge starting there, or -1 */
+  size_t rows_capacity;
+  vg_cell_t *cells; /* during a sweep: the scratch cells */
+  int min_y, max_y; /* touched row range (valid when count > 0) */
+  bool oom;         /* set when an edge could not be stored */
+  vg_arena_t *arena; /* storage source, NULL for the heap */
+} vg_raster_t;
+
+/* Active edge during a sweep: its stepping state (the edge table itself is
+ * only read) and the cell columns it touched in the current row (the list is
+ * kept ordered by lo). */
+typedef struct vg_active_t {
+  int32_t lo, hi;
+  int32_t x, mod; /* x entering the current row, DDA error */
+  int32_t edge;
+  int32_t ey2; /* last row, copied from the edge */
+} vg_active_t;
+
+/* Sweep scratch, separate from the edge table so that retained rasters
+ * (cached shapes) share one per render instead of keeping their own. */
+typedef struct vg_raster_scratch_t {
+  vg_active_t *active; /* active edges */
+  size_t active_capacity;
+  vg_cell_t *cells;  /* clip width + 1 cells, zero between sweeps; [0]
+                        collects left-clipped cover */
+  uint8_t *coverage; /* clip-width coverage for the span writers */
+  size_t width_capacity;
+  vg_arena_t *arena; /* storage source, NULL for the heap */
+} vg_raster_scratch_t;
+
+/* Prepare for a new polygon clipped to [x0,x1] x [y0,y1] (inclusive). Keeps
+ * any previously allocated storage. Returns false when out of memory. */
+bool vg__raster_begin(vg_raster_t *r, int clip_x0, int clip_y0, int clip_x1,
+                      int clip_y1);
+
+/* Add one polygon edge in device pixel coordinates. Contours must be closed
+ * by the caller (last point joined back to the first). */
+void vg__raster_line(vg_raster_t *r, float x0, float y0, float x1, float y1);
+
+/* Sweep the accumulated edges and composite @p color into @p frame using the
+ * frame format's span writers. Even-odd rules use parity, anything else
+ * non-zero winding. The edges are left intact, so a raster can be swept
+ * again (not concurrently: the sweep state lives in the edges). */
+void vg__raster_fill(vg_raster_t *r, vg_raster_scratch_t *scratch,
+                     pix_frame_t *frame, pix_color_t color,
+                     vg_fill_rule_t rule);
+
+/* Release all storage (arena storage is only dropped, see arena_internal.h).
+ * The arena pointer is kept. */
+void vg__raster_free(vg_raster_t *r);
+void vg__raster_scratch_free(vg_raster_scratch_t *s);
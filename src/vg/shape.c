@@ -1,11 +1,21 @@
 #include "path_internal.h"
 #include "shape_internal.h"
 #include <vg/shape.h>
+#include <math.h>
+#include <string.h>
 #include <vg/vg.h>
 
+/* Only the vector members are set: data is a union, and writing the image
+ * members afterwards would overwrite the path just initialized. Image shapes
+ * fill in data.img in vg_shape_set_image. */
 static void vg_shape_defaults(vg_shape_t *s) {
   s->kind = VG_SHAPE_PATH;
   s->transform = NULL;
+  s->cache = NULL;
+  s->revision = 0;
+  s->drawn.valid = false;
+  s->bounds.points_valid = false;
+  s->bounds.valid = false;
   s->data.v.path = vg_path_init(64);
   s->data.v.fill_color = PIX_COLOR_NONE;
   s->data.v.stroke_color = PIX_COLOR_NONE;
@@ -14,11 +24,16 @@ static void vg_shape_defaults(vg_shape_t *s) {
   s->data.v.stroke_join = VG_JOIN_BEVEL;
   s->data.v.miter_limit = 4.0f;
   s->data.v.fill_rule = VG_FILL_EVEN_ODD;
-  s->data.img.frame = NULL;
-  s->data.img.src_origin = (pix_point_t){0, 0};
-  s->data.img.src_size = (pix_size_t){0, 0};
-  s->data.img.dst_origin = (pix_point_t){0, 0};
-  s->data.img.flags = 0;
+  s->data.v.fill_quality = VG_FILL_QUALITY_AA;
+}
+
+static void vg_shape_cache_free(vg_shape_t *s) {
+  if (!s->cache)
+    return;
+  vg__fill_free(&s->cache->fill);
+  vg__stroke_free(&s->cache->stroke);
+  VG_FREE(s->cache);
+  s->cache = NULL;
 }
 
 /* Internal: exported (non-header) symbol for canvas pool initialization. */
@@ -38,6 +53,9 @@ void vg_shape_destroy(vg_shape_t *shape) {
   if (shape->kind == VG_SHAPE_PATH) {
     vg_path_finish(&shape->data.v.path);
   }
+  vg_shape_cache_free(shape);
+  if (shape->kind == VG_SHAPE_IMAGE)
+    vg_shape_set_image_mipmaps(shape, false);
   VG_FREE(shape);
 }
 
@@ -48,20 +66,27 @@ vg_path_t *vg_shape_path(vg_shape_t *shape) {
 }
 
 void vg_shape_set_transform(vg_shape_t *shape, const vg_transform_t *xf) {
-  if (shape)
+  if (shape && shape->transform != xf) {
     shape->transform = xf;
+    shape->revision++;
+  }
 }
 const vg_transform_t *vg_shape_get_transform(const vg_shape_t *shape) {
   return shape ? shape->transform : NULL;
 }
 
 void vg_shape_set_fill_color(vg_shape_t *shape, pix_color_t c) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH && shape->data.v.fill_color != c) {
     shape->data.v.fill_color = c;
+    shape->revision++;
+  }
 }
 void vg_shape_set_stroke_color(vg_shape_t *shape, pix_color_t c) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.stroke_color != c) {
     shape->data.v.stroke_color = c;
+    shape->revision++;
+  }
 }
 
 pix_color_t vg_shape_get_fill_color(const vg_shape_t *shape) {
@@ -74,32 +99,44 @@ pix_color_t vg_shape_get_stroke_color(const vg_shape_t *shape) {
 }
 
 void vg_shape_set_stroke_width(vg_shape_t *shape, float w) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.stroke_width != w) {
     shape->data.v.stroke_width = w;
+    shape->revision++;
+  }
 }
 float vg_shape_get_stroke_width(const vg_shape_t *shape) {
   return (shape && shape->kind == VG_SHAPE_PATH) ? shape->data.v.stroke_width
                                                  : 0.0f;
 }
 void vg_shape_set_stroke_cap(vg_shape_t *shape, vg_cap_t cap) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.stroke_cap != cap) {
     shape->data.v.stroke_cap = cap;
+    shape->revision++;
+  }
 }
 vg_cap_t vg_shape_get_stroke_cap(const vg_shape_t *shape) {
   return (shape && shape->kind == VG_SHAPE_PATH) ? shape->data.v.stroke_cap
                                                  : VG_CAP_BUTT;
 }
 void vg_shape_set_stroke_join(vg_shape_t *shape, vg_join_t join) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.stroke_join != join) {
     shape->data.v.stroke_join = join;
+    shape->revision++;
+  }
 }
 vg_join_t vg_shape_get_stroke_join(const vg_shape_t *shape) {
   return (shape && shape->kind == VG_SHAPE_PATH) ? shape->data.v.stroke_join
                                                  : VG_JOIN_BEVEL;
 }
 void vg_shape_set_miter_limit(vg_shape_t *shape, float limit) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.miter_limit != limit) {
     shape->data.v.miter_limit = limit;
+    shape->revision++;
+  }
 }
 float vg_shape_get_miter_limit(const vg_shape_t *shape) {
   return (shape && shape->kind == VG_SHAPE_PATH) ? shape->data.v.miter_limit
@@ -107,14 +144,29 @@ float vg_shape_get_miter_limit(const vg_shape_t *shape) {
 }
 
 void vg_shape_set_fill_rule(vg_shape_t *shape, vg_fill_rule_t rule) {
-  if (shape && shape->kind == VG_SHAPE_PATH)
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.fill_rule != rule) {
     shape->data.v.fill_rule = rule;
+    shape->revision++;
+  }
 }
 vg_fill_rule_t vg_shape_get_fill_rule(const vg_shape_t *shape) {
   return (shape && shape->kind == VG_SHAPE_PATH) ? shape->data.v.fill_rule
                                                  : VG_FILL_EVEN_ODD;
 }
 
+void vg_shape_set_fill_quality(vg_shape_t *shape, vg_fill_quality_t quality) {
+  if (shape && shape->kind == VG_SHAPE_PATH &&
+      shape->data.v.fill_quality != quality) {
+    shape->data.v.fill_quality = quality;
+    shape->revision++;
+  }
+}
+vg_fill_quality_t vg_shape_get_fill_quality(const vg_shape_t *shape) {
+  return (shape && shape->kind == VG_SHAPE_PATH) ? shape->data.v.fill_quality
+                                                 : VG_FILL_QUALITY_AA;
+}
+
 void vg_shape_set_image(vg_shape_t *shape, const pix_frame_t *frame,
                         pix_point_t src_origin, pix_size_t src_size,
                         pix_point_t dst_origin, unsigned flags) {
@@ -124,24 +176,237 @@ void vg_shape_set_image(vg_shape_t *shape, const pix_frame_t *frame,
   if (shape->kind == VG_SHAPE_PATH) {
     vg_path_finish(&shape->data.v.path);
   }
+  vg_shape_cache_free(shape);
+  if (shape->kind != VG_SHAPE_IMAGE) {
+    shape->data.img.sampling = VG_IMAGE_NEAREST;
+    shape->data.img.mips = NULL;
+  } else if (shape->data.img.mips) {
+    // Levels are rebuilt from the new source on demand.
+    vg__image_mips_clear(shape->data.img.mips);
+  }
   shape->kind = VG_SHAPE_IMAGE;
   shape->data.img.frame = frame;
   shape->data.img.src_origin = src_origin;
   shape->data.img.src_size = src_size;
   shape->data.img.dst_origin = dst_origin;
   shape->data.img.flags = flags;
+  shape->revision++;
+}
+
+void vg_shape_set_image_sampling(vg_shape_t *shape,
+                                 vg_image_sampling_t sampling) {
+  if (shape && shape->kind == VG_SHAPE_IMAGE &&
+      shape->data.img.sampling != sampling) {
+    shape->data.img.sampling = sampling;
+    shape->revision++;
+  }
+}
+vg_image_sampling_t vg_shape_get_image_sampling(const vg_shape_t *shape) {
+  return (shape && shape->kind == VG_SHAPE_IMAGE) ? shape->data.img.sampling
+                                                  : VG_IMAGE_NEAREST;
+}
+
+bool vg_shape_set_image_mipmaps(vg_shape_t *shape, bool enable) {
+  if (!shape || shape->kind != VG_SHAPE_IMAGE)
+    return false;
+  vg_image_mips_t *m = shape->data.img.mips;
+  if (!enable) {
+    if (m) {
+      vg__image_mips_clear(m);
+      VG_FREE(m);
+      shape->data.img.mips = NULL;
+      shape->revision++;
+    }
+    return true;
+  }
+  if (m)
+    return true;
+  m = (vg_image_mips_t *)VG_MALLOC(sizeof(vg_image_mips_t));
+  if (!m)
+    return false;
+  m->count = 0;
+  shape->data.img.mips = m;
+  shape->revision++;
+  return true;
+}
+
+bool vg_shape_get_image_mipmaps(const vg_shape_t *shape) {
+  return shape && shape->kind == VG_SHAPE_IMAGE && shape->data.img.mips;
 }
 
 bool vg_shape_path_clear(vg_shape_t *shape, size_t reserve) {
   if (!shape || shape->kind != VG_SHAPE_PATH)
     return false;
+  // Carry the generation over so a cached shape sees the new path as a
+  // change even if it is rebuilt with the same number of edits.
+  uint32_t generation = shape->data.v.path.generation;
   vg_path_finish(&shape->data.v.path);
   if (reserve < 4)
     reserve = 4;
   shape->data.v.path = vg_path_init(reserve);
+  shape->data.v.path.generation = generation + 1;
   return shape->data.v.path.points != NULL;
 }
 
+bool vg_shape_set_cached(vg_shape_t *shape, bool enable) {
+  if (!shape || shape->kind != VG_SHAPE_PATH)
+    return false;
+  if (!enable) {
+    vg_shape_cache_free(shape);
+    return true;
+  }
+  if (shape->cache)
+    return true;
+  shape->cache = (vg_shape_cache_t *)VG_MALLOC(sizeof(vg_shape_cache_t));
+  if (!shape->cache)
+    return false;
+  memset(shape->cache, 0, sizeof(vg_shape_cache_t));
+  return true;
+}
+
+bool vg_shape_get_cached(const vg_shape_t *shape) {
+  return shape && shape->cache != NULL;
+}
+
+vg_shape_cache_t *vg__shape_cache_sync(vg_shape_t *s, pix_size_t frame_size) {
+  vg_shape_cache_t *c = s->cache;
+  if (!c)
+    return NULL;
+  const vg_transform_t *xf = s->transform;
+  bool same = c->generation == s->data.v.path.generation &&
+              c->has_transform == (xf != NULL) &&
+              c->frame_size.w == frame_size.w &&
+              c->frame_size.h == frame_size.h;
+  if (same && xf)
+    same = memcmp(&c->xf, xf, sizeof(vg_transform_t)) == 0;
+  if (!same) {
+    // Keep the storage: the rebuild reuses it.
+    c->generation = s->data.v.path.generation;
+    c->has_transform = xf != NULL;
+    if (xf)
+      c->xf = *xf;
+    c->frame_size = frame_size;
+    c->fill_valid = false;
+    c->stroke_valid = false;
+  }
+  return c;
+}
+
+static void bounds_add(vg_boundsf_t *b, float x, float y) {
+  if (x < b->x0)
+    b->x0 = x;
+  if (x > b->x1)
+    b->x1 = x;
+  if (y < b->y0)
+    b->y0 = y;
+  if (y > b->y1)
+    b->y1 = y;
+}
+
+static const vg_boundsf_t bounds_empty = {INFINITY, INFINITY, -INFINITY,
+                                          -INFINITY};
+
+/* How far past the path a stroke reaches, in device pixels. */
+static float stroke_reach(const vg_shape_t *s) {
+  float width = s->data.v.stroke_width;
+  if (s->data.v.stroke_color == PIX_COLOR_NONE || width <= 0.f)
+    return 0.f;
+  if (width <= 1.01f)
+    return 1.f; // hairline: Wu lines touch the next pixel over
+  float k = 1.f;
+  if (s->data.v.stroke_cap == VG_CAP_SQUARE)
+    k = (float)M_SQRT2;
+  if (s->data.v.stroke_join == VG_JOIN_MITER && s->data.v.miter_limit > k)
+    k = s->data.v.miter_limit;
+  return width * 0.5f * k;
+}
+
+static vg_boundsf_t path_device_bounds(vg_shape_t *s,
+                                       const vg_transform_t *xf) {
+  vg_shape_bounds_t *c = &s->bounds;
+  const vg_path_t *path = &s->data.v.path;
+  if (!c->points_valid || c->generation != path->generation) {
+    c->points = bounds_empty;
+    for (const vg_path_t *seg = path; seg; seg = seg->next)
+      for (size_t i = 0; i < seg->size; ++i)
+        bounds_add(&c->points, seg->points[i].x, seg->points[i].y);
+    c->generation = path->generation;
+    c->points_valid = true;
+  }
+  vg_boundsf_t b = c->points;
+  if (b.x0 > b.x1)
+    return b;
+  if (xf && xf->m[0][1] == 0.f && xf->m[1][0] == 0.f) {
+    // Scale and translate only: the corners stay the extremes.
+    float x0 = xf->m[0][0] * b.x0 + xf->m[0][2];
+    float x1 = xf->m[0][0] * b.x1 + xf->m[0][2];
+    float y0 = xf->m[1][1] * b.y0 + xf->m[1][2];
+    float y1 = xf->m[1][1] * b.y1 + xf->m[1][2];
+    b.x0 = fminf(x0, x1);
+    b.x1 = fmaxf(x0, x1);
+    b.y0 = fminf(y0, y1);
+    b.y1 = fmaxf(y0, y1);
+  } else if (xf) {
+    b = bounds_empty;
+    for (const vg_path_t *seg = path; seg; seg = seg->next) {
+      for (size_t i = 0; i < seg->size; ++i) {
+        float x, y;
+        vg_transform_point(xf, seg->points[i].x, seg->points[i].y, &x, &y);
+        bounds_add(&b, x, y);
+      }
+    }
+  }
+  float reach = stroke_reach(s);
+  b.x0 -= reach;
+  b.y0 -= reach;
+  b.x1 += reach;
+  b.y1 += reach;
+  return b;
+}
+
+static vg_boundsf_t image_device_bounds(const vg_shape_t *s,
+                                        const vg_transform_t *xf) {
+  const vg_image_ref_t *img = &s->data.img;
+  vg_boundsf_t b = bounds_empty;
+  if (!img->frame)
+    return b;
+  pix_size_t src = img->src_size.w ? img->src_size : img->frame->size;
+  float x0 = img->dst_origin.x, y0 = img->dst_origin.y;
+  float cx[4] = {x0, x0 + src.w, x0 + src.w, x0};
+  float cy[4] = {y0, y0, y0 + src.h, y0 + src.h};
+  for (int i = 0; i < 4; ++i) {
+    float x = cx[i], y = cy[i];
+    if (xf)
+      vg_transform_point(xf, cx[i], cy[i], &x, &y);
+    bounds_add(&b, x, y);
+  }
+  return b;
+}
+
+bool vg__shape_bounds(const vg_shape_t *shape, vg_boundsf_t *out) {
+  // The cache is not part of the shape's observable state.
+  vg_shape_t *s = (vg_shape_t *)shape;
+  vg_shape_bounds_t *c = &s->bounds;
+  const vg_transform_t *xf = s->transform;
+  bool same = c->valid && c->revision == s->revision &&
+              c->has_transform == (xf != NULL) &&
+              (!xf || memcmp(&c->xf, xf, sizeof(vg_transform_t)) == 0);
+  // Paths can change under the shape without a setter call.
+  if (same && s->kind == VG_SHAPE_PATH)
+    same = c->points_valid && c->generation == s->data.v.path.generation;
+  if (!same) {
+    c->device = s->kind == VG_SHAPE_PATH ? path_device_bounds(s, xf)
+                                         : image_device_bounds(s, xf);
+    c->revision = s->revision;
+    c->has_transform = xf != NULL;
+    if (xf)
+      c->xf = *xf;
+    c->valid = true;
+  }
+  *out = c->device;
+  return c->device.x0 <= c->device.x1 && c->device.y0 <= c->device.y1;
+}
+
 void vg_shape_bbox(const vg_shape_t *shape, pix_point_t *origin,
                    pix_size_t *size) {
   if (origin) {
@@ -152,76 +417,23 @@ void vg_shape_bbox(const vg_shape_t *shape, pix_point_t *origin,
     size->w = 0;
     size->h = 0;
   }
-  if (!shape)
+  vg_boundsf_t b;
+  if (!shape || !vg__shape_bounds(shape, &b))
     return;
-  if (shape->kind == VG_SHAPE_PATH) {
-    const vg_path_t *p = &shape->data.v.path;
-    bool first = true;
-    int minx = 0, miny = 0, maxx = 0, maxy = 0;
-    while (p) {
-      for (size_t i = 0; i < p->size; ++i) {
-        pix_point_t pt = p->points[i];
-        int x = pt.x, y = pt.y;
-        if (first) {
-          minx = maxx = x;
-          miny = maxy = y;
-          first = false;
-        } else {
-          if (x < minx)
-            minx = x;
-          if (x > maxx)
-            maxx = x;
-          if (y < miny)
-            miny = y;
-          if (y > maxy)
-            maxy = y;
-        }
-      }
-      p = p->next;
-    }
-    if (!first) {
-      if (origin) {
-        origin->x = (int16_t)minx;
-        origin->y = (int16_t)miny;
-      }
-      if (size) {
-        int w = maxx - minx;
-        int h = maxy - miny;
-        if (w < 0)
-          w = 0;
-        if (h < 0)
-          h = 0;
-        if (w > 0xFFFF)
-          w = 0xFFFF;
-        if (h > 0xFFFF)
-          h = 0xFFFF;
-        size->w = (uint16_t)w;
-        size->h = (uint16_t)h;
-      }
-    }
-  } else if (shape->kind == VG_SHAPE_IMAGE) {
-    const vg_image_ref_t *img = &shape->data.img;
-    if (!img->frame)
-      return;
-    int x0 = img->dst_origin.x;
-    int y0 = img->dst_origin.y;
-    int w = img->src_size.w ? img->src_size.w : img->frame->size.w;
-    int h = img->src_size.h ? img->src_size.h : img->frame->size.h;
-    if (origin) {
-      origin->x = (int16_t)x0;
-      origin->y = (int16_t)y0;
-    }
-    if (size) {
-      if (w < 0)
-        w = 0;
-      if (h < 0)
-        h = 0;
-      if (w > 0xFFFF)
-        w = 0xFFFF;
-      if (h > 0xFFFF)
-        h = 0xFFFF;
-      size->w = (uint16_t)w;
-      size->h = (uint16_t)h;
-    }
+  int minx = (int)floorf(b.x0), miny = (int)floorf(b.y0);
+  int maxx = (int)ceilf(b.x1), maxy = (int)ceilf(b.y1);
+  if (origin) {
+    origin->x = (int16_t)minx;
+    origin->y = (int16_t)miny;
+  }
+  if (size) {
+    int w = maxx - minx;
+    int h = maxy - miny;
+    if (w > 0xFFFF)
+      w = 0xFFFF;
+    if (h > 0xFFFF)
+      h = 0xFFFF;
+    size->w = (uint16_t)w;
+    size->h = (uint16_t)h;
   }
 }
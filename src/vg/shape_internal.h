@@ -1,4 +1,7 @@
 #pragma once
+#include "fill_internal.h"
+#include "image_internal.h"
+#include "stroke_internal.h"
 #include <vg/vg.h>
 
 typedef enum vg_shape_kind_t {
@@ -12,11 +15,71 @@ typedef struct vg_image_ref_t {
   pix_size_t src_size;    /* if {0,0} treat as full frame */
   pix_point_t dst_origin; /* only for axis-aligned copy now */
   unsigned flags;         /* pix_blit_flags_t */
+  vg_image_sampling_t sampling;
+  vg_image_mips_t *mips;  /* owned, NULL unless mipmapped */
 } vg_image_ref_t;
 
+/* Retained edge tables of a cached path shape (vg_shape_set_cached). The
+ * key records what the tables were built from; the transform is compared
+ * by value since the shape does not own it. */
+typedef struct vg_shape_cache_t {
+  uint32_t generation; /* path generation at build time */
+  bool has_transform;
+  vg_transform_t xf; /* transform at build time (when has_transform) */
+  pix_size_t frame_size;
+  bool fill_valid;
+  vg_fill_quality_t quality;
+  vg_fill_t fill;
+  bool stroke_valid;
+  vg_stroke_style_t style;
+  vg_stroke_t stroke;
+} vg_shape_cache_t;
+
+/* Axis-aligned bounds in float coordinates, empty when x0 > x1. */
+typedef struct vg_boundsf_t {
+  float x0, y0, x1, y1;
+} vg_boundsf_t;
+
+/* Cached geometry bounds, kept in two levels: the path's own point bounds
+ * depend on the path generation only, the transformed and stroke-expanded
+ * bounds also on the revision and the transform (by value). Axis-aligned
+ * transforms map the point bounds directly; others re-walk the points. */
+typedef struct vg_shape_bounds_t {
+  bool points_valid;
+  uint32_t generation; /* path generation of @ref points */
+  vg_boundsf_t points; /* untransformed path points */
+  bool valid;
+  uint32_t revision; /* shape revision of @ref device */
+  bool has_transform;
+  vg_transform_t xf;
+  vg_boundsf_t device; /* transformed, stroke-expanded */
+} vg_shape_bounds_t;
+
+/* Device bounds (inclusive pixels) a shape may touch. */
+typedef struct vg_bounds_t {
+  int x0, y0, x1, y1;
+} vg_bounds_t;
+
+/* What a shape looked like when vg_canvas_render_damage last drew it. A
+ * change of any key field damages the old and the new bounds. */
+typedef struct vg_shape_drawn_t {
+  bool valid;
+  uint32_t revision;   /* shape revision */
+  uint32_t generation; /* path generation */
+  bool has_transform;
+  vg_transform_t xf;
+  bool visible;       /* bounds reach the frame */
+  bool clipped;       /* bounds cross the frame edge */
+  vg_bounds_t bounds; /* clamped to the frame */
+} vg_shape_drawn_t;
+
 struct vg_shape_t {
   vg_shape_kind_t kind;
   const vg_transform_t *transform; /* not owned */
+  vg_shape_cache_t *cache;         /* path shapes only, NULL unless cached */
+  uint32_t revision;               /* bumped by every effective setter */
+  vg_shape_drawn_t drawn;          /* damage tracking snapshot */
+  vg_shape_bounds_t bounds;        /* see vg__shape_bounds */
   union {
     struct {
       vg_path_t path;
@@ -27,11 +90,23 @@ struct vg_shape_t {
       vg_join_t stroke_join;
       float miter_limit;
       vg_fill_rule_t fill_rule;
+      vg_fill_quality_t fill_quality;
     } v;                /* vector */
     vg_image_ref_t img; /* image */
   } data;
 };
 
+/* Drop cached tables whose key no longer matches the shape's path,
+ * transform or @p frame_size. Returns the cache, or NULL when the shape is
+ * not cached. */
+vg_shape_cache_t *vg__shape_cache_sync(vg_shape_t *s, pix_size_t frame_size);
+
+/* Transformed, stroke-expanded geometry bounds of @p s (images: the
+ * destination rectangle), from the cache when its key still matches.
+ * Returns false for empty shapes. Not thread safe: the cache is refreshed
+ * in place, so call it before sharing the shape between threads. */
+bool vg__shape_bounds(const vg_shape_t *s, vg_boundsf_t *out);
+
 /* Internal helper used by the canvas pool to lazily initialize defaults. */
 void vg__shape_internal_defaults(vg_shape_t *s);
 
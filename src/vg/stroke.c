@@ -0,0 +1,314 @@
+// Polygon stroker: every contour is offset by half the stroke width on both
+// sides (with joins at interior vertices and caps at open ends) and the
+// resulting outline is rasterized once, non-zero, by the coverage rasterizer.
+// See stroke_internal.h.
+#include <math.h>
+#include <stdlib.h>
+
+#include "path_internal.h"
+#include "raster_internal.h"
+#include "stroke_internal.h"
+
+// Maximum distance between a round cap / join and its polygon (px).
+static const float STROKE_ARC_TOLERANCE = 0.125f;
+// Device-space points closer than this are merged.
+static const float STROKE_MERGE_EPS = 1e-3f;
+
+typedef struct vg_stroke_pt_t {
+  float x, y;   /* device position */
+  float dx, dy; /* unit direction of the segment leaving this point */
+  float len;    /* length of that segment */
+} stroke_pt_t;
+
+typedef struct stroker_t {
+  vg_raster_t *r;
+  float hw; /* half width */
+  vg_cap_t cap;
+  vg_join_t join;
+  float miter_limit;
+  float arc_step;       /* max angle per round cap / join segment */
+  float fx, fy, px, py; /* outline start and pen */
+  bool drawing;         /* an outline loop is open */
+  stroke_pt_t *pts;     /* current contour (vg_stroke_t storage) */
+  size_t count, capacity;
+} stroker_t;
+
+/* -------- Outline emission -------- */
+static void ol_point(stroker_t *s, float x, float y) {
+  if (!s->drawing) {
+    s->fx = s->px = x;
+    s->fy = s->py = y;
+    s->drawing = true;
+    return;
+  }
+  vg__raster_line(s->r, s->px, s->py, x, y);
+  s->px = x;
+  s->py = y;
+}
+
+static void ol_close(stroker_t *s) {
+  if (s->drawing)
+    vg__raster_line(s->r, s->px, s->py, s->fx, s->fy);
+  s->drawing = false;
+}
+
+/* Interior points of an arc around (cx,cy) starting at offset (vx,vy) and
+ * sweeping @p da radians; the caller emits both end points. */
+static void ol_arc(stroker_t *s, float cx, float cy, float vx, float vy,
+                   float da) {
+  int steps = (int)ceilf(fabsf(da) / s->arc_step);
+  if (steps < 2)
+    return;
+  float c = cosf(da / (float)steps), sn = sinf(da / (float)steps);
+  for (int i = 1; i < steps; ++i) {
+    float t = vx * c - vy * sn;
+    vy = vx * sn + vy * c;
+    vx = t;
+    ol_point(s, cx + vx, cy + vy);
+  }
+}
+
+/* Cap at (x,y) facing (dx,dy): the pen is on the left side (p + n*hw) and is
+ * left on the right side (p - n*hw). */
+static void ol_cap(stroker_t *s, float x, float y, float dx, float dy) {
+  float nx = -dy * s->hw, ny = dx * s->hw;
+  if (s->cap == VG_CAP_SQUARE) {
+    float ex = dx * s->hw, ey = dy * s->hw;
+    ol_point(s, x + nx + ex, y + ny + ey);
+    ol_point(s, x - nx + ex, y - ny + ey);
+  } else if (s->cap == VG_CAP_ROUND) {
+    ol_arc(s, x, y, nx, ny, -(float)M_PI);
+  }
+  ol_point(s, x - nx, y - ny);
+}
+
+/* Left-side corner at (x,y) between incoming direction d0 (segment length
+ * l0) and outgoing d1 (length l1): emits the end of the incoming offset edge
+ * through the start of the outgoing one. */
+static void ol_join(stroker_t *s, float x, float y, float d0x, float d0y,
+                    float l0, float d1x, float d1y, float l1) {
+  float hw = s->hw;
+  float n0x = -d0y * hw, n0y = d0x * hw;
+  float n1x = -d1y * hw, n1y = d1x * hw;
+  float cross = d0x * d1y - d0y * d1x;
+  float dot = d0x * d1x + d0y * d1y;
+  if (cross > 0.f) {
+    // Inner corner: the offset edges meet at one point when that point lies
+    // within the first half of both segments (so neighbouring corners cannot
+    // overlap); otherwise pivot through the vertex, which keeps the outline
+    // a union of positively wound pieces.
+    if (dot > -0.99f) {
+      float t = hw * sqrtf((1.f - dot) / (1.f + dot));
+      if (2.f * t <= l0 && 2.f * t <= l1) {
+        float k = 1.f / (1.f + dot);
+        ol_point(s, x + (n0x + n1x) * k, y + (n0y + n1y) * k);
+        return;
+      }
+    }
+    ol_point(s, x + n0x, y + n0y);
+    ol_point(s, x, y);
+    ol_point(s, x + n1x, y + n1y);
+    return;
+  }
+  if (s->join == VG_JOIN_MITER && dot > -0.999f &&
+      2.f <= s->miter_limit * s->miter_limit * (1.f + dot)) {
+    // Miter length / width = 1 / sin(theta/2) = sqrt(2 / (1 + dot)).
+    float k = 1.f / (1.f + dot);
+    ol_point(s, x + (n0x + n1x) * k, y + (n0y + n1y) * k);
+    return;
+  }
+  ol_point(s, x + n0x, y + n0y);
+  if (s->join == VG_JOIN_ROUND) {
+    // Sweep from n0 to n1 around the outside; a full reversal turns through
+    // the incoming direction.
+    float da = (cross == 0.f && dot < 0.f) ? -(float)M_PI : atan2f(cross, dot);
+    ol_arc(s, x, y, n0x, n0y, da);
+  }
+  ol_point(s, x + n1x, y + n1y);
+}
+
+/* -------- Contours -------- */
+static bool stroke_push(stroker_t *s, float x, float y) {
+  if (s->count) {
+    const stroke_pt_t *p = &s->pts[s->count - 1];
+    if (fabsf(x - p->x) < STROKE_MERGE_EPS &&
+        fabsf(y - p->y) < STROKE_MERGE_EPS)
+      return true;
+  }
+  if (s->count == s->capacity) {
+    size_t cap = s->capacity ? s->capacity * 2 : 64;
+    stroke_pt_t *n = (stroke_pt_t *)vg__arena_realloc(
+        s->r->arena, s->pts, s->capacity * sizeof(stroke_pt_t),
+        cap * sizeof(stroke_pt_t));
+    if (!n)
+      return false;
+    s->pts = n;
+    s->capacity = cap;
+  }
+  s->pts[s->count].x = x;
+  s->pts[s->count].y = y;
+  s->count++;
+  return true;
+}
+
+/* Zero-length contour: a dot for round and square caps. */
+static void stroke_dot(stroker_t *s, float x, float y) {
+  float hw = s->hw;
+  if (s->cap == VG_CAP_ROUND) {
+    ol_point(s, x + hw, y);
+    ol_arc(s, x, y, hw, 0.f, 2.f * (float)M_PI);
+    ol_close(s);
+  } else if (s->cap == VG_CAP_SQUARE) {
+    ol_point(s, x - hw, y - hw);
+    ol_point(s, x + hw, y - hw);
+    ol_point(s, x + hw, y + hw);
+    ol_point(s, x - hw, y + hw);
+    ol_close(s);
+  }
+}
+
+static void stroke_contour(stroker_t *s, bool closed) {
+  stroke_pt_t *p = s->pts;
+  size_t n = s->count;
+  if (closed && n > 1 && fabsf(p[0].x - p[n - 1].x) < STROKE_MERGE_EPS &&
+      fabsf(p[0].y - p[n - 1].y) < STROKE_MERGE_EPS)
+    n--;
+  if (n == 1) {
+    stroke_dot(s, p[0].x, p[0].y);
+    return;
+  }
+  if (n < 3)
+    closed = false;
+  size_t segs = closed ? n : n - 1;
+  for (size_t i = 0; i < segs; ++i) {
+    const stroke_pt_t *q = &p[i + 1 < n ? i + 1 : 0];
+    float dx = q->x - p[i].x, dy = q->y - p[i].y;
+    float len = sqrtf(dx * dx + dy * dy);
+    p[i].dx = dx / len;
+    p[i].dy = dy / len;
+    p[i].len = len;
+  }
+  if (closed) {
+    // Two loops of opposite orientation; non-zero leaves the hole empty.
+    for (size_t i = 0; i < n; ++i) {
+      const stroke_pt_t *a = &p[i ? i - 1 : n - 1];
+      ol_join(s, p[i].x, p[i].y, a->dx, a->dy, a->len, p[i].dx, p[i].dy,
+              p[i].len);
+    }
+    ol_close(s);
+    for (size_t i = n; i-- > 0;) {
+      const stroke_pt_t *a = &p[i ? i - 1 : n - 1];
+      ol_join(s, p[i].x, p[i].y, -p[i].dx, -p[i].dy, p[i].len, -a->dx, -a->dy,
+              a->len);
+    }
+    ol_close(s);
+    return;
+  }
+  // Open: left side forward, end cap, right side backward, start cap.
+  ol_point(s, p[0].x - p[0].dy * s->hw, p[0].y + p[0].dx * s->hw);
+  for (size_t i = 1; i + 1 < n; ++i)
+    ol_join(s, p[i].x, p[i].y, p[i - 1].dx, p[i - 1].dy, p[i - 1].len,
+            p[i].dx, p[i].dy, p[i].len);
+  const stroke_pt_t *last = &p[n - 2];
+  ol_point(s, p[n - 1].x - last->dy * s->hw, p[n - 1].y + last->dx * s->hw);
+  ol_cap(s, p[n - 1].x, p[n - 1].y, last->dx, last->dy);
+  for (size_t i = n - 2; i > 0; --i)
+    ol_join(s, p[i].x, p[i].y, -p[i].dx, -p[i].dy, p[i].len, -p[i - 1].dx,
+            -p[i - 1].dy, p[i - 1].len);
+  ol_point(s, p[0].x + p[0].dy * s->hw, p[0].y - p[0].dx * s->hw);
+  ol_cap(s, p[0].x, p[0].y, -p[0].dx, -p[0].dy);
+  ol_close(s);
+}
+
+bool vg__stroke_build(vg_stroke_t *st, const vg_path_t *path,
+                      const vg_transform_t *xf, const vg_stroke_style_t *style,
+                      const pix_frame_t *frame, pix_point_t clip_min,
+                      pix_point_t clip_max) {
+  st->ready = false;
+  if (!frame || !path || !style || !(style->width > 0.f))
+    return false;
+  int x0 = clip_min.x < 0 ? 0 : clip_min.x;
+  int y0 = clip_min.y < 0 ? 0 : clip_min.y;
+  int x1 = clip_max.x >= (int)frame->size.w ? (int)frame->size.w - 1
+                                            : clip_max.x;
+  int y1 = clip_max.y >= (int)frame->size.h ? (int)frame->size.h - 1
+                                            : clip_max.y;
+  if (x0 > x1 || y0 > y1)
+    return false;
+  if (!vg__raster_begin(&st->raster, x0, y0, x1, y1))
+    return false;
+  stroker_t s = {0};
+  s.r = &st->raster;
+  s.hw = style->width * 0.5f;
+  s.cap = style->cap;
+  s.join = style->join;
+  s.miter_limit = style->miter_limit < 1.f ? 1.f : style->miter_limit;
+  s.arc_step = s.hw > STROKE_ARC_TOLERANCE
+                   ? 2.f * acosf(1.f - STROKE_ARC_TOLERANCE / s.hw)
+                   : (float)M_PI_2;
+  s.pts = st->pts;
+  s.capacity = st->capacity;
+  for (const vg_path_t *seg = path; seg; seg = seg->next) {
+    if (!seg->size)
+      continue;
+    const vg_path_t *end = vg__path_contour_end(seg);
+    pix_point_t first = seg->points[0], last = end->points[end->size - 1];
+    bool ok = true;
+    s.count = 0;
+    for (const vg_path_t *c = seg;; c = c->next) {
+      for (size_t i = 0; ok && i < c->size; ++i) {
+        float x = c->points[i].x, y = c->points[i].y;
+        if (xf) {
+          float tx = xf->m[0][0] * x + xf->m[0][1] * y + xf->m[0][2];
+          float ty = xf->m[1][0] * x + xf->m[1][1] * y + xf->m[1][2];
+          x = tx;
+          y = ty;
+        }
+        ok = stroke_push(&s, x, y);
+      }
+      if (c == end)
+        break;
+    }
+    if (ok)
+      stroke_contour(&s, first.x == last.x && first.y == last.y);
+    seg = end;
+  }
+  st->pts = s.pts;
+  st->capacity = s.capacity;
+  st->ready = true;
+  return true;
+}
+
+void vg__stroke_draw(vg_stroke_t *st, vg_raster_scratch_t *scratch,
+                     pix_frame_t *frame, pix_color_t color) {
+  if (st->ready)
+    vg__raster_fill(&st->raster, scratch, frame, color, VG_FILL_NON_ZERO);
+}
+
+void vg__stroke_free(vg_stroke_t *st) {
+  vg__arena_release(st->raster.arena, st->pts);
+  vg__raster_free(&st->raster);
+  st->pts = NULL;
+  st->capacity = 0;
+  st->ready = false;
+}
+
+void vg_stroke_path_clipped(const vg_path_t *path, const vg_transform_t *xf,
+                            pix_frame_t *frame, pix_color_t color,
+                            const vg_stroke_style_t *style,
+                            pix_point_t clip_min, pix_point_t clip_max) {
+  vg_stroke_t st = {0};
+  vg_raster_scratch_t scratch = {0};
+  if (vg__stroke_build(&st, path, xf, style, frame, clip_min, clip_max))
+    vg__stroke_draw(&st, &scratch, frame, color);
+  vg__stroke_free(&st);
+  vg__raster_scratch_free(&scratch);
+}
+
+void vg_stroke_path(const vg_path_t *path, const vg_transform_t *xf,
+                    pix_frame_t *frame, pix_color_t color,
+                    const vg_stroke_style_t *style) {
+  vg_stroke_path_clipped(
+      path, xf, frame, color, style, (pix_point_t){0, 0},
+      (pix_point_t){(int16_t)frame->size.w - 1, (int16_t)frame->size.h - 1});
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "raster_internal.h"
+#include <pix/pix.h>
+#include <vg/vg.h>
+/* Internal stroke API: each contour is outlined in device space (caps,
+ * joins, miter limit) and the outline is filled once, non-zero, by the
+ * coverage rasterizer. Width is in device pixels. */
+typedef struct vg_stroke_style_t {
+  float width;
+  vg_cap_t cap;
+  vg_join_t join;
+  float miter_limit;
+} vg_stroke_style_t;
+
+void vg_stroke_path(const struct vg_path_t *path,
+                    const struct vg_transform_t *xform,
+                    struct pix_frame_t *frame, pix_color_t color,
+                    const vg_stroke_style_t *style);
+void vg_stroke_path_clipped(const struct vg_path_t *path,
+                            const struct vg_transform_t *xform,
+                            struct pix_frame_t *frame, pix_color_t color,
+                            const vg_stroke_style_t *style,
+                            pix_point_t clip_min, pix_point_t clip_max);
+
+/* Build / draw split as for fills (see vg_fill_t): build outlines the path
+ * into the raster for one clip, draw sweeps it. Storage is kept until
+ * vg__stroke_free and comes from raster.arena. Zero-initialize before first
+ * use. */
+typedef struct vg_stroke_t {
+  vg_raster_t raster;
+  struct vg_stroke_pt_t *pts; /* contour scratch */
+  size_t capacity;
+  bool ready; /* built successfully */
+} vg_stroke_t;
+
+bool vg__stroke_build(vg_stroke_t *st, const struct vg_path_t *path,
+                      const struct vg_transform_t *xform,
+                      const vg_stroke_style_t *style, const pix_frame_t *frame,
+                      pix_point_t clip_min, pix_point_t clip_max);
+void vg__stroke_draw(vg_stroke_t *st, vg_raster_scratch_t *scratch,
+                     pix_frame_t *frame, pix_color_t color);
+void vg__stroke_free(vg_stroke_t *st);
@@ -2,8 +2,10 @@
 /* TJpgDec System Configurations R0.03          */
 /*----------------------------------------------*/
 
+#ifndef JD_SZBUF
 #define	JD_SZBUF		512
-/* Specifies size of stream input buffer */
+#endif
+/* Specifies size of stream input buffer (may be set by the build) */
 
 #define JD_FORMAT		0
 /* Specifies output pixel format.
@@ -24,8 +26,10 @@
 /  1: Enable
 */
 
+#ifndef JD_FASTDECODE
 #define JD_FASTDECODE	0
-/* Optimization level
+#endif
+/* Optimization level (may be set by the build)
 /  0: Basic optimization. Suitable for 8/16-bit MCUs.
 /  1: + 32-bit barrel shifter. Suitable for 32-bit MCUs.
 /  2: + Table conversion for huffman decoding (wants 6 << HUFF_BIT bytes of RAM)